@@ -0,0 +1,437 @@
+#include "data_generator/arena.hpp"
+#include "data_generator/data_generator.hpp"
+#include "data_generator/file_writer.hpp"
+#include "data_generator/numa.hpp"
+#include "data_generator/pipeline_writer.hpp"
+#include "CLI/CLI.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace datagen;
+
+/// @brief stream buffer that throws away everything but counts the bytes
+class CountingBuffer : public std::streambuf {
+   public:
+    std::uint64_t bytes = 0;
+
+   protected:
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        bytes += static_cast<std::uint64_t>(count);
+        return count;
+    }
+
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            ++bytes;
+        }
+        return traits_type::not_eof(c);
+    }
+};
+
+/// @brief size of the benchmarked tables; all shapes have the same number of
+/// cells so their throughputs are comparable
+struct Shape {
+    std::string name;
+    std::uint64_t row_count;
+    std::uint64_t col_count;
+};
+
+/// @brief a single benchmark
+struct Benchmark {
+    /// unique name, group/case/shape
+    std::string name;
+
+    /// cells processed by one run
+    std::uint64_t cells;
+
+    /// runs the benchmark once and returns the number of bytes it produced
+    /// (0 if it doesn't produce any)
+    std::function<std::uint64_t()> run;
+};
+
+/// @brief measurements of a benchmark
+struct Result {
+    std::string name;
+    unsigned int runs;
+    std::uint64_t cells;
+    std::uint64_t bytes;
+    /// seconds per run
+    double min_seconds;
+    double median_seconds;
+};
+
+/// @brief keeps the compiler from optimizing away the benchmarked work
+template <typename T>
+void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+constexpr unsigned int seed = 42;
+
+template <typename Distribution>
+void add_generate_benchmarks(std::vector<Benchmark>& benchmarks,
+                             const std::string& name, Distribution random,
+                             const std::vector<Shape>& shapes, unsigned int thread_count) {
+    for (const Shape& shape : shapes) {
+        std::uint64_t cells = shape.row_count * shape.col_count;
+        benchmarks.push_back({"generate/" + name + "/" + shape.name, cells, [=] {
+                                  auto data = generate_data(shape.row_count, shape.col_count,
+                                                            Distribution{random}, seed, thread_count);
+                                  keep(data);
+                                  return std::uint64_t{0};
+                              }});
+        benchmarks.push_back(
+            {"generate/" + name + "-philox/" + shape.name, cells, [=] {
+                 auto data = generate_data<Philox4x32>(shape.row_count, shape.col_count,
+                                                       Distribution{random}, seed, thread_count);
+                 keep(data);
+                 return std::uint64_t{0};
+             }});
+    }
+}
+
+/// @brief generation into an @see ArenaResource that is reused by every run,
+/// i.e. without page faults after the warm-up
+void add_arena_benchmarks(std::vector<Benchmark>& benchmarks, const std::vector<Shape>& shapes,
+                          unsigned int thread_count) {
+    for (const Shape& shape : shapes) {
+        auto arena = std::make_shared<ArenaResource>();
+        benchmarks.push_back(
+            {"generate/uniform-int-philox-arena/" + shape.name, shape.row_count * shape.col_count, [=] {
+                 arena->reset();
+                 auto data = generate_data<Philox4x32>(
+                     shape.row_count, shape.col_count, UniformIntDistribution<int>{-1000, 1000},
+                     seed, thread_count, arena.get());
+                 keep(data);
+                 return std::uint64_t{0};
+             }});
+    }
+}
+
+/// @brief generating and writing csv, one after the other and pipelined
+/// (@see generate_text)
+void add_pipeline_benchmarks(std::vector<Benchmark>& benchmarks, const std::vector<Shape>& shapes,
+                             unsigned int thread_count) {
+    for (const Shape& shape : shapes) {
+        std::uint64_t cells = shape.row_count * shape.col_count;
+        benchmarks.push_back({"pipeline/serial-csv-normal-double/" + shape.name, cells, [=] {
+                                  CountingBuffer buffer;
+                                  std::ostream os{&buffer};
+                                  output_csv(generate_data<Philox4x32>(
+                                                 shape.row_count, shape.col_count,
+                                                 NormalDistribution{0.0, 1.0}, seed, thread_count),
+                                             os);
+                                  return buffer.bytes;
+                              }});
+        benchmarks.push_back({"pipeline/csv-normal-double/" + shape.name, cells, [=] {
+                                  CountingBuffer buffer;
+                                  std::ostream os{&buffer};
+                                  generate_text<Philox4x32>(shape.row_count, shape.col_count,
+                                                            NormalDistribution{0.0, 1.0}, os,
+                                                            csv_format(), seed, thread_count);
+                                  return buffer.bytes;
+                              }});
+    }
+}
+
+/// @brief generation, and streamed generation with formatting by a
+/// @see FileTableWriter, on all cpus of the first 1, 2, ... numa nodes, with
+/// and without a @see NumaScope; shows the scaling per socket
+void add_numa_benchmarks(std::vector<Benchmark>& benchmarks, const std::vector<Shape>& shapes) {
+    NumaTopology topology = NumaTopology::detect();
+    for (std::size_t nodes = 1; nodes <= topology.node_count(); ++nodes) {
+        NumaTopology used = topology.first_nodes(nodes);
+        auto threads = static_cast<unsigned int>(used.cpu_count());
+        for (bool pinned : {false, true}) {
+            std::string name = std::to_string(nodes) + "-node" + (pinned ? "-pinned" : "");
+            // both run on the cpus of the nodes, but only pinned places the
+            // threads and partitions the blocks for first touch
+            auto scope = [=](std::optional<NumaScope>& numa) {
+                if (pinned) {
+                    numa.emplace(used);
+                } else {
+                    detail::restrict_thread(used);
+                }
+            };
+            for (const Shape& shape : shapes) {
+                std::uint64_t cells = shape.row_count * shape.col_count;
+                benchmarks.push_back(
+                    {"numa/generate-uniform-int-" + name + "/" + shape.name, cells, [=] {
+                         detail::AffinityGuard affinity;
+                         std::optional<NumaScope> numa;
+                         scope(numa);
+                         auto data = generate_data<Philox4x32>(
+                             shape.row_count, shape.col_count,
+                             UniformIntDistribution<int>{-1000, 1000}, seed, threads);
+                         keep(data);
+                         return std::uint64_t{0};
+                     }});
+                benchmarks.push_back(
+                    {"numa/stream-csv-uniform-int-" + name + "/" + shape.name, cells, [=] {
+                         detail::AffinityGuard affinity;
+                         std::optional<NumaScope> numa;
+                         scope(numa);
+                         FileTableWriter<int> writer{"/dev/null", csv_format(), threads};
+                         generate_stream<Philox4x32>(
+                             shape.row_count, shape.col_count,
+                             UniformIntDistribution<int>{-1000, 1000},
+                             [&](const Data<int>& chunk, std::uint64_t rows) {
+                                 writer.write_rows(chunk, rows);
+                             },
+                             seed, 0, threads);
+                         return writer.checkpoint().bytes;
+                     }});
+            }
+        }
+    }
+}
+
+template <typename T>
+void add_output_benchmarks(std::vector<Benchmark>& benchmarks, const std::string& name,
+                           std::shared_ptr<const Data<T>> data, const std::string& shape) {
+    std::uint64_t cells = data->size();
+    auto output = [=](auto write) {
+        CountingBuffer buffer;
+        std::ostream os{&buffer};
+        write(*data, os);
+        return buffer.bytes;
+    };
+    benchmarks.push_back({"output/csv-" + name + "/" + shape, cells, [=] {
+                              return output([](const Data<T>& d, std::ostream& os) {
+                                  output_csv(d, os);
+                              });
+                          }});
+    benchmarks.push_back({"output/sql-" + name + "/" + shape, cells, [=] {
+                              return output([](const Data<T>& d, std::ostream& os) {
+                                  output_sql(d, os, "table");
+                              });
+                          }});
+    benchmarks.push_back({"output/json-" + name + "/" + shape, cells, [=] {
+                              return output([](const Data<T>& d, std::ostream& os) {
+                                  output_json(d, os);
+                              });
+                          }});
+}
+
+template <typename T, typename Layout>
+void add_iterate_benchmarks(std::vector<Benchmark>& benchmarks, const std::string& name,
+                            std::shared_ptr<const Data<T, Layout>> data,
+                            const std::string& shape) {
+    // unsigned so that the sum of ints may wrap around
+    using Sum = std::conditional_t<std::is_integral_v<T>, std::uint64_t, double>;
+    std::uint64_t cells = data->size();
+    benchmarks.push_back({"iterate/rows-" + name + "/" + shape, cells, [=] {
+                              Sum sum{};
+                              for (const auto& row : *data) {
+                                  for (T value : row) {
+                                      sum += static_cast<Sum>(value);
+                                  }
+                              }
+                              keep(sum);
+                              return std::uint64_t{0};
+                          }});
+    benchmarks.push_back({"iterate/columns-" + name + "/" + shape, cells, [=] {
+                              Sum sum{};
+                              for (std::uint64_t col = 0; col < data->col_count; ++col) {
+                                  for (T value : data->column(col)) {
+                                      sum += static_cast<Sum>(value);
+                                  }
+                              }
+                              keep(sum);
+                              return std::uint64_t{0};
+                          }});
+    benchmarks.push_back({"iterate/index-" + name + "/" + shape, cells, [=] {
+                              Sum sum{};
+                              for (std::uint64_t row = 0; row < data->row_count; ++row) {
+                                  for (std::uint64_t col = 0; col < data->col_count; ++col) {
+                                      sum += static_cast<Sum>((*data)[row][col]);
+                                  }
+                              }
+                              keep(sum);
+                              return std::uint64_t{0};
+                          }});
+}
+
+std::vector<Benchmark> make_benchmarks(std::uint64_t cells, unsigned int thread_count) {
+    std::uint64_t wide_cols = 1024;
+    std::vector<Shape> shapes{
+        {"tall", std::max<std::uint64_t>(cells / 4, 1), 4},
+        {"wide", std::max<std::uint64_t>(cells / wide_cols, 1), wide_cols}};
+
+    std::vector<Benchmark> benchmarks;
+    add_generate_benchmarks(benchmarks, "uniform-int", UniformIntDistribution<int>{-1000, 1000},
+                            shapes, thread_count);
+    add_generate_benchmarks(benchmarks, "uniform-int64", UniformIntDistribution<std::int64_t>{},
+                            shapes, thread_count);
+    add_generate_benchmarks(benchmarks, "normal-double", NormalDistribution{0.0, 1.0}, shapes,
+                            thread_count);
+    add_generate_benchmarks(benchmarks, "bernoulli-bool", BernoulliDistribution{0.5}, shapes,
+                            thread_count);
+    add_generate_benchmarks(benchmarks, "zipf-int64", ZipfDistribution{1000, 1.1}, shapes,
+                            thread_count);
+    // rejection-inversion instead of the alias table
+    add_generate_benchmarks(benchmarks, "zipf-large-int64", ZipfDistribution{100'000'000, 1.1},
+                            shapes, thread_count);
+    // a Feistel permutation per cell, without an engine
+    add_generate_benchmarks(benchmarks, "unique-int64", UniqueKeyDistribution{}, shapes,
+                            thread_count);
+    // whole correlated rows, only for the tall shape (the matrix has a row per column)
+    add_generate_benchmarks(benchmarks, "mvnormal-double",
+                            MultivariateNormalDistribution{{0.0, 1.0, 2.0, 3.0},
+                                                           {1.0, 0.5, 0.0, 0.0,  //
+                                                            0.5, 1.0, 0.5, 0.0,  //
+                                                            0.0, 0.5, 1.0, 0.5,  //
+                                                            0.0, 0.0, 0.5, 1.0}},
+                            {shapes.front()}, thread_count);
+    // a distribution without batch kernels
+    add_generate_benchmarks(benchmarks, "std-uniform-real-float",
+                            std::uniform_real_distribution<float>{0.0f, 1.0f}, shapes,
+                            thread_count);
+    add_arena_benchmarks(benchmarks, shapes, thread_count);
+    add_pipeline_benchmarks(benchmarks, shapes, thread_count);
+    add_numa_benchmarks(benchmarks, shapes);
+    for (const Shape& shape : shapes) {
+        benchmarks.push_back(
+            {"generate/normal-double-philox-column-major/" + shape.name,
+             shape.row_count * shape.col_count, [=] {
+                 auto data = generate_data<Philox4x32, ColumnMajor>(
+                     shape.row_count, shape.col_count, NormalDistribution{0.0, 1.0}, seed,
+                     thread_count);
+                 keep(data);
+                 return std::uint64_t{0};
+             }});
+    }
+
+    for (const Shape& shape : shapes) {
+        auto ints = std::make_shared<const Data<int>>(generate_data(
+            shape.row_count, shape.col_count, UniformIntDistribution<int>{}, seed));
+        auto doubles = std::make_shared<const Data<double>>(generate_data(
+            shape.row_count, shape.col_count, NormalDistribution{0.0, 1.0}, seed));
+        auto bools = std::make_shared<const Data<bool>>(generate_data(
+            shape.row_count, shape.col_count, BernoulliDistribution{0.5}, seed));
+        add_iterate_benchmarks(benchmarks, "int", ints, shape.name);
+        add_iterate_benchmarks(benchmarks, "double", doubles, shape.name);
+        add_iterate_benchmarks(
+            benchmarks, "int-column-major",
+            std::make_shared<const Data<int, ColumnMajor>>(generate_data<std::mt19937, ColumnMajor>(
+                shape.row_count, shape.col_count, UniformIntDistribution<int>{}, seed)),
+            shape.name);
+        add_output_benchmarks(benchmarks, "int", ints, shape.name);
+        add_output_benchmarks(benchmarks, "double", doubles, shape.name);
+        add_output_benchmarks(benchmarks, "bool", bools, shape.name);
+    }
+    return benchmarks;
+}
+
+/// @brief runs benchmark at least min_runs times and until it took
+/// min_seconds in total
+Result measure(const Benchmark& benchmark, double min_seconds, unsigned int min_runs) {
+    using Clock = std::chrono::steady_clock;
+    std::uint64_t bytes = benchmark.run();  // warm-up
+    std::vector<double> seconds;
+    double total = 0.0;
+    while (seconds.size() < min_runs || total < min_seconds) {
+        auto start = Clock::now();
+        bytes = benchmark.run();
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        seconds.push_back(elapsed);
+        total += elapsed;
+    }
+    std::sort(seconds.begin(), seconds.end());
+    return {benchmark.name,          static_cast<unsigned int>(seconds.size()),
+            benchmark.cells,         bytes,
+            seconds.front(),         seconds[seconds.size() / 2]};
+}
+
+/// @brief writes the results as JSON, one benchmark per line so that the files
+/// of two versions can be compared with diff
+void write_json(const std::vector<Result>& results, std::uint64_t cells,
+                unsigned int thread_count, std::ostream& os) {
+    os << std::setprecision(6) << "{\n  \"cells\": " << cells
+       << ",\n  \"threads\": " << thread_count << ",\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        os << "    {\"name\": \"" << r.name << "\", \"runs\": " << r.runs
+           << ", \"cells\": " << r.cells << ", \"bytes\": " << r.bytes
+           << ", \"min_seconds\": " << r.min_seconds
+           << ", \"median_seconds\": " << r.median_seconds
+           << ", \"cells_per_second\": " << static_cast<double>(r.cells) / r.median_seconds
+           << ", \"bytes_per_second\": " << static_cast<double>(r.bytes) / r.median_seconds
+           << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+    CLI::App app{"Benchmarks generation, iteration and output of datagen"};
+    std::uint64_t cells = 1 << 22;
+    std::string filter;
+    double min_seconds = 0.5;
+    unsigned int min_runs = 3;
+    unsigned int thread_count = 1;
+    std::string json_file;
+    bool list = false;
+    app.add_option("--cells", cells, "cells per table (tall: 4 columns, wide: 1024 columns)")
+        ->check(CLI::PositiveNumber);
+    app.add_option("--filter", filter, "only run benchmarks whose name contains this");
+    app.add_option("--min-time", min_seconds, "minimum seconds per benchmark")
+        ->check(CLI::NonNegativeNumber);
+    app.add_option("--min-runs", min_runs, "minimum runs per benchmark")
+        ->check(CLI::PositiveNumber);
+    app.add_option("-j", thread_count, "threads generating the data")->check(CLI::PositiveNumber);
+    app.add_option("--json", json_file, "also write the results as JSON to this file");
+    app.add_flag("--list", list, "only print the names of the benchmarks");
+    CLI11_PARSE(app, argc, argv);
+
+    std::vector<Benchmark> benchmarks = make_benchmarks(cells, thread_count);
+    std::erase_if(benchmarks, [&](const Benchmark& benchmark) {
+        return benchmark.name.find(filter) == std::string::npos;
+    });
+    if (list) {
+        for (const Benchmark& benchmark : benchmarks) {
+            std::cout << benchmark.name << "\n";
+        }
+        return 0;
+    }
+
+    std::cout << std::left << std::setw(46) << "benchmark" << std::right << std::setw(8)
+              << "runs" << std::setw(12) << "median ms" << std::setw(14) << "Mcells/s"
+              << std::setw(12) << "MB/s" << "\n";
+    std::vector<Result> results;
+    for (const Benchmark& benchmark : benchmarks) {
+        Result r = measure(benchmark, min_seconds, min_runs);
+        std::cout << std::left << std::setw(46) << r.name << std::right << std::setw(8)
+                  << r.runs << std::fixed << std::setprecision(2) << std::setw(12)
+                  << r.median_seconds * 1e3 << std::setw(14)
+                  << static_cast<double>(r.cells) / r.median_seconds / 1e6 << std::setw(12);
+        if (r.bytes > 0) {
+            std::cout << static_cast<double>(r.bytes) / r.median_seconds / 1e6;
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::endl;
+        results.push_back(r);
+    }
+
+    if (!json_file.empty()) {
+        std::ofstream ofs{json_file};
+        write_json(results, cells, thread_count, ofs);
+        if (!ofs) {
+            std::cerr << "error: can't write " << json_file << std::endl;
+            return 1;
+        }
+    }
+}
@@ -1,21 +1,102 @@
 
 #include "data_generator/data_generator.hpp"
+#include "data_generator/binary_writer.hpp"
+#include "data_generator/compression.hpp"
+#include "data_generator/file_writer.hpp"
+#include "data_generator/numa.hpp"
+#include "data_generator/pipeline_writer.hpp"
+#include "data_generator/rate_limiter.hpp"
+#include "data_generator/stats.hpp"
+#ifdef DATAGEN_WITH_SQLITE
+#include "data_generator/sqlite_writer.hpp"
+#endif
 #include "CLI/CLI.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cmath>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
 #include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
 #include <random>
+#include <stdexcept>
+#include <system_error>
 #include <unordered_map>
+#include <variant>
 
 using namespace datagen;
 
 /// @brief struct to hold all options that can be specified in command line interface
 struct CliOptions {
-    enum class OutputFormat { csv, sql, json };
+    enum class OutputFormat {
+        csv,
+        sql,
+        json,
+
+        /// raw little-endian columns (@see RawColumnWriter)
+        raw,
+
+        /// Apache Arrow IPC file (@see ArrowWriter)
+        arrow,
+
+        /// PostgreSQL COPY FROM STDIN command with the data as text, e.g. for psql
+        copy,
+
+        /// data for PostgreSQL's COPY FROM (FORMAT binary) (@see PostgresBinaryWriter)
+        copy_binary,
+
+        /// rows inserted into an SQLite database file (@see SqliteWriter);
+        /// needs --out-file and a build with SQLite
+        sqlite
+    };
+
+    /// @brief whether format is written by one of the binary writers
+    static bool is_binary(OutputFormat format) {
+        return format == OutputFormat::raw || format == OutputFormat::arrow ||
+               format == OutputFormat::copy_binary;
+    }
 
     static const std::unordered_map<std::string, CliOptions::OutputFormat> strToOutputFormat;
     static const std::unordered_map<OutputFormat, std::string> outputFormatToStr;
     static const std::unordered_map<OutputFormat, std::string> outputFormatToComment;
 
+    enum class RandomEngine {
+        /// std::mt19937, seeded per block of rows
+        mt19937,
+
+        /// counter-based @see Philox4x32; every cell is a pure function of
+        /// (seed, row, col)
+        philox
+    };
+
+    static const std::unordered_map<std::string, CliOptions::RandomEngine> strToRandomEngine;
+    static const std::unordered_map<RandomEngine, std::string> randomEngineToStr;
+
+    static const std::unordered_map<std::string, Compression> strToCompression;
+    static const std::unordered_map<Compression, std::string> compressionToStr;
+
+    enum class StatsFormat {
+        none,
+
+        /// comment lines
+        text,
+
+        /// a single line of JSON
+        json
+    };
+
     enum class RandomDistribution {
         /// every integer in specified range has same likelihood to be generated
         uniform,
@@ -25,14 +106,29 @@ struct CliOptions {
 
         /// generates booleans in a bernoulli distribution (basically coin
         /// flipping with a specific probability to get heads)
-        bernoulli
+        bernoulli,
+
+        /// generates integers 1, ..., n where small ones are much more likely (Zipf's law)
+        zipf,
+
+        /// generates keys of another table's key range, uniformly or skewed
+        foreign_key,
+
+        /// generates rows of correlated normally distributed doubles
+        mvnormal,
+
+        /// generates unique random integers, e.g. a random permutation of 1, ..., n
+        unique,
+
+        /// generates strictly increasing integers, optionally with random gaps
+        sequence
     };
 
     /// number of rows to be generated (cli: -n)
-    unsigned int sample_count = 10;
+    std::uint64_t sample_count = 10;
 
     /// number of columns to be generated (cli: -c)
-    unsigned int col_count = 5;
+    std::uint64_t col_count = 5;
 
     /// seed for random values (cli: --seed)
     unsigned int seed = std::random_device{}();
@@ -40,9 +136,16 @@ struct CliOptions {
     /// output format (cli: -o, --output)
     OutputFormat output = OutputFormat::csv;
 
-    /// tablename for sql output (cli: --tablename)
+    /// random engine (cli: --engine)
+    RandomEngine engine = RandomEngine::mt19937;
+
+    /// tablename for sql, copy and sqlite output (cli: --tablename)
     std::string tablename = "table";
 
+    /// rows per INSERT statement for sql output (default: a single statement)
+    /// or per transaction for sqlite output (default: 100000) (cli: --batch-size)
+    unsigned int batch_size = 0;
+
     /// random distribution (cli: subcommand)
     RandomDistribution distribution = RandomDistribution::uniform;
 
@@ -61,27 +164,343 @@ struct CliOptions {
     /// probability p of bernoulli distribution (cli: -p);
     /// must be between 0 and 1
     double p = 0.5;
+
+    /// number of elements n of zipf distribution (cli: --elements)
+    std::int64_t elements = 1000;
+
+    /// exponent s of zipf distribution (cli: --exponent); must be positive
+    double exponent = 1.0;
+
+    /// first key of the referenced key range of foreign-key distribution (cli: --first-key)
+    std::int64_t first_key = 1;
+
+    /// number of keys of the referenced key range of foreign-key distribution (cli: --keys)
+    std::int64_t key_count = 1000;
+
+    /// zipf exponent of the references of foreign-key distribution, 0 for uniform (cli: --skew)
+    double skew = 0.0;
+
+    /// means of the columns of mvnormal distribution (cli: --mean); zeros if empty
+    std::vector<double> means;
+
+    /// covariance matrix of mvnormal distribution, row-major (cli: --covariance);
+    /// determines the number of columns
+    std::vector<double> covariance;
+
+    /// smallest value of unique distribution (cli: unique --min)
+    std::int64_t key_min = 1;
+
+    /// largest value of unique distribution (cli: unique --max); the default
+    /// key_min + n * c - 1 makes the table a permutation
+    std::int64_t key_max = 0;
+
+    /// first value of sequence distribution (cli: --first)
+    std::int64_t sequence_first = 1;
+
+    /// difference between consecutive values of sequence distribution (cli: --step)
+    std::int64_t sequence_step = 1;
+
+    /// add a random gap smaller than the step to every value of sequence distribution
+    /// (cli: --random-gaps); the values stay strictly increasing
+    bool random_gaps = false;
+
+    /// generate and output the data chunk by chunk instead of all at once
+    /// (cli: --stream); doesn't change the generated values
+    bool stream = false;
+
+    /// number of threads generating the data (cli: -j);
+    /// doesn't change the generated values
+    unsigned int thread_count = 1;
+
+    /// write the data to this file instead of stdout (cli: --out-file);
+    /// formats and writes on all threads
+    std::string out_file;
+
+    /// compression of the output, in blocks on all threads (cli: --compress)
+    Compression compression = Compression::none;
+
+    /// number of shards the table is split into (cli: --shards); every shard
+    /// has the rows that the unsharded table has at its position
+    std::uint64_t shard_count = 1;
+
+    /// shard to generate (cli: --shard-index)
+    std::uint64_t shard_index = 0;
+
+    /// write every shard to its own file in this directory, several shards at
+    /// a time (cli: --out-dir)
+    std::string out_dir;
+
+    /// print @see Stats of the run to stderr (cli: --stats[=json])
+    StatsFormat stats = StatsFormat::none;
+
+    /// pin the threads to the cpus of the numa nodes, see @see NumaScope
+    /// (cli: --numa); doesn't change the generated values
+    bool numa = false;
+
+    /// generate rows continuously at this rate, 0 for as fast as possible
+    /// (cli: --rows-per-sec); without -n the stream doesn't end
+    std::optional<double> rows_per_second;
+
+    /// whether the rows are generated until the reader closes the output
+    /// (--rows-per-sec without -n)
+    bool unbounded = false;
+
+    /// first row to generate (cli: --start-row); the rows continue a table whose
+    /// rows before it have been written already, so the prefix of the format is
+    /// left out, and they are appended to @see out_file
+    std::uint64_t start_row = 0;
+
+    /// continue @see out_file from its checkpoint after an interrupted run
+    /// (cli: --resume), see @see checkpoint_path; sets start_row
+    bool resume = false;
+
+    /// the checkpoint that --resume continues from
+    FileCheckpoint resume_checkpoint;
+
+    /// @brief the rows of the table to generate, i.e. those of the shard
+    RowRange rows() const {
+        if (unbounded) {
+            // as many rows as the cells can be counted for
+            return {0, std::numeric_limits<std::uint64_t>::max() / col_count};
+        }
+        if (start_row > 0) {
+            return {start_row, sample_count - start_row};
+        }
+        return shard_rows(sample_count, shard_count, shard_index);
+    }
+
+    /// columns with their own type and distribution (cli: --column, --schema);
+    /// if not empty, replaces -c and the distribution subcommand
+    Schema schema;
 };
 
 const std::unordered_map<std::string, CliOptions::OutputFormat>
     CliOptions::strToOutputFormat{{"csv", CliOptions::OutputFormat::csv},
                                   {"sql", CliOptions::OutputFormat::sql},
-                                  {"json", CliOptions::OutputFormat::json}};
+                                  {"json", CliOptions::OutputFormat::json},
+                                  {"raw", CliOptions::OutputFormat::raw},
+                                  {"arrow", CliOptions::OutputFormat::arrow},
+                                  {"copy", CliOptions::OutputFormat::copy},
+                                  {"copy-binary", CliOptions::OutputFormat::copy_binary},
+#ifdef DATAGEN_WITH_SQLITE
+                                  {"sqlite", CliOptions::OutputFormat::sqlite},
+#endif
+                                 };
 
 const std::unordered_map<CliOptions::OutputFormat, std::string>
     CliOptions::outputFormatToStr{{CliOptions::OutputFormat::csv, "csv"},
                                   {CliOptions::OutputFormat::sql, "sql"},
-                                  {CliOptions::OutputFormat::json, "json"}};
+                                  {CliOptions::OutputFormat::json, "json"},
+                                  {CliOptions::OutputFormat::raw, "raw"},
+                                  {CliOptions::OutputFormat::arrow, "arrow"},
+                                  {CliOptions::OutputFormat::copy, "copy"},
+                                  {CliOptions::OutputFormat::copy_binary, "copy-binary"},
+                                  {CliOptions::OutputFormat::sqlite, "sqlite"}};
 
 const std::unordered_map<CliOptions::OutputFormat, std::string>
     CliOptions::outputFormatToComment{{CliOptions::OutputFormat::csv, "#"},
                                       {CliOptions::OutputFormat::sql, "--"},
-                                      {CliOptions::OutputFormat::json, "//"}};
+                                      {CliOptions::OutputFormat::json, "//"},
+                                      {CliOptions::OutputFormat::raw, "#"},
+                                      {CliOptions::OutputFormat::arrow, "#"},
+                                      {CliOptions::OutputFormat::copy, "--"},
+                                      {CliOptions::OutputFormat::copy_binary, "#"},
+                                      {CliOptions::OutputFormat::sqlite, "--"}};
+
+const std::unordered_map<std::string, CliOptions::RandomEngine>
+    CliOptions::strToRandomEngine{{"mt19937", CliOptions::RandomEngine::mt19937},
+                                  {"philox", CliOptions::RandomEngine::philox}};
+
+const std::unordered_map<CliOptions::RandomEngine, std::string>
+    CliOptions::randomEngineToStr{{CliOptions::RandomEngine::mt19937, "mt19937"},
+                                  {CliOptions::RandomEngine::philox, "philox"}};
+
+const std::unordered_map<std::string, Compression>
+    CliOptions::strToCompression{{"none", Compression::none},
+                                 {"gzip", Compression::gzip},
+                                 {"zstd", Compression::zstd},
+                                 {"lz4", Compression::lz4}};
+
+const std::unordered_map<Compression, std::string>
+    CliOptions::compressionToStr{{Compression::none, "none"},
+                                 {Compression::gzip, "gzip"},
+                                 {Compression::zstd, "zstd"},
+                                 {Compression::lz4, "lz4"}};
+
+/// @brief whether the key_count keys starting at first_key are all std::int64_t values
+bool valid_key_range(std::int64_t first_key, std::int64_t key_count) {
+    return key_count > 0 && first_key <= std::numeric_limits<std::int64_t>::max() - (key_count - 1);
+}
+
+/// @brief the last of count consecutive keys starting at min, i.e. the default max of
+/// unique keys, or nothing if it isn't a std::int64_t value (or count is 0)
+std::optional<std::int64_t> last_key(std::int64_t min, std::uint64_t count) {
+    // in 64 bit unsigned arithmetic, which wraps instead of overflowing
+    std::uint64_t room = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) -
+                         static_cast<std::uint64_t>(min);
+    if (count - 1 > room) {
+        return std::nullopt;
+    }
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(min) + (count - 1));
+}
+
+/// @brief whether [min, max] has at least cells values, i.e. enough for unique keys
+bool holds_unique_keys(std::int64_t min, std::int64_t max, std::uint64_t cells) {
+    // 0 for all 2^64 values
+    std::uint64_t size = static_cast<std::uint64_t>(max) - static_cast<std::uint64_t>(min) + 1;
+    return min <= max && (size == 0 || cells <= size);
+}
+
+/// @brief parses a column specification of the form name:distribution(parameters),
+/// e.g. price:normal(100,15); without parameters, the defaults of the subcommands are used
+/// @param row_count number of rows of the table, for the default of unique
+/// @throws CLI::ValidationError if spec is malformed
+ColumnSchema parse_column(const std::string& spec, std::uint64_t row_count) {
+    auto error = [&](const std::string& reason) {
+        return CLI::ValidationError{"invalid column '" + spec + "': " + reason};
+    };
+
+    std::size_t colon = spec.find(':');
+    if (colon == 0 || colon == std::string::npos) {
+        throw error("expected name:distribution(parameters)");
+    }
+    std::string name = spec.substr(0, colon);
+    std::string distribution = spec.substr(colon + 1);
+
+    std::vector<std::string> parameters;
+    std::size_t open = distribution.find('(');
+    if (open != std::string::npos) {
+        if (distribution.back() != ')') {
+            throw error("missing ')'");
+        }
+        std::istringstream list{distribution.substr(open + 1, distribution.size() - open - 2)};
+        for (std::string parameter; std::getline(list, parameter, ',');) {
+            parameters.push_back(parameter);
+        }
+        distribution.resize(open);
+    }
+
+    // converts the parameter i or returns fallback if there are no parameters
+    auto parameter = [&]<typename T>(std::size_t i, T fallback) {
+        if (parameters.empty()) {
+            return fallback;
+        }
+        std::istringstream is{parameters[i]};
+        T value;
+        if (!(is >> value) || !(is >> std::ws).eof()) {
+            throw error("invalid parameter '" + parameters[i] + "'");
+        }
+        return value;
+    };
+    auto expect_parameters = [&](std::size_t count) {
+        if (!parameters.empty() && parameters.size() != count) {
+            throw error(distribution + " takes " + std::to_string(count) + " parameters");
+        }
+    };
+
+    const CliOptions defaults{};
+    if (distribution == "uniform") {
+        expect_parameters(2);
+        int min = parameter(0, defaults.min);
+        int max = parameter(1, defaults.max);
+        if (min >= max) {
+            throw error("min must be smaller than max");
+        }
+        // the smallest integer type for the range; the values are the same
+        return {name, std::visit([](auto random) -> ColumnDistribution { return random; },
+                                 narrowest_uniform(min, max))};
+    }
+    if (distribution == "normal") {
+        expect_parameters(2);
+        double mean = parameter(0, defaults.mean);
+        double stddev = parameter(1, defaults.stddev);
+        if (!(stddev > 0.0)) {
+            throw error("the standard deviation must be positive");
+        }
+        return {name, NormalDistribution{mean, stddev}};
+    }
+    if (distribution == "bernoulli") {
+        expect_parameters(1);
+        double p = parameter(0, defaults.p);
+        if (p < 0.0 || p > 1.0) {
+            throw error("p must be between 0 and 1");
+        }
+        return {name, BernoulliDistribution{p}};
+    }
+    if (distribution == "zipf") {
+        expect_parameters(2);
+        auto elements = parameter(0, defaults.elements);
+        double exponent = parameter(1, defaults.exponent);
+        if (elements <= 0 || !(exponent > 0.0)) {
+            throw error("n and s must be positive");
+        }
+        return {name, ZipfDistribution{elements, exponent}};
+    }
+    if (distribution == "fk") {
+        // the skew is optional
+        if (parameters.size() != 3) {
+            expect_parameters(2);
+        }
+        auto first_key = parameter(0, defaults.first_key);
+        auto key_count = parameter(1, defaults.key_count);
+        double skew = parameters.size() == 3 ? parameter(2, defaults.skew) : defaults.skew;
+        if (!valid_key_range(first_key, key_count) || !(skew >= 0.0)) {
+            throw error("expected fk(first_key,key_count) or fk(first_key,key_count,skew) with a "
+                        "positive number of keys and a skew of at least 0");
+        }
+        return {name, ForeignKeyDistribution{first_key, key_count, skew}};
+    }
+    if (distribution == "unique") {
+        expect_parameters(2);
+        auto min = parameter(0, defaults.key_min);
+        std::optional<std::int64_t> permutation_max = last_key(min, row_count);
+        if (parameters.empty() && !permutation_max) {
+            throw error("the table has more rows than there are 64 bit keys from min on");
+        }
+        auto max = parameters.empty() ? *permutation_max : parameter(1, std::int64_t{0});
+        if (!holds_unique_keys(min, max, row_count)) {
+            throw error("[min, max] has fewer values than the table has rows");
+        }
+        return {name, UniqueKeyDistribution{min, max}};
+    }
+    if (distribution == "sequence" || distribution == "sorted") {
+        expect_parameters(2);
+        auto first = parameter(0, defaults.sequence_first);
+        auto step = parameter(1, defaults.sequence_step);
+        if (step <= 0) {
+            throw error("step must be positive");
+        }
+        // sorted has random gaps
+        return {name, SequenceDistribution{first, step, distribution == "sorted"}};
+    }
+    throw error("unknown distribution '" + distribution + "'");
+}
+
+/// @brief reads the column specifications (see @see parse_column) from a schema file,
+/// one per line; empty lines and lines starting with # are ignored
+std::vector<std::string> read_schema_file(const std::string& path) {
+    std::ifstream file{path};
+    if (!file) {
+        throw CLI::ValidationError{"can't open schema file " + path};
+    }
+    std::vector<std::string> columns;
+    for (std::string line; std::getline(file, line);) {
+        line.erase(0, line.find_first_not_of(" \t"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty() && line[0] != '#') {
+            columns.push_back(line);
+        }
+    }
+    return columns;
+}
 
 /// @brief creates the command line interface using CLI11 library
 /// @param options stores the parsed values
 /// @param[out] app output parameter (CLI::App's copy constructor is deleted)
-void make_cli_interface(CliOptions& options, CLI::App& app) {
+/// @param[out] columns column specifications given with --column
+/// @param[out] schema_file path given with --schema
+void make_cli_interface(CliOptions& options, CLI::App& app, std::vector<std::string>& columns,
+                        std::string& schema_file) {
     app.require_subcommand(0, 1);
 
     app.add_option("-n", options.sample_count, "number of rows to be generated")->check(CLI::PositiveNumber);
@@ -90,7 +509,42 @@ void make_cli_interface(CliOptions& options, CLI::App& app) {
 
     app.add_option("-o,--output", options.output, "output format")
         ->transform(CLI::CheckedTransformer{CliOptions::strToOutputFormat, CLI::ignore_case});
-    app.add_option("--tablename", options.tablename, "tablename for sql output");
+    app.add_option("--tablename", options.tablename, "tablename for sql, copy and sqlite output");
+    app.add_option("--batch-size", options.batch_size, "rows per INSERT statement (sql) or per transaction (sqlite)")
+        ->check(CLI::PositiveNumber);
+    app.add_option("--engine", options.engine, "random engine")
+        ->transform(CLI::CheckedTransformer{CliOptions::strToRandomEngine, CLI::ignore_case});
+    app.add_option("-j", options.thread_count, "number of threads generating the data")->check(CLI::PositiveNumber);
+    app.add_option("--out-file", options.out_file, "write the data to this file instead of stdout");
+    app.add_option("--compress", options.compression, "compress the output (gzip, zstd or lz4) on all threads")
+        ->transform(CLI::CheckedTransformer{CliOptions::strToCompression, CLI::ignore_case});
+    app.add_option("--shards", options.shard_count, "split the table into this many shards of consecutive rows")
+        ->check(CLI::PositiveNumber);
+    app.add_option("--shard-index", options.shard_index, "generate only this shard (0 to --shards - 1)");
+    app.add_option("--out-dir", options.out_dir, "write every shard to its own file in this directory, in parallel");
+    app.add_option_function<std::string>("--stats", [&](const std::string& format) {
+        if (format.empty() || format == "text") {
+            options.stats = CliOptions::StatsFormat::text;
+        } else if (format == "json") {
+            options.stats = CliOptions::StatsFormat::json;
+        } else {
+            throw CLI::ValidationError{"--stats is either text or json"};
+        }
+    }, "print the time of every phase, the throughput and the peak memory to stderr (text or json)")
+        ->expected(0, 1);
+    app.add_flag("--numa", options.numa,
+                 "pin the threads to the cpus of the numa nodes, each generating and writing node-local rows");
+    app.add_option("--column", columns,
+                   "column with its own distribution (repeatable), e.g. price:normal(100,15)")
+        ->allow_extra_args(false);
+    app.add_option("--schema", schema_file, "file with one --column specification per line");
+    app.add_flag("--stream", options.stream, "generate and output the data in chunks with constant memory usage");
+    app.add_option("--rows-per-sec", options.rows_per_second,
+                   "write rows continuously at this rate (0: as fast as possible); without -n until the output is closed")
+        ->check(CLI::NonNegativeNumber);
+    app.add_option("--start-row", options.start_row,
+                   "continue the table from this row (no header; appended to --out-file)");
+    app.add_flag("--resume", options.resume, "continue --out-file from the checkpoint of an interrupted run");
 
     auto uniform_command = app.add_subcommand("uniform", "generates random integers from a uniform distribution")
         ->callback([&]() {
@@ -104,13 +558,59 @@ void make_cli_interface(CliOptions& options, CLI::App& app) {
         options.distribution = CliOptions::RandomDistribution::normal;
     });
     normal_command->add_option("--mean", options.mean, "the mean of the normal distribution");
-    normal_command->add_option("--stddev", options.stddev, "the standard deviation of the normal distribution");
+    normal_command->add_option("--stddev", options.stddev, "the standard deviation of the normal distribution")
+        ->check(CLI::PositiveNumber);
 
     auto bernoulli_command = app.add_subcommand("bernoulli", "generates random booleans from a bernoulli distribution")
         ->callback([&]() {
         options.distribution = CliOptions::RandomDistribution::bernoulli;
     });
     bernoulli_command->add_option("-p", options.p, "the probability p of the bernoulli distribution")->check(CLI::Range{0.0, 1.0});
+
+    auto zipf_command = app.add_subcommand("zipf", "generates random integers 1, ..., n from a zipf distribution")
+        ->callback([&]() {
+        options.distribution = CliOptions::RandomDistribution::zipf;
+    });
+    zipf_command->add_option("--elements", options.elements, "the number of elements n")->check(CLI::PositiveNumber);
+    zipf_command->add_option("--exponent", options.exponent, "the exponent s; the probability of k is proportional to 1/k^s")
+        ->check(CLI::PositiveNumber);
+
+    auto foreign_key_command = app.add_subcommand("foreign-key", "generates keys of another table's key range")
+        ->callback([&]() {
+        options.distribution = CliOptions::RandomDistribution::foreign_key;
+    });
+    foreign_key_command->add_option("--first-key", options.first_key, "the first key of the referenced table");
+    foreign_key_command->add_option("--keys", options.key_count, "the number of keys of the referenced table")
+        ->check(CLI::PositiveNumber);
+    foreign_key_command->add_option("--skew", options.skew, "zipf exponent of the references, 0 for uniform")
+        ->check(CLI::NonNegativeNumber);
+
+    auto mvnormal_command = app.add_subcommand("mvnormal", "generates rows of correlated doubles from a multivariate normal distribution")
+        ->callback([&]() {
+        options.distribution = CliOptions::RandomDistribution::mvnormal;
+    });
+    mvnormal_command->add_option("--mean", options.means, "the means of the columns, e.g. 0,10 (default: 0)")
+        ->delimiter(',');
+    mvnormal_command->add_option("--covariance", options.covariance, "the covariance matrix row by row, e.g. 1,0.5,0.5,1")
+        ->delimiter(',')
+        ->required();
+
+    auto unique_command = app.add_subcommand("unique", "generates unique random integers, e.g. a permutation of 1, ..., n")
+        ->callback([&]() {
+        options.distribution = CliOptions::RandomDistribution::unique;
+    });
+    unique_command->add_option("--min", options.key_min, "minimum value of the keys");
+    unique_command->add_option("--max", options.key_max, "maximum value of the keys (default: a permutation)");
+
+    auto sequence_command = app.add_subcommand("sequence", "generates strictly increasing integers")
+        ->callback([&]() {
+        options.distribution = CliOptions::RandomDistribution::sequence;
+    });
+    sequence_command->add_option("--first", options.sequence_first, "the first value");
+    sequence_command->add_option("--step", options.sequence_step, "the difference between consecutive values")
+        ->check(CLI::PositiveNumber);
+    sequence_command->add_flag("--random-gaps", options.random_gaps,
+                               "add a random gap smaller than the step to every value");
 }
 
 /// @brief parse and validate the command line arguments
@@ -120,17 +620,154 @@ void make_cli_interface(CliOptions& options, CLI::App& app) {
 CliOptions parse_cli_options(int argc, char* argv[]) {
     CliOptions options{};
     CLI::App app{"random number generator"};
-    make_cli_interface(options, app);
+    std::vector<std::string> columns;
+    std::string schema_file;
+    make_cli_interface(options, app, columns, schema_file);
 
     try {
         app.parse(argc, argv);
 
+        if (!schema_file.empty()) {
+            std::vector<std::string> file_columns = read_schema_file(schema_file);
+            columns.insert(columns.begin(), file_columns.begin(), file_columns.end());
+            if (columns.empty()) {
+                throw CLI::ValidationError{"schema file " + schema_file + " has no columns"};
+            }
+        }
+        for (const std::string& column : columns) {
+            options.schema.push_back(parse_column(column, options.sample_count));
+        }
+        if (!options.schema.empty()) {
+            bool subcommand = app.got_subcommand("uniform") || app.got_subcommand("normal") ||
+                              app.got_subcommand("bernoulli") || app.got_subcommand("zipf") ||
+                              app.got_subcommand("foreign-key") || app.got_subcommand("mvnormal") ||
+                              app.got_subcommand("unique") || app.got_subcommand("sequence");
+            if (subcommand || app.count("-c")) {
+                throw CLI::ValidationError{"--column and --schema replace -c and the distribution subcommand"};
+            }
+            if (CliOptions::is_binary(options.output)) {
+                throw CLI::ValidationError{"--column and --schema don't work with binary output formats"};
+            }
+        }
+
         if (app.got_subcommand("uniform") && options.min >= options.max) {
                 throw CLI::ValidationError{"min must be smaller than max"};
         }
 
-        if (app.count("--tablename") && options.output != CliOptions::OutputFormat::sql) {
-            throw CLI::ValidationError{"--tablename works only with --output sql"};
+        // PositiveNumber lets nan through
+        if (app.got_subcommand("normal") && !(options.stddev > 0.0)) {
+            throw CLI::ValidationError{"--stddev must be positive"};
+        }
+
+        if (app.got_subcommand("foreign-key") && !valid_key_range(options.first_key, options.key_count)) {
+            throw CLI::ValidationError{"the keys of foreign-key don't fit into 64 bit integers"};
+        }
+
+        if (app.got_subcommand("unique")) {
+            if (options.sample_count > std::numeric_limits<std::uint64_t>::max() / options.col_count) {
+                throw CLI::ValidationError{"unique: the table has more than 2^64 cells"};
+            }
+            std::uint64_t cells = options.sample_count * options.col_count;
+            if (!app.get_subcommand("unique")->count("--max")) {
+                std::optional<std::int64_t> permutation_max = last_key(options.key_min, cells);
+                if (!permutation_max) {
+                    throw CLI::ValidationError{"unique: the keys from --min on don't fit into 64 bit integers"};
+                }
+                options.key_max = *permutation_max;
+            }
+            if (!holds_unique_keys(options.key_min, options.key_max, cells)) {
+                throw CLI::ValidationError{"unique: [--min, --max] has fewer values than the table has cells"};
+            }
+        }
+
+        if (app.got_subcommand("mvnormal")) {
+            // the covariance matrix has a row and a column per column of the table
+            auto dimension = static_cast<std::uint64_t>(std::llround(std::sqrt(options.covariance.size())));
+            if (dimension == 0 || dimension * dimension != options.covariance.size()) {
+                throw CLI::ValidationError{"--covariance needs n*n values for n columns"};
+            }
+            if (app.count("-c") && options.col_count != dimension) {
+                throw CLI::ValidationError{"-c must be the number of rows of the covariance matrix"};
+            }
+            options.col_count = dimension;
+            if (options.means.empty()) {
+                options.means.assign(dimension, 0.0);
+            }
+            try {
+                MultivariateNormalDistribution{options.means, options.covariance};
+            } catch (const std::invalid_argument& e) {
+                throw CLI::ValidationError{std::string{"mvnormal: "} + e.what()};
+            }
+        }
+
+        if (app.count("--tablename") && options.output != CliOptions::OutputFormat::sql &&
+            options.output != CliOptions::OutputFormat::copy &&
+            options.output != CliOptions::OutputFormat::sqlite) {
+            throw CLI::ValidationError{"--tablename works only with --output sql, copy or sqlite"};
+        }
+
+        if (app.count("--batch-size") && options.output != CliOptions::OutputFormat::sql &&
+            options.output != CliOptions::OutputFormat::sqlite) {
+            throw CLI::ValidationError{"--batch-size works only with --output sql or sqlite"};
+        }
+
+        if (options.output == CliOptions::OutputFormat::sqlite && options.out_file.empty() &&
+            options.out_dir.empty()) {
+            throw CLI::ValidationError{"--output sqlite needs --out-file (the database file) or --out-dir"};
+        }
+
+        if (options.shard_count > options.sample_count) {
+            throw CLI::ValidationError{"--shards must not be larger than -n"};
+        }
+        if (options.shard_index >= options.shard_count) {
+            throw CLI::ValidationError{"--shard-index must be smaller than --shards"};
+        }
+        if (!options.out_dir.empty() && (app.count("--shard-index") || !options.out_file.empty())) {
+            throw CLI::ValidationError{"--out-dir writes all shards and replaces --shard-index and --out-file"};
+        }
+
+        if (!compression_available(options.compression)) {
+            throw CLI::ValidationError{"--compress " + CliOptions::compressionToStr.at(options.compression) +
+                                       " isn't available in this build"};
+        }
+        if (options.compression != Compression::none && options.output == CliOptions::OutputFormat::sqlite) {
+            throw CLI::ValidationError{"--compress doesn't work with --output sqlite"};
+        }
+        if (options.rows_per_second) {
+            if (CliOptions::is_binary(options.output) || options.output == CliOptions::OutputFormat::sqlite) {
+                throw CLI::ValidationError{"--rows-per-sec only works with the text formats"};
+            }
+            options.unbounded = !app.count("-n");
+        }
+        if (options.unbounded && (options.shard_count > 1 || !options.out_dir.empty())) {
+            throw CLI::ValidationError{"--shards need -n; --rows-per-sec without -n doesn't end"};
+        }
+        if (options.start_row > 0 || options.resume) {
+            if (CliOptions::is_binary(options.output) || options.output == CliOptions::OutputFormat::sqlite) {
+                throw CLI::ValidationError{"--start-row and --resume only work with the text formats"};
+            }
+            if (options.shard_count > 1 || !options.out_dir.empty() || options.rows_per_second) {
+                throw CLI::ValidationError{"--start-row and --resume don't work with --shards, --out-dir or --rows-per-sec"};
+            }
+            if (!app.count("--seed")) {
+                throw CLI::ValidationError{"--start-row and --resume need the --seed of the table"};
+            }
+        }
+        if (options.start_row >= options.sample_count) {
+            throw CLI::ValidationError{"--start-row must be smaller than -n"};
+        }
+        if (options.resume && (options.out_file.empty() || app.count("--start-row"))) {
+            throw CLI::ValidationError{"--resume needs --out-file and replaces --start-row"};
+        }
+        bool unique_columns = std::any_of(options.schema.begin(), options.schema.end(), [](const ColumnSchema& column) {
+            return std::holds_alternative<UniqueKeyDistribution>(column.distribution);
+        });
+        if (options.unbounded && (app.got_subcommand("unique") || unique_columns)) {
+            throw CLI::ValidationError{"unique keys need -n; use sequence for a stream without end"};
+        }
+
+        if (options.stats != CliOptions::StatsFormat::none && !stats_available()) {
+            throw CLI::ValidationError{"--stats isn't available in this build"};
         }
         return options;
     } catch (const CLI::ParseError& e) {
@@ -138,38 +775,474 @@ CliOptions parse_cli_options(int argc, char* argv[]) {
     }
 }
 
-/// @brief utility function to select the right output method based on @see CliOptions::OutputFormat
-/// @tparam T Type of the generated data (int, double, bool, ...)
-template<class T>
-void output(Data<T>&& data, const CliOptions& options) {
-    // this can't be put into virtual methods because they would need a template
-    // parameter (T) which c++ doesn't allow
+/// @brief utility function to select the right text format based on @see CliOptions::OutputFormat
+TextFormat table_format(const CliOptions& options) {
+    std::vector<std::string> column_names;
+    for (const ColumnSchema& column : options.schema) {
+        column_names.push_back(column.name);
+    }
     switch(options.output) {
         case CliOptions::OutputFormat::csv:
-            output_csv<T>(data, std::cout);
-        break;
+            return csv_format();
         case CliOptions::OutputFormat::json:
-            output_json<T>(data, std::cout);
-        break;
+            return json_format();
         case CliOptions::OutputFormat::sql:
-            output_sql<T>(data, std::cout, options.tablename);
-        break;
+            return sql_format(options.tablename, column_names, options.batch_size);
+        case CliOptions::OutputFormat::copy:
+            return postgres_copy_format(options.tablename, column_names);
+        case CliOptions::OutputFormat::raw:
+        case CliOptions::OutputFormat::arrow:
+        case CliOptions::OutputFormat::copy_binary:
+        case CliOptions::OutputFormat::sqlite:
+            break;
+    }
+    throw std::logic_error{"not a text format"};
+}
+
+/// @brief the text format for the shard of the table that is generated (see @see shard_format)
+TextFormat text_format(const CliOptions& options) {
+    return shard_format(table_format(options), options.rows(), options.sample_count);
+}
+
+#ifdef DATAGEN_WITH_SQLITE
+/// @brief creates the @see SqliteWriter for @see CliOptions::out_file
+SqliteWriter make_sqlite_writer(const CliOptions& options) {
+    return SqliteWriter{options.out_file, options.tablename,
+                        options.batch_size > 0 ? options.batch_size : 100000};
+}
+#endif
+
+/// @brief generates the data with the given distribution and writes it with writer,
+/// either as a whole or chunk by chunk (see @see CliOptions::stream)
+/// @details with --numa always chunk by chunk: a @see FileTableWriter formats a chunk on
+/// the threads that generated it, but not a whole table, whose threads generate far more
+/// rows than a writer formats at a time
+/// @tparam Writer @see TableWriter, @see FileTableWriter, one of the binary writers or @see SqliteWriter
+template<class RandomEngine, class Writer, class RandomNumberDistribution>
+void generate_and_write(Writer& writer, RandomNumberDistribution&& random, const CliOptions& options) {
+    using T = typename RandomNumberDistribution::result_type;
+    if (options.stream || options.numa) {
+        generate_stream<RandomEngine>(options.rows(), options.col_count, std::move(random),
+                                      [&](const Data<T>& chunk, std::uint64_t rows) {
+                                          writer.write_rows(chunk, rows);
+                                      },
+                                      options.seed, 0, options.thread_count);
+    } else {
+        RowRange rows = options.rows();
+        writer.write_rows(generate_rows<RandomEngine>(rows.first_row, rows.row_count, options.col_count,
+                                                      std::move(random), options.seed,
+                                                      options.thread_count));
+    }
+    writer.finish();
+}
+
+/// @brief generates the data with the given distribution and writes it in a binary
+/// format (see @see CliOptions::is_binary) to ostream, uncompressed
+template<class RandomEngine, class RandomNumberDistribution>
+void write_binary(RandomNumberDistribution&& random, const CliOptions& options, std::ostream& ostream) {
+    using T = typename RandomNumberDistribution::result_type;
+    if (options.output == CliOptions::OutputFormat::raw) {
+        RawColumnWriter<T> writer{ostream, options.col_count};
+        generate_and_write<RandomEngine>(writer, std::move(random), options);
+    } else if (options.output == CliOptions::OutputFormat::arrow) {
+        ArrowWriter<T> writer{ostream, options.col_count};
+        generate_and_write<RandomEngine>(writer, std::move(random), options);
+    } else if constexpr (detail::PostgresWritable<T>) {
+        PostgresBinaryWriter<T> writer{ostream, options.col_count};
+        generate_and_write<RandomEngine>(writer, std::move(random), options);
+    } else {
+        // main only narrows the uniform range for the other formats
+        throw std::logic_error{"no PostgreSQL binary type for this column type"};
+    }
+    if (!ostream) {
+        throw std::runtime_error{"writing the output failed"};
+    }
+}
+
+/// @brief generates the data with the given distribution and writes it in a binary
+/// format (see @see CliOptions::is_binary) to ostream, compressed with
+/// @see CliOptions::compression
+template<class RandomEngine, class RandomNumberDistribution>
+void generate_and_output_binary(RandomNumberDistribution&& random, const CliOptions& options,
+                                std::ostream& ostream) {
+    if (options.compression == Compression::none) {
+        write_binary<RandomEngine>(std::move(random), options, ostream);
+        return;
+    }
+    CompressingBuffer buffer{ostream, options.compression, options.thread_count};
+    std::ostream compressed{&buffer};
+    write_binary<RandomEngine>(std::move(random), options, compressed);
+    buffer.finish();
+}
+
+/// @brief writes batches of rows to stdout or @see CliOptions::out_file as soon as they are
+/// due at @see CliOptions::rows_per_second (see @see RateLimiter)
+/// @tparam T type of the generated data, or @see ColumnTable
+/// @param block_cols number of columns that the blocks of rows are generated for
+/// (@see block_rows)
+/// @param stream calls @see generate_stream or @see generate_table_stream as
+/// stream(batch_rows, thread_count, consume)
+template<class T, class Stream>
+void output_paced(const CliOptions& options, std::uint64_t block_cols, Stream stream) {
+    RateLimiter limiter{*options.rows_per_second};
+    std::uint64_t max_rows = options.thread_count * block_rows(block_cols);
+    std::uint64_t batch_rows = limiter.batch_rows(max_rows);
+    // batches smaller than a block per thread are generated by a single thread, which
+    // continues its random streams from batch to batch
+    unsigned int thread_count = batch_rows < max_rows ? 1 : options.thread_count;
+    auto write = [&](auto& writer) {
+        stream(batch_rows, thread_count, [&](const auto& chunk, std::uint64_t rows) {
+            limiter.wait(rows);
+            writer.write_rows(chunk, rows);
+        });
+        writer.finish();
+    };
+    if (options.out_file.empty()) {
+        PipelineTableWriter<T> writer{std::cout, text_format(options), options.thread_count, {},
+                                      options.compression};
+        write(writer);
+    } else {
+        FileTableWriter<T> writer{options.out_file, text_format(options), options.thread_count, {},
+                                  options.compression};
+        write(writer);
+    }
+}
+
+/// @brief prints the command line of options, see below
+std::ostream& operator<<(std::ostream& os, const CliOptions& options);
+
+/// @brief the comment of the whole table, without --start-row, that identifies the
+/// table of a checkpoint
+std::string table_comment(const CliOptions& options) {
+    CliOptions table = options;
+    table.start_row = 0;
+    std::ostringstream comment;
+    comment << table;
+    return comment.str();
+}
+
+/// @brief file in which a run writing @see CliOptions::out_file records how far it got,
+/// for --resume; removed once the table is complete
+std::string checkpoint_path(const CliOptions& options) {
+    return options.out_file + ".checkpoint";
+}
+
+/// @brief time between two checkpoints, each of which syncs the file
+constexpr std::chrono::seconds checkpoint_interval{1};
+
+/// @brief makes the file or directory at path durable (fsync)
+/// @throws std::system_error if it can't be opened or synced
+void sync_path(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error{errno, std::generic_category(), path};
+    }
+    int result = ::fsync(fd);
+    int error = errno;
+    ::close(fd);
+    if (result != 0) {
+        throw std::system_error{error, std::generic_category(), "fsync " + path};
+    }
+}
+
+/// @brief records checkpoint of @see CliOptions::out_file: the comment of the table
+/// and the rows and bytes written, replacing the last checkpoint at once
+/// @details the new checkpoint is synced before it replaces the last one and the
+/// directory after, so that after a crash the checkpoint is complete and not older
+/// than the rows that were synced before it
+void write_checkpoint(const CliOptions& options, FileCheckpoint checkpoint) {
+    std::string path = checkpoint_path(options);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file{temporary, std::ios::trunc};
+        file << table_comment(options) << "\n" << checkpoint.rows << " " << checkpoint.bytes << "\n";
+        if (!file.flush()) {
+            throw std::runtime_error{"can't write " + temporary};
+        }
+    }
+    sync_path(temporary);
+    std::filesystem::rename(temporary, path);
+    std::filesystem::path directory = std::filesystem::path{path}.parent_path();
+    sync_path(directory.empty() ? "." : directory.string());
+}
+
+/// @brief sets @see CliOptions::start_row and @see CliOptions::resume_checkpoint from the
+/// checkpoint of @see CliOptions::out_file; without a checkpoint and a file, the table is
+/// written from its start
+/// @throws std::runtime_error if there is a file but no checkpoint or the checkpoint is that
+/// of another table
+void resume_from_checkpoint(CliOptions& options) {
+    std::string path = checkpoint_path(options);
+    std::ifstream file{path};
+    if (!file) {
+        if (std::filesystem::exists(options.out_file)) {
+            throw std::runtime_error{"no checkpoint " + path + " to resume " + options.out_file + " from"};
+        }
+        options.resume = false;
+        return;
+    }
+    std::string comment;
+    FileCheckpoint checkpoint;
+    if (!std::getline(file, comment) || !(file >> checkpoint.rows >> checkpoint.bytes)) {
+        throw std::runtime_error{"can't read the checkpoint " + path};
+    }
+    if (comment != table_comment(options)) {
+        throw std::runtime_error{path + " is the checkpoint of another table: " + comment};
+    }
+    options.start_row = checkpoint.rows;
+    options.resume_checkpoint = checkpoint;
+}
+
+/// @brief where appending the rows from --start-row continues @see CliOptions::out_file:
+/// at its end, without the suffix of the format if the file ends with it (e.g. the ] of json)
+/// @throws std::runtime_error if the suffix would have to be removed from compressed output
+FileCheckpoint append_checkpoint(const CliOptions& options) {
+    FileCheckpoint checkpoint{options.start_row, 0};
+    std::error_code error;
+    std::uintmax_t size = std::filesystem::file_size(options.out_file, error);
+    if (error) {
+        // a new file
+        return checkpoint;
+    }
+    checkpoint.bytes = size;
+    std::string suffix = table_format(options).suffix;
+    if (suffix.empty() || size < suffix.size()) {
+        return checkpoint;
+    }
+    if (options.compression != Compression::none) {
+        throw std::runtime_error{"can't remove the end of the compressed table in " + options.out_file};
+    }
+    std::ifstream file{options.out_file, std::ios::binary};
+    std::string end(suffix.size(), '\0');
+    file.seekg(static_cast<std::streamoff>(size - suffix.size()));
+    file.read(end.data(), static_cast<std::streamsize>(end.size()));
+    if (file && end == suffix) {
+        checkpoint.bytes -= suffix.size();
+    }
+    return checkpoint;
+}
+
+/// @brief writes the rows from @see CliOptions::start_row on, to @see CliOptions::out_file
+/// with a checkpoint every @see checkpoint_interval, or to stdout as the continuation of the
+/// table
+/// @tparam T type of the generated data, or @see ColumnTable
+/// @param stream see @see output_paced
+template<class T, class Stream>
+void output_resumable(const CliOptions& options, Stream stream) {
+    auto generate = [&](auto consume) {
+        // none are left if --resume continues after the last row
+        if (options.rows().row_count > 0) {
+            stream(0, options.thread_count, consume);
+        }
+    };
+    if (options.out_file.empty()) {
+        TextFormat format = text_format(options);
+        format.prefix.clear();
+        PipelineTableWriter<T> writer{std::cout, format, options.thread_count, {}, options.compression};
+        writer.resume_at(options.start_row);
+        generate([&](const auto& chunk, std::uint64_t rows) { writer.write_rows(chunk, rows); });
+        writer.finish();
+        return;
+    }
+    std::optional<FileCheckpoint> resume;
+    if (options.resume) {
+        resume = options.resume_checkpoint;
+    } else if (options.start_row > 0) {
+        resume = append_checkpoint(options);
+    }
+    FileTableWriter<T> writer{options.out_file, text_format(options), options.thread_count, {},
+                              options.compression, resume};
+    auto checkpoint = [&] {
+        writer.sync();
+        write_checkpoint(options, writer.checkpoint());
+        return std::chrono::steady_clock::now();
+    };
+    auto last_checkpoint = checkpoint();
+    generate([&](const auto& chunk, std::uint64_t rows) {
+        writer.write_rows(chunk, rows);
+        if (std::chrono::steady_clock::now() - last_checkpoint >= checkpoint_interval) {
+            last_checkpoint = checkpoint();
+        }
+    });
+    writer.finish();
+    std::filesystem::remove(checkpoint_path(options));
+}
+
+/// @brief generates the data with the given distribution and writes it to stdout
+/// or to @see CliOptions::out_file
+template<class RandomEngine, class RandomNumberDistribution>
+void generate_and_output(RandomNumberDistribution&& random, const CliOptions& options) {
+    using T = typename RandomNumberDistribution::result_type;
+    auto stream = [&](std::uint64_t chunk_rows, unsigned int thread_count, auto consume) {
+        generate_stream<RandomEngine>(options.rows(), options.col_count, std::move(random), consume,
+                                      options.seed, chunk_rows, thread_count);
+    };
+    if (options.rows_per_second) {
+        output_paced<T>(options, options.col_count, stream);
+        return;
+    }
+    bool binary = CliOptions::is_binary(options.output);
+    if (options.output == CliOptions::OutputFormat::sqlite) {
+#ifdef DATAGEN_WITH_SQLITE
+        SqliteWriter writer = make_sqlite_writer(options);
+        generate_and_write<RandomEngine>(writer, std::move(random), options);
+#endif
+    } else if (binary && options.out_file.empty()) {
+        generate_and_output_binary<RandomEngine>(std::move(random), options, std::cout);
+    } else if (binary) {
+        std::ofstream file{options.out_file, std::ios::binary};
+        if (!file) {
+            throw std::runtime_error{"can't open " + options.out_file};
+        }
+        // times the writes to the file for --stats
+        StatsBuffer sink{*file.rdbuf()};
+        std::streambuf* target = file.rdbuf();
+        if (options.stats != CliOptions::StatsFormat::none) {
+            target = &sink;
+        }
+        std::ostream out{target};
+        generate_and_output_binary<RandomEngine>(std::move(random), options, out);
+        if (!out.flush()) {
+            throw std::runtime_error{"writing the output failed"};
+        }
+    } else if (options.out_file.empty() && options.start_row == 0) {
+        // generated, formatted and written in a pipeline, with bounded memory
+        // whether or not --stream is given
+        generate_text<RandomEngine>(options.rows(), options.col_count, std::move(random),
+                                    std::cout, text_format(options), options.seed,
+                                    options.thread_count, {}, options.compression);
+    } else if (options.shard_count > 1) {
+        // shards are written from scratch
+        FileTableWriter<T> writer{options.out_file, text_format(options), options.thread_count, {},
+                                  options.compression};
+        generate_and_write<RandomEngine>(writer, std::move(random), options);
+    } else {
+        output_resumable<T>(options, stream);
+    }
+}
+
+/// @brief calls @see generate_and_output with the engine selected by @see CliOptions::RandomEngine
+template<class RandomNumberDistribution>
+void generate_and_output(RandomNumberDistribution&& random, const CliOptions& options) {
+    switch (options.engine) {
+        case CliOptions::RandomEngine::mt19937:
+            generate_and_output<std::mt19937>(std::move(random), options);
+            break;
+        case CliOptions::RandomEngine::philox:
+            generate_and_output<Philox4x32>(std::move(random), options);
+            break;
+    }
+}
+
+/// @brief generates the table described by @see CliOptions::schema and writes it
+/// to stdout or to @see CliOptions::out_file
+template<class RandomEngine>
+void generate_and_output_table(const CliOptions& options) {
+    auto stream = [&](std::uint64_t chunk_rows, unsigned int thread_count, auto consume) {
+        generate_table_stream<RandomEngine>(options.rows(), options.schema, consume, options.seed,
+                                            chunk_rows, thread_count);
+    };
+    if (options.rows_per_second) {
+        // the columns are generated like tables of a single column
+        output_paced<ColumnTable>(options, 1, stream);
+        return;
+    }
+    auto write = [&](auto& writer) {
+        if (options.stream) {
+            generate_table_stream<RandomEngine>(options.rows(), options.schema,
+                                                [&](const ColumnTable& chunk, std::uint64_t rows) {
+                                                    writer.write_rows(chunk, rows);
+                                                },
+                                                options.seed, 0, options.thread_count);
+        } else {
+            writer.write_rows(generate_table<RandomEngine>(options.rows(), options.schema,
+                                                           options.seed, options.thread_count));
+        }
+        writer.finish();
+    };
+    if (options.output == CliOptions::OutputFormat::sqlite) {
+#ifdef DATAGEN_WITH_SQLITE
+        SqliteWriter writer = make_sqlite_writer(options);
+        write(writer);
+#endif
+    } else if (options.out_file.empty() && options.start_row == 0) {
+        generate_table_text<RandomEngine>(options.rows(), options.schema, std::cout,
+                                          text_format(options), options.seed,
+                                          options.thread_count, options.compression);
+    } else if (options.shard_count > 1) {
+        FileTableWriter<ColumnTable> writer{options.out_file, text_format(options),
+                                            options.thread_count, {}, options.compression};
+        write(writer);
+    } else {
+        output_resumable<ColumnTable>(options, stream);
     }
 }
 
+/// @brief calls @see generate_and_output_table with the engine selected by @see CliOptions::RandomEngine
+void generate_and_output_table(const CliOptions& options) {
+    switch (options.engine) {
+        case CliOptions::RandomEngine::mt19937:
+            generate_and_output_table<std::mt19937>(options);
+            break;
+        case CliOptions::RandomEngine::philox:
+            generate_and_output_table<Philox4x32>(options);
+            break;
+    }
+}
+
+/// @brief the values separated by commas, as the list options read them, each in the
+/// shortest form that reads back to the same value
+std::string join(const std::vector<double>& values) {
+    std::string joined;
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        joined += (i > 0 ? "," : "") + detail::exact_string(values[i]);
+    }
+    return joined;
+}
+
 /// @brief overloads << operator to print CliOptions instance
 /// @details outputs a string that could be used to re-create the exact same random values
 std::ostream& operator<<(std::ostream& os, const CliOptions& options) {
     os << CliOptions::outputFormatToComment.at(options.output) << " ";
     os << "gendata";
-    os << " -n " << options.sample_count;
-    os << " -c " << options.col_count;
+    if (!options.unbounded) {
+        os << " -n " << options.sample_count;
+    }
+    if (options.schema.empty()) {
+        os << " -c " << options.col_count;
+    }
     os << " --seed " << options.seed;
     os << " -o ";
     os << CliOptions::outputFormatToStr.at(options.output);
-    if (options.output == CliOptions::OutputFormat::sql) {
+    os << " --engine " << CliOptions::randomEngineToStr.at(options.engine);
+    if (options.output == CliOptions::OutputFormat::sql || options.output == CliOptions::OutputFormat::copy ||
+        options.output == CliOptions::OutputFormat::sqlite) {
         os << " --tablename " << options.tablename;
     }
+    if (options.batch_size > 0) {
+        os << " --batch-size " << options.batch_size;
+    }
+    if (options.compression != Compression::none) {
+        os << " --compress " << CliOptions::compressionToStr.at(options.compression);
+    }
+    if (options.start_row > 0) {
+        os << " --start-row " << options.start_row;
+    }
+    if (options.rows_per_second) {
+        os << " --rows-per-sec " << detail::exact_string(*options.rows_per_second);
+    }
+    if (options.shard_count > 1) {
+        os << " --shards " << options.shard_count;
+        if (options.out_dir.empty()) {
+            os << " --shard-index " << options.shard_index;
+        }
+    }
+    if (!options.schema.empty()) {
+        for (const ColumnSchema& column : options.schema) {
+            os << " --column '" << column << "'";
+        }
+        return os;
+    }
     switch (options.distribution) {
         case CliOptions::RandomDistribution::uniform:
             os << " uniform";
@@ -178,44 +1251,201 @@ std::ostream& operator<<(std::ostream& os, const CliOptions& options) {
             break;
         case CliOptions::RandomDistribution::normal:
             os << " normal";
-            os << " --mean " << options.mean;
-            os << " --stddev " << options.stddev;
+            os << " --mean " << detail::exact_string(options.mean);
+            os << " --stddev " << detail::exact_string(options.stddev);
             break;
         case CliOptions::RandomDistribution::bernoulli:
             os << " bernoulli";
-            os << " -p " << options.p;
+            os << " -p " << detail::exact_string(options.p);
+            break;
+        case CliOptions::RandomDistribution::zipf:
+            os << " zipf";
+            os << " --elements " << options.elements;
+            os << " --exponent " << detail::exact_string(options.exponent);
+            break;
+        case CliOptions::RandomDistribution::foreign_key:
+            os << " foreign-key";
+            os << " --first-key " << options.first_key;
+            os << " --keys " << options.key_count;
+            os << " --skew " << detail::exact_string(options.skew);
+            break;
+        case CliOptions::RandomDistribution::mvnormal:
+            os << " mvnormal";
+            os << " --mean " << join(options.means);
+            os << " --covariance " << join(options.covariance);
+            break;
+        case CliOptions::RandomDistribution::unique:
+            os << " unique";
+            os << " --min " << options.key_min;
+            os << " --max " << options.key_max;
+            break;
+        case CliOptions::RandomDistribution::sequence:
+            os << " sequence";
+            os << " --first " << options.sequence_first;
+            os << " --step " << options.sequence_step;
+            if (options.random_gaps) {
+                os << " --random-gaps";
+            }
             break;
     }
     return os;
 }
 
-/// @brief parses command line parameters, generates and outputs data (stdout)
-/// and prints a string with used command line options (stderr)
+/// @brief generates the table (or shard) described by options and writes it to stdout or to
+/// @see CliOptions::out_file
+void generate_and_output(const CliOptions& options) {
+    if (!options.schema.empty()) {
+        generate_and_output_table(options);
+        return;
+    }
+    switch (options.distribution) {
+        case CliOptions::RandomDistribution::uniform:
+            if (CliOptions::is_binary(options.output)) {
+                // the binary formats keep their int columns whatever the range
+                generate_and_output(UniformIntDistribution{options.min, options.max}, options);
+            } else {
+                // text and sqlite output are the same with the smallest integer type
+                std::visit([&](auto random) { generate_and_output(std::move(random), options); },
+                           narrowest_uniform(options.min, options.max));
+            }
+            break;
+        case CliOptions::RandomDistribution::normal:
+            generate_and_output(NormalDistribution{options.mean, options.stddev}, options);
+            break;
+        case CliOptions::RandomDistribution::bernoulli:
+            generate_and_output(BernoulliDistribution{options.p}, options);
+            break;
+        case CliOptions::RandomDistribution::zipf:
+            generate_and_output(ZipfDistribution{options.elements, options.exponent}, options);
+            break;
+        case CliOptions::RandomDistribution::foreign_key:
+            generate_and_output(ForeignKeyDistribution{options.first_key, options.key_count, options.skew},
+                                options);
+            break;
+        case CliOptions::RandomDistribution::mvnormal:
+            generate_and_output(MultivariateNormalDistribution{options.means, options.covariance}, options);
+            break;
+        case CliOptions::RandomDistribution::unique:
+            generate_and_output(UniqueKeyDistribution{options.key_min, options.key_max}, options);
+            break;
+        case CliOptions::RandomDistribution::sequence:
+            generate_and_output(SequenceDistribution{options.sequence_first, options.sequence_step,
+                                                     options.random_gaps},
+                                options);
+            break;
+    }
+}
+
+/// @brief path of the file of shard shard_index in @see CliOptions::out_dir, e.g. shard-007.csv.gz
+std::string shard_path(const CliOptions& options, std::uint64_t shard_index) {
+    static const std::unordered_map<CliOptions::OutputFormat, std::string> extensions{
+        {CliOptions::OutputFormat::csv, ".csv"},       {CliOptions::OutputFormat::sql, ".sql"},
+        {CliOptions::OutputFormat::json, ".json"},     {CliOptions::OutputFormat::raw, ".bin"},
+        {CliOptions::OutputFormat::arrow, ".arrow"},   {CliOptions::OutputFormat::copy, ".sql"},
+        {CliOptions::OutputFormat::copy_binary, ".bin"}, {CliOptions::OutputFormat::sqlite, ".db"}};
+    static const std::unordered_map<Compression, std::string> compression_extensions{
+        {Compression::none, ""}, {Compression::gzip, ".gz"}, {Compression::zstd, ".zst"},
+        {Compression::lz4, ".lz4"}};
+
+    // all names have as many digits as the last one, so that they sort by index
+    std::string index = std::to_string(shard_index);
+    index.insert(0, std::to_string(options.shard_count - 1).size() - index.size(), '0');
+    std::string name = "shard-" + index + extensions.at(options.output) +
+                       compression_extensions.at(options.compression);
+    return (std::filesystem::path{options.out_dir} / name).string();
+}
+
+/// @brief writes every shard to its own file in @see CliOptions::out_dir; the threads take one
+/// shard after the other and generate and write it on their own
+void generate_and_output_shards(const CliOptions& options) {
+    std::filesystem::create_directories(options.out_dir);
+    std::atomic<std::uint64_t> next_shard{0};
+    auto thread_count = static_cast<unsigned int>(
+        std::min<std::uint64_t>(options.thread_count, options.shard_count));
+    detail::run_parallel(thread_count, [&](unsigned int) {
+        for (std::uint64_t i = next_shard++; i < options.shard_count; i = next_shard++) {
+            CliOptions shard = options;
+            shard.shard_index = i;
+            shard.out_dir.clear();
+            shard.out_file = shard_path(options, i);
+            shard.thread_count = 1;
+            generate_and_output(shard);
+        }
+    });
+}
+
+/// @brief generates and outputs data to stdout, --out-file or --out-dir
+void generate_and_output_all(const CliOptions& options) {
+    if (!options.out_dir.empty()) {
+        generate_and_output_shards(options);
+    } else {
+        generate_and_output(options);
+    }
+}
+
+/// @brief @see generate_and_output_all, recording @see Stats that are printed to stderr
+/// afterwards; std::cout goes through a @see StatsBuffer that times the writes
+void generate_and_output_with_stats(const CliOptions& options) {
+    Stats stats;
+    // the stats of a run that failed (or whose reader went away) are printed too
+    std::exception_ptr error;
+    {
+        StatsScope scope{stats};
+        StatsBuffer sink{*std::cout.rdbuf()};
+        std::streambuf* stdout_buffer = std::cout.rdbuf(&sink);
+        try {
+            generate_and_output_all(options);
+            if (!std::cout.flush()) {
+                throw std::runtime_error{"writing the output failed"};
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+        std::cout.rdbuf(stdout_buffer);
+    }
+    write_stats(stats.report(), std::cerr, options.stats == CliOptions::StatsFormat::json);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/// @brief parses command line parameters, generates and outputs data (stdout, --out-file or
+/// --out-dir) and prints a string with used command line options (stderr)
 int main(int argc, char* argv[]) {
     CliOptions options = parse_cli_options(argc, argv);
 
-    // std::cerr so that we can use shell redirects without problems
-    std::cerr << options << std::endl;
+    if (options.rows_per_second) {
+        // a reader that closes the pipe ends the stream with EPIPE instead of killing the process
+        std::signal(SIGPIPE, SIG_IGN);
+    }
 
-    switch (options.distribution) {
-        case CliOptions::RandomDistribution::uniform: {
-            std::uniform_int_distribution random{options.min, options.max};
-            output<int>(generate_data(options.sample_count, options.col_count,
-                                      std::move(random), options.seed),
-                        options);
-        } break;
-        case CliOptions::RandomDistribution::normal: {
-            std::normal_distribution random{options.mean, options.stddev};
-            output<double>(
-                generate_data(options.sample_count, options.col_count,
-                              std::move(random), options.seed),
-                options);
-        } break;
-        case CliOptions::RandomDistribution::bernoulli: {
-            std::bernoulli_distribution random{options.p};
-            output<bool>(generate_data(options.sample_count, options.col_count,
-                                       std::move(random), options.seed),
-                         options);
-        } break;
+    try {
+        if (options.resume) {
+            // the comment shows the row it continues from
+            resume_from_checkpoint(options);
+        }
+
+        // std::cerr so that we can use shell redirects without problems
+        std::cerr << options << std::endl;
+
+        std::optional<NumaScope> numa;
+        if (options.numa) {
+            numa.emplace(NumaTopology::detect());
+        }
+        if (options.stats == CliOptions::StatsFormat::none) {
+            generate_and_output_all(options);
+        } else {
+            generate_and_output_with_stats(options);
+        }
+    } catch (const std::system_error& e) {
+        if (options.rows_per_second && e.code() == std::errc::broken_pipe) {
+            // the regular end of a stream, e.g. gendata --rows-per-sec 1000 | head
+            return 0;
+        }
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
     }
 }
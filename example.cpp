@@ -5,6 +5,7 @@
 #include <random>
 
 #include "data_generator/data_generator.hpp"
+#include "data_generator/virtual_data.hpp"
 
 // example on how to implement your own random number distribution;
 // this implementation does not fulfill all requirements of a random number
@@ -64,4 +65,10 @@ int main() {
     auto even_count = std::count_if(data.front().begin(), data.back().end(),
                                     [](const int& i) { return i % 2 == 0; });
     std::cout << even_count << std::endl;
+
+    // a virtual table computes every row when it is accessed, so it can have
+    // billions of rows without using memory for them
+    datagen::VirtualData<datagen::NormalDistribution, datagen::Philox4x32> huge{
+        1'000'000'000, 4, datagen::NormalDistribution{0.0, 1.0}, 0};
+    std::cout << huge[123'456'789][2] << std::endl;
 }
\ No newline at end of file
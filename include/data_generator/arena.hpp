@@ -0,0 +1,164 @@
+#ifndef __DATAGEN_ARENA_HPP__
+#define __DATAGEN_ARENA_HPP__
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <system_error>
+#include <vector>
+
+namespace datagen {
+
+/// @brief how an @see ArenaResource backs its memory
+enum class HugePages {
+    /// normal pages
+    off,
+    /// 2 MiB aligned mappings with madvise(MADV_HUGEPAGE), so the kernel
+    /// uses transparent huge pages where it can (silently falls back)
+    transparent,
+    /// MAP_HUGETLB, needs huge pages reserved in /proc/sys/vm/nr_hugepages
+    reserved,
+};
+
+/// @brief memory resource for generating many tables one after the other
+/// (POSIX only)
+/// @details allocations are carved out of large anonymous mappings, and
+/// deallocation does nothing. @see reset makes all memory available again
+/// without giving it back to the kernel, so the next tables reuse pages that
+/// are already mapped and faulted in, e.g.
+/// ```
+/// ArenaResource arena;
+/// for (...) {
+///     arena.reset();
+///     auto data = generate_data(rows, cols, random, seed, threads, &arena);
+///     ...
+/// }
+/// ```
+/// If a round needed more than one mapping, reset replaces them by a single
+/// one that is big enough for all of them, so repeating the same allocations
+/// maps memory only in the first round. Not thread-safe, like
+/// std::pmr::monotonic_buffer_resource; everything allocated has to be
+/// destroyed before reset and before the resource.
+class ArenaResource : public std::pmr::memory_resource {
+   public:
+    /// @param chunk_bytes minimum size of a mapping
+    /// @param huge_pages whether to back the mappings with huge pages
+    explicit ArenaResource(std::size_t chunk_bytes = std::size_t{64} << 20,
+                           HugePages huge_pages = HugePages::off)
+        : chunk_bytes{chunk_bytes}, huge_pages{huge_pages} {}
+
+    ArenaResource(const ArenaResource&) = delete;
+    ArenaResource& operator=(const ArenaResource&) = delete;
+
+    ~ArenaResource() override {
+        for (const Chunk& chunk : chunks) {
+            ::munmap(chunk.begin, chunk.size);
+        }
+    }
+
+    /// @brief makes all memory available for new allocations
+    /// @throws std::system_error if the merged mapping can't be created
+    void reset() {
+        if (chunks.size() > 1) {
+            std::size_t total = 0;
+            for (const Chunk& chunk : chunks) {
+                total += chunk.size;
+                ::munmap(chunk.begin, chunk.size);
+            }
+            chunks.clear();
+            add_chunk(total);
+        }
+        if (!chunks.empty()) {
+            chunks.front().used = 0;
+        }
+    }
+
+    /// @brief bytes mapped by the resource
+    std::size_t mapped_bytes() const {
+        std::size_t total = 0;
+        for (const Chunk& chunk : chunks) {
+            total += chunk.size;
+        }
+        return total;
+    }
+
+   private:
+    static constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
+    struct Chunk {
+        std::byte* begin;
+        std::size_t size;
+        std::size_t used;
+    };
+
+    std::size_t chunk_bytes;
+    HugePages huge_pages;
+    /// allocations are taken from the last chunk
+    std::vector<Chunk> chunks;
+
+    /// @brief maps a chunk of at least bytes bytes
+    void add_chunk(std::size_t bytes) {
+        std::size_t granule = huge_pages == HugePages::off
+                                  ? static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))
+                                  : huge_page_size;
+        std::size_t size = (std::max(bytes, chunk_bytes) + granule - 1) / granule * granule;
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+        if (huge_pages == HugePages::reserved) {
+            flags |= MAP_HUGETLB;
+        }
+        // transparent huge pages need 2 MiB aligned addresses: map one huge
+        // page more and cut off the unaligned ends
+        std::size_t extra = huge_pages == HugePages::transparent ? huge_page_size : 0;
+        void* p = ::mmap(nullptr, size + extra, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::system_error{errno, std::generic_category(), "mmap"};
+        }
+        auto* begin = static_cast<std::byte*>(p);
+        if (extra > 0) {
+            auto address = reinterpret_cast<std::uintptr_t>(p);
+            std::size_t head = (huge_page_size - address % huge_page_size) % huge_page_size;
+            if (head > 0) {
+                ::munmap(begin, head);
+            }
+            if (extra - head > 0) {
+                ::munmap(begin + head + size, extra - head);
+            }
+            begin += head;
+            // only a hint, the kernel may not support it
+            ::madvise(begin, size, MADV_HUGEPAGE);
+        }
+        chunks.push_back({begin, size, 0});
+    }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        assert(alignment <= static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)));
+        bytes = std::max<std::size_t>(bytes, 1);
+        if (!chunks.empty()) {
+            Chunk& chunk = chunks.back();
+            std::size_t offset = (chunk.used + alignment - 1) / alignment * alignment;
+            if (offset <= chunk.size && bytes <= chunk.size - offset) {
+                chunk.used = offset + bytes;
+                return chunk.begin + offset;
+            }
+        }
+        add_chunk(bytes);
+        chunks.back().used = bytes;
+        return chunks.back().begin;
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+}  // namespace datagen
+
+#endif
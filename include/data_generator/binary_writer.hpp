@@ -0,0 +1,563 @@
+#ifndef __DATAGEN_BINARY_WRITER_HPP__
+#define __DATAGEN_BINARY_WRITER_HPP__
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "data_generator.hpp"
+#include "stats.hpp"
+
+namespace datagen {
+
+static_assert(std::endian::native == std::endian::little,
+              "the binary formats are written in the native byte order, "
+              "which has to be little-endian");
+
+namespace detail {
+
+/// @brief arithmetic types the binary writers can write
+template <typename T>
+concept BinaryWritable = std::is_arithmetic_v<T>;
+
+/// @brief type a column of T is stored as (bool as a whole byte)
+template <typename T>
+using ColumnType = std::conditional_t<std::is_same_v<T, bool>, std::uint8_t, T>;
+
+/// @brief the values of column col of the first rows rows, contiguously
+/// @details points into data if its layout stores the column contiguously
+/// (@see ColumnMajor, not for bool); otherwise the values are gathered into
+/// buffer along the column iterator of the layout
+template <typename T, DataLayout Layout>
+std::span<const ColumnType<T>> column_values(const Data<T, Layout>& data, std::uint64_t col,
+                                             std::uint64_t rows,
+                                             std::vector<ColumnType<T>>& buffer) {
+    auto column = data.column(col);
+    if constexpr (std::is_pointer_v<decltype(column.begin())>) {
+        return {column.begin(), static_cast<std::size_t>(rows)};
+    } else {
+        buffer.resize(rows);
+        std::transform(column.begin(), column.begin() + static_cast<std::ptrdiff_t>(rows),
+                       buffer.begin(), [](T value) { return static_cast<ColumnType<T>>(value); });
+        return buffer;
+    }
+}
+
+template <typename T>
+void write_le(std::ostream& ostream, T value) {
+    ostream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void write_zeros(std::ostream& ostream, std::size_t count) {
+    static constexpr char zeros[8] = {};
+    assert(count <= sizeof(zeros));
+    ostream.write(zeros, static_cast<std::streamsize>(count));
+}
+
+/// @brief n rounded up to a multiple of 8
+constexpr std::size_t align8(std::size_t n) { return (n + 7) & ~std::size_t{7}; }
+
+/// @brief minimal FlatBuffers builder, enough for the Arrow IPC metadata
+/// @details like the original implementation it builds the buffer back to
+/// front, so every object has to be finished before the objects that refer to
+/// it; positions (@see Offset) are counted from the end of the buffer
+class FlatBufferBuilder {
+   public:
+    using Offset = std::uint32_t;
+
+    Offset create_string(std::string_view s) {
+        align(s.size() + 1, 4);
+        prepend_byte(0);
+        for (auto it = s.rbegin(); it != s.rend(); ++it) {
+            prepend_byte(static_cast<std::uint8_t>(*it));
+        }
+        prepend_scalar(static_cast<std::uint32_t>(s.size()));
+        return position();
+    }
+
+    /// @brief vector of structs given as trivially copyable values
+    template <typename Struct>
+    Offset create_struct_vector(std::span<const Struct> structs) {
+        static_assert(std::is_trivially_copyable_v<Struct>);
+        align(structs.size() * sizeof(Struct), std::max<std::size_t>(alignof(Struct), 4));
+        for (auto it = structs.rbegin(); it != structs.rend(); ++it) {
+            prepend_bytes(&*it, sizeof(Struct));
+        }
+        prepend_scalar(static_cast<std::uint32_t>(structs.size()));
+        return position();
+    }
+
+    Offset create_offset_vector(std::span<const Offset> offsets) {
+        align(offsets.size() * sizeof(Offset), 4);
+        for (auto it = offsets.rbegin(); it != offsets.rend(); ++it) {
+            prepend_offset(*it);
+        }
+        prepend_scalar(static_cast<std::uint32_t>(offsets.size()));
+        return position();
+    }
+
+    void start_table() {
+        assert(fields.empty());
+        table_end = position();
+    }
+
+    template <typename Scalar>
+    void add_scalar(std::uint16_t id, Scalar value) {
+        prepend_scalar(value);
+        fields.emplace_back(id, position());
+    }
+
+    void add_offset(std::uint16_t id, Offset offset) {
+        prepend_offset(offset);
+        fields.emplace_back(id, position());
+    }
+
+    Offset end_table() {
+        prepend_scalar(std::int32_t{0});
+        Offset table = position();
+
+        std::uint16_t field_count = 0;
+        for (auto [id, field] : fields) {
+            field_count = std::max<std::uint16_t>(field_count, static_cast<std::uint16_t>(id + 1));
+        }
+        std::vector<std::uint16_t> vtable(2 + field_count, 0);
+        vtable[0] = static_cast<std::uint16_t>(2 * vtable.size());
+        vtable[1] = static_cast<std::uint16_t>(table - table_end);
+        for (auto [id, field] : fields) {
+            vtable[2 + id] = static_cast<std::uint16_t>(table - field);
+        }
+        fields.clear();
+        for (auto it = vtable.rbegin(); it != vtable.rend(); ++it) {
+            prepend_scalar(*it);
+        }
+
+        // the table refers to its vtable, which is placed right in front of it
+        auto vtable_offset = static_cast<std::int32_t>(position() - table);
+        for (std::size_t i = 0; i < sizeof(vtable_offset); ++i) {
+            reversed[table - 1 - i] =
+                static_cast<std::uint8_t>(static_cast<std::uint32_t>(vtable_offset) >> (8 * i));
+        }
+        return table;
+    }
+
+    /// @brief finishes the buffer with root as root table
+    std::vector<std::uint8_t> finish(Offset root) {
+        align(sizeof(Offset), max_alignment);
+        prepend_offset(root);
+        return {reversed.rbegin(), reversed.rend()};
+    }
+
+   private:
+    /// bytes of the buffer in reverse order
+    std::vector<std::uint8_t> reversed;
+    std::size_t max_alignment = 4;
+    Offset table_end = 0;
+    /// (id, position) of the fields of the current table
+    std::vector<std::pair<std::uint16_t, Offset>> fields;
+
+    Offset position() const { return static_cast<Offset>(reversed.size()); }
+
+    /// @brief pads so that an object of the given size that is prepended next
+    /// starts at the given alignment
+    void align(std::size_t size, std::size_t alignment) {
+        max_alignment = std::max(max_alignment, alignment);
+        while ((reversed.size() + size) % alignment != 0) {
+            prepend_byte(0);
+        }
+    }
+
+    void prepend_byte(std::uint8_t byte) { reversed.push_back(byte); }
+
+    void prepend_bytes(const void* bytes, std::size_t size) {
+        const auto* begin = static_cast<const std::uint8_t*>(bytes);
+        for (std::size_t i = size; i > 0; --i) {
+            prepend_byte(begin[i - 1]);
+        }
+    }
+
+    template <typename Scalar>
+    void prepend_scalar(Scalar value) {
+        align(sizeof(Scalar), sizeof(Scalar));
+        prepend_bytes(&value, sizeof(Scalar));
+    }
+
+    /// @brief offsets point forward, relative to their own position
+    void prepend_offset(Offset target) {
+        align(sizeof(Offset), sizeof(Offset));
+        prepend_scalar(static_cast<Offset>(position() + sizeof(Offset) - target));
+    }
+};
+
+}  // namespace detail
+
+/// @brief writes a table as raw little-endian columns
+/// @details layout (all integers little-endian):
+///   - header: magic "DGCOLUMN", uint32 format version (1), uint8 kind of the
+///     values (numpy dtype kind: 'i' signed, 'u' unsigned integer, 'f'
+///     floating point, 'b' bool), uint8 size of a value in bytes, 2 zero
+///     bytes, uint64 column count
+///   - one block per call of write_rows: uint64 row count, followed by every
+///     column as row count values (bools as one byte each), each column
+///     padded with zeros to a multiple of 8 bytes
+///
+/// Without streaming the file is a single block, i.e. plain column-major.
+/// @tparam T type of the generated data
+template <detail::BinaryWritable T>
+class RawColumnWriter {
+   public:
+    /// @brief writes the header
+    RawColumnWriter(std::ostream& ostream, std::uint64_t col_count)
+        : ostream{ostream}, col_count{col_count} {
+        ostream.write("DGCOLUMN", 8);
+        detail::write_le(ostream, std::uint32_t{1});
+        detail::write_le(ostream, kind());
+        detail::write_le(ostream, static_cast<std::uint8_t>(sizeof(Column)));
+        detail::write_zeros(ostream, 2);
+        detail::write_le(ostream, std::uint64_t{col_count});
+    }
+
+    /// @brief writes the first rows rows of data as one block
+    template <DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data, std::uint64_t rows) {
+        assert(rows <= data.row_count && data.col_count == col_count);
+        DATAGEN_STATS_PHASE(Phase::format);
+        detail::write_le(ostream, std::uint64_t{rows});
+        std::size_t bytes = std::size_t{rows} * sizeof(Column);
+        for (std::uint64_t col = 0; col < col_count; ++col) {
+            auto values = detail::column_values(data, col, rows, column);
+            ostream.write(reinterpret_cast<const char*>(values.data()),
+                          static_cast<std::streamsize>(bytes));
+            detail::write_zeros(ostream, detail::align8(bytes) - bytes);
+        }
+    }
+
+    /// @brief writes all rows of data as one block
+    template <DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data) {
+        write_rows(data, data.row_count);
+    }
+
+    void finish() { ostream.flush(); }
+
+   private:
+    using Column = detail::ColumnType<T>;
+
+    std::ostream& ostream;
+    std::uint64_t col_count;
+    std::vector<Column> column;
+
+    static constexpr std::uint8_t kind() {
+        if constexpr (std::is_same_v<T, bool>) {
+            return 'b';
+        } else if constexpr (std::is_floating_point_v<T>) {
+            return 'f';
+        } else if constexpr (std::is_signed_v<T>) {
+            return 'i';
+        } else {
+            return 'u';
+        }
+    }
+};
+
+/// @brief writes a table as Apache Arrow IPC file (also known as Feather v2)
+/// @details the columns are named c0, c1, ... and are not nullable; every call
+/// of write_rows becomes one record batch. The metadata is encoded by a small
+/// builtin FlatBuffers builder, so no Arrow library is needed. The file can
+/// be read by pyarrow, DuckDB, polars etc.
+/// @tparam T type of the generated data
+template <detail::BinaryWritable T>
+class ArrowWriter {
+   public:
+    /// @brief writes the magic and the schema
+    ArrowWriter(std::ostream& ostream, std::uint64_t col_count)
+        : ostream{ostream}, col_count{col_count} {
+        ostream.write("ARROW1\0\0", 8);
+        position = 8;
+        detail::FlatBufferBuilder builder;
+        auto schema = create_schema(builder);
+        write_message(builder, schema_header, schema, 0);
+    }
+
+    /// @brief writes the first rows rows of data as one record batch
+    template <DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data, std::uint64_t rows) {
+        assert(rows <= data.row_count && data.col_count == col_count);
+        DATAGEN_STATS_PHASE(Phase::format);
+        std::size_t column_bytes = value_bytes(rows);
+        std::size_t padded_bytes = detail::align8(column_bytes);
+
+        detail::FlatBufferBuilder builder;
+        std::vector<FieldNode> nodes(col_count, FieldNode{static_cast<std::int64_t>(rows), 0});
+        std::vector<Buffer> buffers;
+        for (std::uint64_t col = 0; col < col_count; ++col) {
+            std::int64_t offset = static_cast<std::int64_t>(col * padded_bytes);
+            buffers.push_back({offset, 0});  // no validity bitmap
+            buffers.push_back({offset, static_cast<std::int64_t>(column_bytes)});
+        }
+        auto nodes_vector = builder.create_struct_vector(std::span<const FieldNode>{nodes});
+        auto buffers_vector = builder.create_struct_vector(std::span<const Buffer>{buffers});
+        builder.start_table();
+        builder.add_scalar(0, static_cast<std::int64_t>(rows));  // length
+        builder.add_offset(1, nodes_vector);
+        builder.add_offset(2, buffers_vector);
+        auto record_batch = builder.end_table();
+
+        std::size_t body_bytes = col_count * padded_bytes;
+        blocks.push_back(write_message(builder, record_batch_header, record_batch, body_bytes));
+        for (std::uint64_t col = 0; col < col_count; ++col) {
+            write_column(data, col, rows);
+            detail::write_zeros(ostream, padded_bytes - column_bytes);
+        }
+        position += body_bytes;
+    }
+
+    /// @brief writes all rows of data as one record batch
+    template <DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data) {
+        write_rows(data, data.row_count);
+    }
+
+    /// @brief writes the end of stream marker and the footer; call after the
+    /// last row
+    void finish() {
+        detail::write_le(ostream, continuation);
+        detail::write_le(ostream, std::int32_t{0});
+
+        detail::FlatBufferBuilder builder;
+        auto schema = create_schema(builder);
+        auto dictionaries = builder.create_struct_vector(std::span<const Block>{});
+        auto record_batches = builder.create_struct_vector(std::span<const Block>{blocks});
+        builder.start_table();
+        builder.add_offset(1, schema);
+        builder.add_offset(2, dictionaries);
+        builder.add_offset(3, record_batches);
+        builder.add_scalar(0, metadata_version);
+        auto footer = builder.finish(builder.end_table());
+
+        ostream.write(reinterpret_cast<const char*>(footer.data()),
+                      static_cast<std::streamsize>(footer.size()));
+        detail::write_le(ostream, static_cast<std::int32_t>(footer.size()));
+        ostream.write("ARROW1", 6);
+        ostream.flush();
+    }
+
+   private:
+    struct FieldNode {
+        std::int64_t length;
+        std::int64_t null_count;
+    };
+
+    struct Buffer {
+        std::int64_t offset;
+        std::int64_t length;
+    };
+
+    /// @brief location of a message in the file (for the footer)
+    struct Block {
+        std::int64_t offset;
+        std::int32_t metadata_length;
+        std::int32_t padding = 0;
+        std::int64_t body_length;
+    };
+
+    static constexpr std::uint32_t continuation = 0xFFFFFFFF;
+    /// MetadataVersion::V5
+    static constexpr std::int16_t metadata_version = 4;
+    /// values of the MessageHeader union
+    static constexpr std::uint8_t schema_header = 1;
+    static constexpr std::uint8_t record_batch_header = 3;
+
+    std::ostream& ostream;
+    std::uint64_t col_count;
+    std::size_t position = 0;
+    std::vector<Block> blocks;
+    std::vector<detail::ColumnType<T>> column;
+    std::vector<std::uint8_t> bits;
+
+    static std::size_t value_bytes(std::size_t rows) {
+        if constexpr (std::is_same_v<T, bool>) {
+            return (rows + 7) / 8;
+        } else {
+            return rows * sizeof(T);
+        }
+    }
+
+    /// @brief the type of the columns, i.e. (value of the Type union, table)
+    static std::pair<std::uint8_t, detail::FlatBufferBuilder::Offset> create_type(
+        detail::FlatBufferBuilder& builder) {
+        builder.start_table();
+        if constexpr (std::is_same_v<T, bool>) {
+            return {6, builder.end_table()};  // Bool
+        } else if constexpr (std::is_floating_point_v<T>) {
+            static_assert(sizeof(T) == 4 || sizeof(T) == 8, "no arrow type for T");
+            builder.add_scalar(0, std::int16_t{sizeof(T) == 4 ? 1 : 2});  // precision
+            return {3, builder.end_table()};  // FloatingPoint
+        } else {
+            builder.add_scalar(0, static_cast<std::int32_t>(8 * sizeof(T)));  // bitWidth
+            builder.add_scalar(1, std::uint8_t{std::is_signed_v<T>});  // is_signed
+            return {2, builder.end_table()};  // Int
+        }
+    }
+
+    detail::FlatBufferBuilder::Offset create_schema(detail::FlatBufferBuilder& builder) const {
+        std::vector<detail::FlatBufferBuilder::Offset> fields;
+        for (std::uint64_t col = 0; col < col_count; ++col) {
+            auto name = builder.create_string(detail::column_name(col));
+            auto [type_type, type] = create_type(builder);
+            auto children = builder.create_offset_vector({});
+            builder.start_table();
+            builder.add_offset(0, name);
+            builder.add_offset(3, type);
+            builder.add_offset(5, children);
+            builder.add_scalar(1, std::uint8_t{0});  // nullable
+            builder.add_scalar(2, type_type);
+            fields.push_back(builder.end_table());
+        }
+        auto fields_vector = builder.create_offset_vector(fields);
+        builder.start_table();
+        builder.add_offset(1, fields_vector);
+        builder.add_scalar(0, std::int16_t{0});  // little-endian
+        return builder.end_table();
+    }
+
+    /// @brief writes an encapsulated message (without its body)
+    Block write_message(detail::FlatBufferBuilder& builder, std::uint8_t header_type,
+                        detail::FlatBufferBuilder::Offset header, std::size_t body_bytes) {
+        builder.start_table();
+        builder.add_scalar(3, static_cast<std::int64_t>(body_bytes));
+        builder.add_offset(2, header);
+        builder.add_scalar(0, metadata_version);
+        builder.add_scalar(1, header_type);
+        auto message = builder.finish(builder.end_table());
+
+        std::size_t metadata_bytes = detail::align8(message.size());
+        Block block{static_cast<std::int64_t>(position),
+                    static_cast<std::int32_t>(8 + metadata_bytes), 0,
+                    static_cast<std::int64_t>(body_bytes)};
+        detail::write_le(ostream, continuation);
+        detail::write_le(ostream, static_cast<std::int32_t>(metadata_bytes));
+        ostream.write(reinterpret_cast<const char*>(message.data()),
+                      static_cast<std::streamsize>(message.size()));
+        detail::write_zeros(ostream, metadata_bytes - message.size());
+        position += 8 + metadata_bytes;
+        return block;
+    }
+
+    template <DataLayout Layout>
+    void write_column(const Data<T, Layout>& data, std::uint64_t col, std::uint64_t rows) {
+        auto values = detail::column_values(data, col, rows, column);
+        if constexpr (std::is_same_v<T, bool>) {
+            // arrow stores booleans as bits, least significant bit first
+            bits.assign(value_bytes(rows), 0);
+            for (std::uint64_t row = 0; row < rows; ++row) {
+                bits[row / 8] |= static_cast<std::uint8_t>(values[row] << (row % 8));
+            }
+            ostream.write(reinterpret_cast<const char*>(bits.data()),
+                          static_cast<std::streamsize>(bits.size()));
+        } else {
+            ostream.write(reinterpret_cast<const char*>(values.data()),
+                          static_cast<std::streamsize>(value_bytes(rows)));
+        }
+    }
+};
+
+namespace detail {
+
+/// @brief types with a matching PostgreSQL type (boolean, smallint, integer,
+/// bigint, real, double precision)
+template <typename T>
+concept PostgresWritable =
+    std::is_same_v<T, bool> || std::is_same_v<T, float> ||
+    std::is_same_v<T, double> ||
+    (std::is_integral_v<T> && std::is_signed_v<T> &&
+     (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8));
+
+/// @brief appends value in big-endian byte order (network byte order)
+template <typename T>
+void append_big_endian(std::string& bytes, T value) {
+    using Bits = std::conditional_t<
+        sizeof(T) == 1, std::uint8_t,
+        std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                           std::conditional_t<sizeof(T) == 4, std::uint32_t,
+                                              std::uint64_t>>>;
+    auto bits = std::bit_cast<Bits>(value);
+    for (std::size_t i = sizeof(T); i > 0; --i) {
+        bytes.push_back(static_cast<char>(bits >> (8 * (i - 1))));
+    }
+}
+
+}  // namespace detail
+
+/// @brief writes a table in the binary format of PostgreSQL's COPY FROM
+/// @details load it with e.g. psql -c 'COPY "table" FROM STDIN (FORMAT
+/// binary)' < file; the columns of the table need the type that matches T
+/// (boolean, smallint, integer, bigint, real or double precision). Unlike
+/// the text formats, the server doesn't have to parse the values.
+/// @tparam T type of the generated data
+template <detail::PostgresWritable T>
+class PostgresBinaryWriter {
+   public:
+    /// @brief writes the header
+    PostgresBinaryWriter(std::ostream& ostream, std::uint64_t col_count)
+        : ostream{ostream}, col_count{col_count} {
+        assert(col_count <= 1600);  // PostgreSQL's maximum
+        ostream.write("PGCOPY\n\377\r\n\0", 11);
+        bytes.clear();
+        detail::append_big_endian(bytes, std::int32_t{0});  // flags
+        detail::append_big_endian(bytes, std::int32_t{0});  // header extension
+        write_bytes();
+    }
+
+    /// @brief writes the first rows rows of data
+    template <DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data, std::uint64_t rows) {
+        assert(rows <= data.row_count && data.col_count == col_count);
+        DATAGEN_STATS_PHASE(Phase::format);
+        bytes.clear();
+        bytes.reserve(std::size_t{rows} * (2 + col_count * (4 + sizeof(T))));
+        for (std::uint64_t row = 0; row < rows; ++row) {
+            detail::append_big_endian(bytes, static_cast<std::int16_t>(col_count));
+            for (std::uint64_t col = 0; col < col_count; ++col) {
+                detail::append_big_endian(bytes, static_cast<std::int32_t>(sizeof(T)));
+                detail::append_big_endian(bytes, data[row][col]);
+            }
+        }
+        write_bytes();
+    }
+
+    /// @brief writes all rows of data
+    template <DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data) {
+        write_rows(data, data.row_count);
+    }
+
+    /// @brief writes the trailer; call after the last row
+    void finish() {
+        bytes.clear();
+        detail::append_big_endian(bytes, std::int16_t{-1});
+        write_bytes();
+        ostream.flush();
+    }
+
+   private:
+    std::ostream& ostream;
+    std::uint64_t col_count;
+    std::string bytes;
+
+    void write_bytes() {
+        ostream.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+};
+
+}  // namespace datagen
+
+#endif
@@ -0,0 +1,273 @@
+#ifndef __DATAGEN_COMPRESSION_HPP__
+#define __DATAGEN_COMPRESSION_HPP__
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef DATAGEN_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef DATAGEN_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef DATAGEN_WITH_LZ4
+#include <lz4frame.h>
+#endif
+
+#include "data_generator.hpp"
+#include "stats.hpp"
+
+namespace datagen {
+
+/// @brief compression of the output
+/// @details the output is compressed in blocks, each into a complete gzip
+/// member, zstd frame or lz4 frame, so that the blocks can be compressed
+/// independently on several threads (like pigz). The concatenated blocks are
+/// a valid file for gzip -d, zstd -d and lz4 -d. Every library is optional:
+/// it is used if DATAGEN_WITH_ZLIB, DATAGEN_WITH_ZSTD or DATAGEN_WITH_LZ4 is
+/// defined (and the library linked), see @see compression_available
+enum class Compression {
+    none,
+    gzip,
+    zstd,
+    lz4,
+};
+
+/// @brief whether the library for compression is part of the build
+constexpr bool compression_available(Compression compression) {
+    switch (compression) {
+        case Compression::none:
+            return true;
+        case Compression::gzip:
+#ifdef DATAGEN_WITH_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case Compression::zstd:
+#ifdef DATAGEN_WITH_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        case Compression::lz4:
+#ifdef DATAGEN_WITH_LZ4
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+/// @brief size of the blocks @see CompressingBuffer compresses independently
+inline constexpr std::size_t compression_block_size = std::size_t{4} << 20;
+
+namespace detail {
+
+#ifdef DATAGEN_WITH_ZLIB
+/// @brief compresses block into a gzip member
+/// @details zlib counts the input and output of a call in 32 bit, so blocks
+/// of 4 GiB or more (e.g. the parts of a very wide table) are passed to
+/// deflate in slices of at most max_slice bytes
+inline void gzip_block(std::string_view block, std::string& out,
+                       std::size_t max_slice = std::numeric_limits<uInt>::max()) {
+    assert(max_slice > 0 && max_slice <= std::numeric_limits<uInt>::max());
+    z_stream stream{};
+    // 15 + 16: the largest window with a gzip header and trailer
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error{"deflateInit2 failed"};
+    }
+    out.resize(deflateBound(&stream, static_cast<uLong>(block.size())));
+    std::size_t consumed = 0;
+    int result = Z_OK;
+    while (result == Z_OK) {
+        if (stream.total_out == out.size()) {
+            out.resize(2 * out.size());
+        }
+        std::size_t in = std::min(block.size() - consumed, max_slice);
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data() + consumed));
+        stream.avail_in = static_cast<uInt>(in);
+        stream.next_out = reinterpret_cast<Bytef*>(out.data() + stream.total_out);
+        stream.avail_out = static_cast<uInt>(std::min(out.size() - stream.total_out, max_slice));
+        result = deflate(&stream, consumed + in == block.size() ? Z_FINISH : Z_NO_FLUSH);
+        consumed += in - stream.avail_in;
+    }
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        throw std::runtime_error{"deflate failed"};
+    }
+}
+#endif
+
+#ifdef DATAGEN_WITH_ZSTD
+/// @brief compresses block into a zstd frame
+inline void zstd_block(std::string_view block, std::string& out) {
+    out.resize(ZSTD_compressBound(block.size()));
+    std::size_t size = ZSTD_compress(out.data(), out.size(), block.data(), block.size(),
+                                     ZSTD_CLEVEL_DEFAULT);
+    if (ZSTD_isError(size)) {
+        throw std::runtime_error{ZSTD_getErrorName(size)};
+    }
+    out.resize(size);
+}
+#endif
+
+#ifdef DATAGEN_WITH_LZ4
+/// @brief compresses block into an lz4 frame
+inline void lz4_block(std::string_view block, std::string& out) {
+    out.resize(LZ4F_compressFrameBound(block.size(), nullptr));
+    std::size_t size =
+        LZ4F_compressFrame(out.data(), out.size(), block.data(), block.size(), nullptr);
+    if (LZ4F_isError(size)) {
+        throw std::runtime_error{LZ4F_getErrorName(size)};
+    }
+    out.resize(size);
+}
+#endif
+
+/// @brief compresses block independently of everything else into out
+/// (replacing its contents, but reusing its memory)
+/// @throws std::invalid_argument if the compression isn't available
+/// (@see compression_available), std::runtime_error if compressing fails
+inline void compress_block(Compression compression, std::string_view block,
+                           std::string& out) {
+    DATAGEN_STATS_PHASE(Phase::compress);
+    switch (compression) {
+        case Compression::none:
+            out.assign(block);
+            return;
+#ifdef DATAGEN_WITH_ZLIB
+        case Compression::gzip:
+            gzip_block(block, out);
+            return;
+#endif
+#ifdef DATAGEN_WITH_ZSTD
+        case Compression::zstd:
+            zstd_block(block, out);
+            return;
+#endif
+#ifdef DATAGEN_WITH_LZ4
+        case Compression::lz4:
+            lz4_block(block, out);
+            return;
+#endif
+        default:
+            break;
+    }
+    throw std::invalid_argument{"compression not available in this build"};
+}
+
+/// @brief compresses text in place, with spare as the buffer for the
+/// compressed data; afterwards spare holds the memory of the uncompressed
+/// text for reuse
+inline void compress_in_place(Compression compression, std::string& text,
+                              std::string& spare) {
+    if (compression != Compression::none) {
+        compress_block(compression, text, spare);
+        std::swap(text, spare);
+    }
+}
+
+}  // namespace detail
+
+/// @brief stream buffer that compresses everything written to it and writes
+/// it to another stream, for writers that write to a std::ostream (e.g. the
+/// binary writers)
+/// @details the data is collected in blocks of block_size bytes; once
+/// thread_count blocks are full they are compressed in parallel, each on its
+/// own thread, and written in order. Call @see finish after the last write;
+/// the destructor drops what hasn't been written yet.
+class CompressingBuffer : public std::streambuf {
+   public:
+    /// @throws std::invalid_argument if the compression isn't available
+    CompressingBuffer(std::ostream& ostream, Compression compression,
+                      unsigned int thread_count = 1,
+                      std::size_t block_size = compression_block_size)
+        : ostream{&ostream},
+          compression{compression},
+          block_size{block_size},
+          blocks(thread_count),
+          compressed(thread_count) {
+        assert(thread_count > 0);
+        assert(block_size > 0);
+        if (!compression_available(compression)) {
+            throw std::invalid_argument{"compression not available in this build"};
+        }
+    }
+
+    /// @brief compresses and writes the rest of the data
+    /// @throws std::runtime_error if writing failed
+    void finish() {
+        write_blocks();
+        if (!ostream->flush()) {
+            throw std::runtime_error{"writing the output failed"};
+        }
+    }
+
+   protected:
+    std::streamsize xsputn(const char* chars, std::streamsize count) override {
+        auto rest = static_cast<std::size_t>(count);
+        while (rest > 0) {
+            std::string& block = blocks[full];
+            std::size_t n = std::min(rest, block_size - block.size());
+            block.append(chars, n);
+            chars += n;
+            rest -= n;
+            if (block.size() == block_size && ++full == blocks.size()) {
+                write_blocks();
+            }
+        }
+        return count;
+    }
+
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            char ch = traits_type::to_char_type(c);
+            xsputn(&ch, 1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+   private:
+    std::ostream* ostream;
+    Compression compression;
+    std::size_t block_size;
+    /// uncompressed data; blocks before full are full
+    std::vector<std::string> blocks;
+    std::vector<std::string> compressed;
+    std::size_t full = 0;
+
+    /// @brief compresses the blocks that aren't empty in parallel and writes
+    /// them
+    void write_blocks() {
+        std::size_t count = full + (full < blocks.size() && !blocks[full].empty() ? 1 : 0);
+        detail::run_parallel(static_cast<unsigned int>(count), [&](unsigned int i) {
+            detail::compress_block(compression, blocks[i], compressed[i]);
+        });
+        for (std::size_t i = 0; i < count; ++i) {
+            ostream->write(compressed[i].data(),
+                           static_cast<std::streamsize>(compressed[i].size()));
+            blocks[i].clear();
+        }
+        full = 0;
+        if (!*ostream) {
+            throw std::runtime_error{"writing the output failed"};
+        }
+    }
+};
+
+}  // namespace datagen
+
+#endif
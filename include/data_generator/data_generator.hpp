@@ -2,75 +2,722 @@
 #ifndef __MODEL_HPP__
 #define __MODEL_HPP__
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <charconv>
+#include <cmath>
+#include <compare>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <optional>
 #include <ostream>
 #include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
 
+#include "numa.hpp"
+#include "simd.hpp"
+#include "stats.hpp"
+
 namespace datagen {
 
-/// @brief class to hold generated data
-/// @tparam T type of the data (int, double, bool, ...)
+/// @brief tag for constructing a @see Data whose cells are all overwritten
+/// before they are read, so they don't have to be zeroed first
+struct ForOverwrite {};
+inline constexpr ForOverwrite for_overwrite{};
+
+/// @brief storage policy of @see Data: how the cells of a table are stored
+/// @details cells are addressed by their index row * col_count + col. The
+/// primary template stores the values contiguously in one cache line aligned
+/// allocation from a std::pmr::memory_resource. They are value-initialized
+/// (zeroed), or only default-initialized if zero is false, so that the
+/// generators don't write every cell twice. Specializations may store the
+/// values more compactly (see DataStorage<bool>) as long as they provide the
+/// same members
+/// @tparam T type of the data
 template <typename T>
-class Data {
+class DataStorage {
+   public:
+    using const_iterator = const T*;
+
+    /// @throws std::length_error if size values don't fit into the memory
+    DataStorage(std::uint64_t size, std::pmr::memory_resource* memory, bool zero = true)
+        : memory{memory}, size{size} {
+        if (size > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::length_error{"Data: too many cells"};
+        }
+        values = static_cast<T*>(memory->allocate(bytes(), alignment));
+        if (zero) {
+            std::uninitialized_value_construct_n(values, size);
+        } else {
+            std::uninitialized_default_construct_n(values, size);
+        }
+    }
+
+    /// @brief copies into memory from the default resource
+    DataStorage(const DataStorage& other)
+        : DataStorage{other.size, std::pmr::get_default_resource(), false} {
+        std::copy_n(other.values, size, values);
+    }
+
+    DataStorage(DataStorage&& other) noexcept
+        : memory{other.memory},
+          size{std::exchange(other.size, 0)},
+          values{std::exchange(other.values, nullptr)} {}
+
+    DataStorage& operator=(const DataStorage&) = delete;
+    DataStorage& operator=(DataStorage&&) = delete;
+
+    ~DataStorage() {
+        if (values != nullptr) {
+            std::destroy_n(values, size);
+            memory->deallocate(values, bytes(), alignment);
+        }
+    }
+
+    const_iterator begin() const { return values; }
+
+    const_iterator end() const { return values + size; }
+
+    void set(std::uint64_t index, const T& value) { values[index] = value; }
+
+    /// @brief sets the cells index, index + 1, ...
+    void set(std::uint64_t index, std::span<const T> values) {
+        std::copy(values.begin(), values.end(), this->values + index);
+    }
+
    private:
-    struct ConstRowIterator;
-    struct RowView;
+    static constexpr std::size_t alignment = std::max<std::size_t>(alignof(T), 64);
 
+    std::pmr::memory_resource* memory;
+    std::uint64_t size;
+    T* values;
+
+    std::size_t bytes() const { return static_cast<std::size_t>(size) * sizeof(T); }
+};
+
+/// @brief storage policy for booleans: a bitmap of 64 bit words
+/// @details cell i is bit i % 64 of word i / 64. Unlike std::vector<bool>
+/// the words are filled 64 cells at a time (@see set, @see set_bits), so
+/// generation doesn't read and write a word for every cell. Iterators are
+/// random access and yield the values (no proxy references)
+template <>
+class DataStorage<bool> {
    public:
-    using Iterator = std::vector<T>::const_iterator;
+    class const_iterator {
+       public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = bool;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = bool;
 
-    const unsigned int row_count;
-    const unsigned int col_count;
+        const_iterator() = default;
+        const_iterator(const std::uint64_t* words, std::uint64_t index)
+            : words{words}, index{index} {}
 
-    Data(unsigned int row_count, unsigned int col_count)
-        : row_count{row_count}, col_count{col_count} {
-        assert(row_count > 0);
-        assert(col_count > 0);
-        data = std::vector<T>(row_count * col_count);
+        bool operator*() const { return ((words[index / 64] >> (index % 64)) & 1) != 0; }
+        bool operator[](difference_type n) const { return *(*this + n); }
+
+        const_iterator& operator++() {
+            ++index;
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator tmp = *this;
+            ++index;
+            return tmp;
+        }
+        const_iterator& operator--() {
+            --index;
+            return *this;
+        }
+        const_iterator operator--(int) {
+            const_iterator tmp = *this;
+            --index;
+            return tmp;
+        }
+        const_iterator& operator+=(difference_type n) {
+            index += static_cast<std::uint64_t>(n);
+            return *this;
+        }
+        const_iterator& operator-=(difference_type n) {
+            index -= static_cast<std::uint64_t>(n);
+            return *this;
+        }
+        friend const_iterator operator+(const_iterator it, difference_type n) {
+            return it += n;
+        }
+        friend const_iterator operator+(difference_type n, const_iterator it) {
+            return it += n;
+        }
+        friend const_iterator operator-(const_iterator it, difference_type n) {
+            return it -= n;
+        }
+        friend difference_type operator-(const const_iterator& a, const const_iterator& b) {
+            return static_cast<difference_type>(a.index - b.index);
+        }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        auto operator<=>(const const_iterator& other) const { return index <=> other.index; }
+
+       private:
+        const std::uint64_t* words = nullptr;
+        std::uint64_t index = 0;
+    };
+
+    /// @brief the bits are always zeroed (an eighth of a byte per cell),
+    /// since @see set reads the words it writes to; thus, unlike other
+    /// types, the words are first touched by the constructing thread, also
+    /// within a @see NumaScope
+    /// @throws std::length_error if size bits don't fit into the memory
+    DataStorage(std::uint64_t size, std::pmr::memory_resource* memory, bool = true)
+        : words(memory), size{size} {
+        if (size / 64 >= words.max_size()) {
+            throw std::length_error{"Data: too many cells"};
+        }
+        words.resize(static_cast<std::size_t>((size + 63) / 64));
+    }
+
+    const_iterator begin() const { return {words.data(), 0}; }
+
+    const_iterator end() const { return {words.data(), size}; }
+
+    void set(std::uint64_t index, bool value) {
+        write_bits(index, value ? 1 : 0, 1);
+    }
+
+    /// @brief sets the cells index, index + 1, ..., packing 64 values into
+    /// a word at a time
+    void set(std::uint64_t index, std::span<const bool> values) {
+        for (std::size_t begin = 0; begin < values.size(); begin += 64) {
+            std::size_t count = std::min<std::size_t>(64, values.size() - begin);
+            std::uint64_t bits = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                bits |= std::uint64_t{values[begin + i]} << i;
+            }
+            write_bits(index + begin, bits, static_cast<unsigned int>(count));
+        }
+    }
+
+    /// @brief sets the count cells starting at index to the bits of bits
+    /// (cell index + i to bit i % 64 of bits[i / 64])
+    void set_bits(std::uint64_t index, const std::uint64_t* bits, std::uint64_t count) {
+        for (std::uint64_t begin = 0; begin < count; begin += 64) {
+            write_bits(index + begin, bits[begin / 64],
+                       static_cast<unsigned int>(std::min<std::uint64_t>(64, count - begin)));
+        }
+    }
+
+   private:
+    std::pmr::vector<std::uint64_t> words;
+    std::uint64_t size;
+
+    /// @brief sets the length (1 to 64) cells starting at index to the lower
+    /// length bits of bits; they span at most two words
+    void write_bits(std::uint64_t index, std::uint64_t bits, unsigned int length) {
+        std::uint64_t mask = length == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << length) - 1;
+        bits &= mask;
+        auto word = static_cast<std::size_t>(index / 64);
+        auto shift = static_cast<unsigned int>(index % 64);
+        words[word] = (words[word] & ~(mask << shift)) | (bits << shift);
+        if (shift + length > 64) {
+            words[word + 1] = (words[word + 1] & ~(mask >> (64 - shift))) | (bits >> (64 - shift));
+        }
+    }
+};
+
+namespace detail {
+
+/// @brief a * b
+/// @throws std::length_error if the product doesn't fit into 64 bit
+inline std::uint64_t checked_cells(std::uint64_t a, std::uint64_t b) {
+    if (b != 0 && a > std::numeric_limits<std::uint64_t>::max() / b) {
+        throw std::length_error{"Data: too many cells"};
+    }
+    return a * b;
+}
+
+/// @brief n rounded up to a multiple of 64, i.e. to a word of DataStorage<bool>
+/// @throws std::length_error if that doesn't fit into 64 bit
+inline std::uint64_t round_up_64(std::uint64_t n) {
+    if (n > std::numeric_limits<std::uint64_t>::max() - 63) {
+        throw std::length_error{"Data: too many cells"};
+    }
+    return (n + 63) / 64 * 64;
+}
+
+/// @brief random access iterator over every stride-th value of Base
+template <std::random_access_iterator Base>
+class StridedIterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::iter_value_t<Base>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::iter_reference_t<Base>;
+
+    StridedIterator() = default;
+    StridedIterator(Base it, std::uint64_t stride)
+        : it{it}, stride{static_cast<difference_type>(stride)} {}
+
+    reference operator*() const { return *it; }
+    reference operator[](difference_type n) const { return it[n * stride]; }
+
+    StridedIterator& operator++() {
+        it += stride;
+        return *this;
+    }
+    StridedIterator operator++(int) {
+        StridedIterator tmp = *this;
+        it += stride;
+        return tmp;
+    }
+    StridedIterator& operator--() {
+        it -= stride;
+        return *this;
+    }
+    StridedIterator operator--(int) {
+        StridedIterator tmp = *this;
+        it -= stride;
+        return tmp;
+    }
+    StridedIterator& operator+=(difference_type n) {
+        it += n * stride;
+        return *this;
+    }
+    StridedIterator& operator-=(difference_type n) {
+        it -= n * stride;
+        return *this;
+    }
+    friend StridedIterator operator+(StridedIterator a, difference_type n) { return a += n; }
+    friend StridedIterator operator+(difference_type n, StridedIterator a) { return a += n; }
+    friend StridedIterator operator-(StridedIterator a, difference_type n) { return a -= n; }
+    friend difference_type operator-(const StridedIterator& a, const StridedIterator& b) {
+        return (a.it - b.it) / a.stride;
+    }
+    bool operator==(const StridedIterator& other) const { return it == other.it; }
+    auto operator<=>(const StridedIterator& other) const { return it <=> other.it; }
+
+   private:
+    Base it{};
+    difference_type stride = 1;
+};
+
+/// @brief random access iterator over a column of a @see Tiled layout: the
+/// values are consecutive within a tile and continue in the next tile
+template <std::random_access_iterator Base, std::uint64_t TileRows>
+class TiledColumnIterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::iter_value_t<Base>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = std::iter_reference_t<Base>;
+
+    TiledColumnIterator() = default;
+    /// @param cells first cell of the storage
+    /// @param last_tile_rows rows of the last tile (a multiple of 64)
+    TiledColumnIterator(Base cells, std::uint64_t col, std::uint64_t col_count,
+                        std::uint64_t tile_count, std::uint64_t last_tile_rows,
+                        std::uint64_t row)
+        : cells{cells},
+          col{col},
+          col_count{col_count},
+          tile_count{tile_count},
+          last_tile_rows{last_tile_rows},
+          row{row} {}
+
+    reference operator*() const {
+        std::uint64_t tile = row / TileRows;
+        std::uint64_t tile_rows = tile + 1 == tile_count ? last_tile_rows : TileRows;
+        return cells[static_cast<difference_type>(tile * TileRows * col_count +
+                                                  col * tile_rows + row % TileRows)];
+    }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    TiledColumnIterator& operator++() {
+        ++row;
+        return *this;
+    }
+    TiledColumnIterator operator++(int) {
+        TiledColumnIterator tmp = *this;
+        ++row;
+        return tmp;
+    }
+    TiledColumnIterator& operator--() {
+        --row;
+        return *this;
+    }
+    TiledColumnIterator operator--(int) {
+        TiledColumnIterator tmp = *this;
+        --row;
+        return tmp;
+    }
+    TiledColumnIterator& operator+=(difference_type n) {
+        row += static_cast<std::uint64_t>(n);
+        return *this;
+    }
+    TiledColumnIterator& operator-=(difference_type n) {
+        row -= static_cast<std::uint64_t>(n);
+        return *this;
+    }
+    friend TiledColumnIterator operator+(TiledColumnIterator a, difference_type n) {
+        return a += n;
+    }
+    friend TiledColumnIterator operator+(difference_type n, TiledColumnIterator a) {
+        return a += n;
+    }
+    friend TiledColumnIterator operator-(TiledColumnIterator a, difference_type n) {
+        return a -= n;
+    }
+    friend difference_type operator-(const TiledColumnIterator& a,
+                                     const TiledColumnIterator& b) {
+        return static_cast<difference_type>(a.row - b.row);
+    }
+    bool operator==(const TiledColumnIterator& other) const { return row == other.row; }
+    auto operator<=>(const TiledColumnIterator& other) const { return row <=> other.row; }
+
+   private:
+    Base cells{};
+    std::uint64_t col = 0;
+    std::uint64_t col_count = 0;
+    std::uint64_t tile_count = 0;
+    std::uint64_t last_tile_rows = 0;
+    std::uint64_t row = 0;
+};
+
+}  // namespace detail
+
+/// @brief layout of a @see Data: where cell (row, col) is stored
+/// @details a layout maps the cells to the indices of the @see DataStorage
+/// and provides the iterators along a row and a column, which are plain
+/// storage iterators where the values are consecutive. The layouts are
+/// @see RowMajor, @see ColumnMajor and @see Tiled.
+template <typename L>
+concept DataLayout = requires(const L layout, std::uint64_t n,
+                          typename DataStorage<int>::const_iterator cells) {
+    L{n, n};
+    { layout.cells() } -> std::same_as<std::uint64_t>;
+    { layout.index(n, n) } -> std::same_as<std::uint64_t>;
+    { layout.column_run(n) } -> std::same_as<std::uint64_t>;
+    { layout.row_begin(cells, n) } -> std::random_access_iterator;
+    { layout.column_begin(cells, n) } -> std::random_access_iterator;
+};
+
+/// @brief @see DataLayout that stores the rows one after the other (the default);
+/// rows are contiguous
+class RowMajor {
+   public:
+    template <typename Base>
+    using RowIterator = Base;
+    template <typename Base>
+    using ColumnIterator = detail::StridedIterator<Base>;
+
+    RowMajor(std::uint64_t row_count, std::uint64_t col_count)
+        : col_count{col_count}, _cells{detail::checked_cells(row_count, col_count)} {}
+
+    /// @brief number of cells the storage needs
+    std::uint64_t cells() const { return _cells; }
+
+    std::uint64_t index(std::uint64_t row, std::uint64_t col) const {
+        return row * col_count + col;
+    }
+
+    /// @brief number of rows from row on whose values of a column are
+    /// consecutive in the storage
+    std::uint64_t column_run(std::uint64_t) const { return 1; }
+
+    template <typename Base>
+    RowIterator<Base> row_begin(Base cells, std::uint64_t row) const {
+        return cells + static_cast<std::ptrdiff_t>(index(row, 0));
+    }
+
+    template <typename Base>
+    ColumnIterator<Base> column_begin(Base cells, std::uint64_t col) const {
+        return {cells + static_cast<std::ptrdiff_t>(col), col_count};
+    }
+
+   private:
+    std::uint64_t col_count;
+    std::uint64_t _cells;
+};
+
+/// @brief @see DataLayout that stores the columns one after the other; columns
+/// are contiguous
+/// @details every column starts at a multiple of 64 cells (so the columns of
+/// a Data<bool> don't share words), i.e. up to 63 cells per column are
+/// padding
+class ColumnMajor {
+   public:
+    template <typename Base>
+    using RowIterator = detail::StridedIterator<Base>;
+    template <typename Base>
+    using ColumnIterator = Base;
+
+    ColumnMajor(std::uint64_t row_count, std::uint64_t col_count)
+        : row_count{row_count},
+          stride{detail::round_up_64(row_count)},
+          _cells{detail::checked_cells(stride, col_count)} {}
+
+    /// @brief see @see RowMajor::cells
+    std::uint64_t cells() const { return _cells; }
+
+    std::uint64_t index(std::uint64_t row, std::uint64_t col) const {
+        return col * stride + row;
+    }
+
+    /// @brief see @see RowMajor::column_run
+    std::uint64_t column_run(std::uint64_t row) const { return row_count - row; }
+
+    template <typename Base>
+    RowIterator<Base> row_begin(Base cells, std::uint64_t row) const {
+        return {cells + static_cast<std::ptrdiff_t>(row), stride};
+    }
+
+    template <typename Base>
+    ColumnIterator<Base> column_begin(Base cells, std::uint64_t col) const {
+        return cells + static_cast<std::ptrdiff_t>(index(0, col));
+    }
+
+   private:
+    std::uint64_t row_count;
+    std::uint64_t stride;
+    std::uint64_t _cells;
+};
+
+/// @brief @see DataLayout that stores tiles of TileRows rows one after the other,
+/// each of them column-major (PAX)
+/// @details a tile holds a cache friendly piece of every column, so both
+/// rows and columns are read from few places at a time. The last tile only
+/// has the remaining rows rounded up to a multiple of 64.
+/// @tparam TileRows rows per tile, a multiple of 64
+template <std::uint64_t TileRows = 1024>
+class Tiled {
+   public:
+    static_assert(TileRows > 0 && TileRows % 64 == 0,
+                  "TileRows must be a multiple of 64");
+
+    template <typename Base>
+    using RowIterator = detail::StridedIterator<Base>;
+    template <typename Base>
+    using ColumnIterator = detail::TiledColumnIterator<Base, TileRows>;
+
+    Tiled(std::uint64_t row_count, std::uint64_t col_count)
+        : row_count{row_count},
+          col_count{col_count},
+          tile_count{(row_count + TileRows - 1) / TileRows},
+          last_tile_rows{detail::round_up_64(row_count - (tile_count - 1) * TileRows)},
+          _cells{detail::checked_cells(detail::checked_cells(tile_count - 1, TileRows) +
+                                           last_tile_rows,
+                                       col_count)} {}
+
+    /// @brief see @see RowMajor::cells
+    std::uint64_t cells() const { return _cells; }
+
+    std::uint64_t index(std::uint64_t row, std::uint64_t col) const {
+        return row / TileRows * TileRows * col_count + col * tile_rows(row) + row % TileRows;
+    }
+
+    /// @brief see @see RowMajor::column_run
+    std::uint64_t column_run(std::uint64_t row) const {
+        return std::min(row_count, (row / TileRows + 1) * TileRows) - row;
+    }
+
+    template <typename Base>
+    RowIterator<Base> row_begin(Base cells, std::uint64_t row) const {
+        return {cells + static_cast<std::ptrdiff_t>(index(row, 0)), tile_rows(row)};
     }
 
-    ConstRowIterator begin() const {
-        return ConstRowIterator{data.begin(), col_count};
+    template <typename Base>
+    ColumnIterator<Base> column_begin(Base cells, std::uint64_t col) const {
+        return {cells, col, col_count, tile_count, last_tile_rows, 0};
     }
 
-    ConstRowIterator end() const {
-        return ConstRowIterator{data.end(), col_count};
+   private:
+    std::uint64_t row_count;
+    std::uint64_t col_count;
+    std::uint64_t tile_count;
+    std::uint64_t last_tile_rows;
+    std::uint64_t _cells;
+
+    /// @brief rows of the tile of row
+    std::uint64_t tile_rows(std::uint64_t row) const {
+        return row / TileRows + 1 == tile_count ? last_tile_rows : TileRows;
     }
+};
+
+/// @brief class to hold generated data
+/// @details sizes are 64 bit, so a table may have more than 2^32 cells. The
+/// values are stored in the @see DataStorage for T (booleans as a bitmap) in
+/// the order of the layout, in memory from a std::pmr::memory_resource; with
+/// a @see MappedFileResource (data_generator/mapped_file.hpp) they live in a
+/// file instead, so a table can be bigger than the RAM, and an
+/// @see ArenaResource (data_generator/arena.hpp) reuses its memory for many
+/// tables. Copies always use the default resource.
+/// @tparam T type of the data (int, double, bool, ...)
+/// @tparam Layout @see RowMajor, @see ColumnMajor or @see Tiled; rows and
+/// columns can be read with any layout, but only their contiguous direction
+/// uses plain storage iterators
+template <typename T, DataLayout Layout = RowMajor>
+class Data {
+   private:
+    template <typename It>
+    struct View;
+    struct ConstRowIterator;
+
+   public:
+    using Iterator = DataStorage<T>::const_iterator;
+    /// a row, with the iterator of the layout along a row
+    using RowView = View<typename Layout::template RowIterator<Iterator>>;
+    /// a column, with the iterator of the layout along a column
+    using ColumnView = View<typename Layout::template ColumnIterator<Iterator>>;
+
+    const std::uint64_t row_count;
+    const std::uint64_t col_count;
+
+    /// @param memory where the values are stored
+    /// @throws std::length_error if row_count * col_count cells don't fit
+    /// into memory's address space
+    Data(std::uint64_t row_count, std::uint64_t col_count,
+         std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : row_count{row_count},
+          col_count{col_count},
+          _layout{checked_layout(row_count, col_count)},
+          data{_layout.cells(), memory} {}
+
+    /// @brief like the other constructor, but the cells are not zeroed; they
+    /// must all be set before they are read
+    Data(std::uint64_t row_count, std::uint64_t col_count, ForOverwrite,
+         std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : row_count{row_count},
+          col_count{col_count},
+          _layout{checked_layout(row_count, col_count)},
+          data{_layout.cells(), memory, false} {}
+
+    ConstRowIterator begin() const { return ConstRowIterator{this, 0}; }
 
-    unsigned int size() const { return row_count * col_count; }
+    ConstRowIterator end() const { return ConstRowIterator{this, row_count}; }
 
-    RowView operator[](unsigned int pos) const {
-        return RowView{data.begin() + col_count * pos, col_count};
+    std::uint64_t size() const { return row_count * col_count; }
+
+    const Layout& layout() const { return _layout; }
+
+    RowView operator[](std::uint64_t pos) const {
+        return RowView{_layout.row_begin(data.begin(), pos), col_count};
     }
 
-    RowView front() const { return RowView{data.begin(), col_count}; }
+    RowView front() const { return (*this)[0]; }
 
     RowView back() const { return (*this)[row_count - 1]; }
 
-    void set_value(unsigned int row, unsigned int col, T&& value) {
-        data[row * col_count + col] = value;
+    /// @brief column col; contiguous with @see ColumnMajor
+    ColumnView column(std::uint64_t col) const {
+        return ColumnView{_layout.column_begin(data.begin(), col), row_count};
+    }
+
+    void set_value(std::uint64_t row, std::uint64_t col, T&& value) {
+        data.set(_layout.index(row, col), value);
+    }
+
+    /// @brief sets consecutive cells in row-major order, starting at (row,
+    /// col); values may continue in the following rows
+    void set_values(std::uint64_t row, std::uint64_t col,
+                    std::span<const T> values) {
+        assert(row * col_count + col + values.size() <= size());
+        if constexpr (std::is_same_v<Layout, RowMajor>) {
+            data.set(_layout.index(row, col), values);
+        } else {
+            for (const T& value : values) {
+                data.set(_layout.index(row, col), value);
+                if (++col == col_count) {
+                    col = 0;
+                    ++row;
+                }
+            }
+        }
+    }
+
+    /// @brief sets consecutive cells of column col, starting at row
+    void set_column_values(std::uint64_t row, std::uint64_t col,
+                           std::span<const T> values) {
+        assert(row + values.size() <= row_count);
+        for (std::size_t i = 0; i < values.size();) {
+            auto run = static_cast<std::size_t>(
+                std::min<std::uint64_t>(values.size() - i, _layout.column_run(row + i)));
+            if (run == 1) {
+                data.set(_layout.index(row + i, col), values[i]);
+            } else {
+                data.set(_layout.index(row + i, col), values.subspan(i, run));
+            }
+            i += run;
+        }
+    }
+
+    /// @brief sets count consecutive cells in row-major order, starting at
+    /// (row, col), from the bits of bits (see DataStorage<bool>::set_bits)
+    void set_bits(std::uint64_t row, std::uint64_t col, const std::uint64_t* bits,
+                  std::uint64_t count)
+        requires std::is_same_v<T, bool>
+    {
+        assert(row * col_count + col + count <= size());
+        if constexpr (std::is_same_v<Layout, RowMajor>) {
+            data.set_bits(_layout.index(row, col), bits, count);
+        } else {
+            for (std::uint64_t i = 0; i < count; ++i) {
+                data.set(_layout.index(row, col), ((bits[i / 64] >> (i % 64)) & 1) != 0);
+                if (++col == col_count) {
+                    col = 0;
+                    ++row;
+                }
+            }
+        }
     }
 
    private:
-    std::vector<T> data;
+    Layout _layout;
+    DataStorage<T> data;
+
+    static Layout checked_layout(std::uint64_t row_count, std::uint64_t col_count) {
+        assert(row_count > 0);
+        assert(col_count > 0);
+        return Layout{row_count, col_count};
+    }
 
-    /// @brief provides an abstraction of a row in the data table
-    struct RowView {
-        friend ConstRowIterator;
+    /// @brief index as iterator difference
+    static std::ptrdiff_t offset(std::uint64_t index) {
+        return static_cast<std::ptrdiff_t>(index);
+    }
 
-        RowView(Iterator it, unsigned int size) : it{it}, _size{size} {}
-        unsigned int size() const { return _size; }
-        T operator[](unsigned int pos) const { return *(it + pos); }
-        Iterator begin() const { return it; }
-        Iterator end() const { return it + _size; }
+    /// @brief provides an abstraction of a row or a column in the data table
+    template <typename It>
+    struct View {
+        View() = default;
+        View(It it, std::uint64_t size) : it{it}, _size{size} {}
+        std::uint64_t size() const { return _size; }
+        T operator[](std::uint64_t pos) const { return *(it + offset(pos)); }
+        It begin() const { return it; }
+        It end() const { return it + offset(_size); }
         T front() const { return *it; }
-        T back() const { return *(it + _size - 1); }
+        T back() const { return *(it + offset(_size - 1)); }
 
        private:
-        Iterator it;
-        unsigned int _size;
+        It it{};
+        std::uint64_t _size = 0;
     };
 
     /// @brief iterator for iterating rows of the data table
@@ -81,13 +728,19 @@ class Data {
         using pointer = const value_type*;
         using reference = const value_type&;
 
-        ConstRowIterator(Iterator it, unsigned int size) : view{it, size} {}
+        ConstRowIterator(const Data* data, std::uint64_t row) : data{data} { seek(row); }
 
         reference operator*() const { return view; }
         pointer operator->() const { return &view; }
 
         ConstRowIterator& operator++() {
-            view = RowView{view.it + view.size(), view.size()};
+            if constexpr (std::is_same_v<Layout, RowMajor>) {
+                // the next row starts where this one ends
+                ++row;
+                view = RowView{view.end(), view.size()};
+            } else {
+                seek(row + 1);
+            }
             return *this;
         }
         ConstRowIterator operator++(int) {
@@ -97,7 +750,7 @@ class Data {
         }
 
         ConstRowIterator& operator--() {
-            view = RowView{view.it - view.size(), view.size()};
+            seek(row - 1);
             return *this;
         }
 
@@ -108,7 +761,7 @@ class Data {
         }
 
         bool operator==(const ConstRowIterator& other) const {
-            return view.size() == other.view.size() && view.it == other.view.it;
+            return data == other.data && row == other.row;
         }
 
         bool operator!=(const ConstRowIterator& other) const {
@@ -116,138 +769,2487 @@ class Data {
         }
 
        private:
+        const Data* data;
+        std::uint64_t row;
         RowView view;
-    };
-};
 
-/// @brief function to do the actual work of generating the data
-/// @tparam RandomNumberDistribution see
-/// https://en.cppreference.com/w/cpp/named_req/RandomNumberDistribution
-/// @param sample_count number of rows to be generated
-/// @param col_count number of columns to be generated
-/// @param random random number distribution such as
-/// uniform_int_distribution from stdlib
-/// @param seed seed value for random number generation (same seed leads
-/// to same random values)
-template <typename RandomNumberDistribution>
-Data<typename RandomNumberDistribution::result_type> generate_data(
-    unsigned int sample_count, unsigned int col_count,
-    RandomNumberDistribution&& random,
-    typename std::random_device::result_type seed = std::random_device{}()) {
-    assert(sample_count > 0);
-    assert(col_count > 0);
-    std::mt19937 random_algo{seed};
-    using T = typename RandomNumberDistribution::result_type;
-    Data<T> data{sample_count, col_count};
-    for (unsigned int row = 0; row < sample_count; ++row) {
-        for (unsigned int col = 0; col < col_count; ++col) {
-            data.set_value(row, col, random(random_algo));
+        void seek(std::uint64_t row) {
+            this->row = row;
+            // only row-major layouts have a view of the row past the end
+            if (std::is_same_v<Layout, RowMajor> || row < data->row_count) {
+                view = (*data)[row];
+            }
         }
-    }
-    return data;
-}
+    };
+};
 
-/// @brief function template for outputting a single value (used for output
-/// functions)
-template <typename T>
-using OutputFunction = std::function<void(const T&, std::ostream&)>;
+/// @brief counter-based random engine (Philox4x32-10 by Salmon et al.)
+/// @details every output is a pure function of the key (seed) and a 128 bit
+/// counter, so the engine can jump to any position in O(1). @see seek_cell
+/// positions it at a random stream that belongs to a single table cell; this
+/// way every cell of a table is a pure function of (seed, row, col).
+/// Fulfills the requirements of a uniform random bit generator, so it can be
+/// used with the stdlib distributions.
+class Philox4x32 {
+   public:
+    using result_type = std::uint32_t;
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
 
-namespace detail {
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() {
+        return std::numeric_limits<result_type>::max();
+    }
 
-/// @brief simply output the given value
-/// @details used as default argument for output functions
-template <typename T>
-void output_id(const T& t, std::ostream& ostream) {
-    ostream << t;
-}
+    explicit Philox4x32(std::uint64_t seed = 0) { this->seed(seed); }
 
-/// @brief output function for a single value for json
-/// @details the reason for this special function is that
-/// specifically for json we need a template specialization
-/// that prints "true" and "false" instead of 1 and 0;
-template <typename T>
-void output_id_json(const T& t, std::ostream& ostream) {
-    ostream << t;
-}
+    /// @brief uses seed as key and starts at counter 0
+    void seed(std::uint64_t seed) {
+        _key = {static_cast<std::uint32_t>(seed),
+                static_cast<std::uint32_t>(seed >> 32)};
+        counter = {};
+        index = 4;
+    }
 
-/// @brief template specialization for bool
-/// @details json has boolean type with values "true" and "false"
-template <>
-void output_id_json<bool>(const bool& t, std::ostream& ostream) {
-    ostream << (t ? "true" : "false");
-}
+    /// @brief jumps to the start of the random stream of the table cell
+    /// (row, col); a cell's stream is 2^32 blocks of 4 values long
+    void seek_cell(std::uint64_t row, unsigned int col) {
+        counter = {0, col, static_cast<std::uint32_t>(row),
+                   static_cast<std::uint32_t>(row >> 32)};
+        index = 4;
+    }
 
-}  // namespace detail
+    result_type operator()() {
+        if (index == 4) {
+            output = block(counter, _key);
+            increment();
+            index = 0;
+        }
+        return output[index++];
+    }
 
-/// @brief output data to std::ostream in csv format
-/// @tparam T type of the generated data
-template <typename T>
-void output_csv(const Data<T>& data, std::ostream& ostream,
-                const OutputFunction<T>& o = detail::output_id<T>) {
-    for (unsigned int row = 0; row < data.row_count - 1; ++row) {
-        o(data[row][0], ostream);
-        for (unsigned int col = 1; col < data.col_count; ++col) {
-            ostream << ",";
-            o(data[row][col], ostream);
+    void discard(unsigned long long z) {
+        for (; z > 0; --z) {
+            (*this)();
         }
-        ostream << "\n";
     }
-    o(data[data.row_count - 1][0], ostream);
-    for (unsigned int col = 1; col < data.col_count; ++col) {
-        ostream << ",";
-        o(data[data.row_count - 1][col], ostream);
+
+    /// @brief the Philox4x32-10 bijection, i.e. the 4 values of one counter
+    static Counter block(Counter counter, Key key) {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += detail::philox_weyl0;
+                key[1] += detail::philox_weyl1;
+            }
+            std::uint64_t product0 =
+                std::uint64_t{detail::philox_multiplier0} * counter[0];
+            std::uint64_t product1 =
+                std::uint64_t{detail::philox_multiplier1} * counter[2];
+            counter = {
+                static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                static_cast<std::uint32_t>(product1),
+                static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                static_cast<std::uint32_t>(product0)};
+        }
+        return counter;
     }
-}
 
-/// @brief output data to std::ostream in sql format
-/// @tparam T Type of the generated data
-/// @param tablename name of the table to insert the data into
-template <typename T>
-void output_sql(const Data<T>& data, std::ostream& ostream,
-                const std::string& tablename,
-                const OutputFunction<T>& o = detail::output_id<T>) {
-    ostream << "INSERT INTO \"" << tablename << "\" VALUES\n";
+    const Key& key() const { return _key; }
 
-    for (unsigned int row = 0; row < data.row_count - 1; ++row) {
-        ostream << "  (";
-        o(data[row][0], ostream);
-        for (unsigned int col = 1; col < data.col_count; ++col) {
-            ostream << ", ";
-            o(data[row][col], ostream);
+    bool operator==(const Philox4x32&) const = default;
+
+   private:
+    Key _key;
+    Counter counter;
+    Counter output{};
+    unsigned int index;
+
+    void increment() {
+        for (std::uint32_t& word : counter) {
+            if (++word != 0) {
+                break;
+            }
         }
-        ostream << "),\n";
     }
-    ostream << "  (";
-    o(data[data.row_count - 1][0], ostream);
-    for (unsigned int col = 1; col < data.col_count; ++col) {
-        ostream << ", ";
-        o(data[data.row_count - 1][col], ostream);
+};
+
+/// @brief random engines that can jump to the random stream of a single
+/// table cell such as @see Philox4x32; for them every cell is generated from
+/// its own stream instead of the stream of its block (@see block_rows)
+template <typename RandomEngine>
+concept CellSeekableEngine =
+    requires(RandomEngine random_algo, std::uint64_t row, unsigned int col) {
+        random_algo.seek_cell(row, col);
+    };
+
+namespace detail {
+
+/// @brief 64 uniformly distributed random bits; two values of a 32 bit engine
+/// are combined as first | second << 32
+template <std::uniform_random_bit_generator RandomEngine>
+std::uint64_t next_u64(RandomEngine& random_algo) {
+    using Limits = std::numeric_limits<std::uint64_t>;
+    if constexpr (RandomEngine::min() == 0 && RandomEngine::max() == Limits::max()) {
+        return random_algo();
+    } else if constexpr (RandomEngine::min() == 0 &&
+                         RandomEngine::max() == 0xFFFFFFFF) {
+        std::uint64_t first = random_algo();
+        std::uint64_t second = random_algo();
+        return first | second << 32;
+    } else {
+        return std::uniform_int_distribution<std::uint64_t>{}(random_algo);
+    }
+}
+
+/// @brief 32 uniformly distributed random bits
+template <std::uniform_random_bit_generator RandomEngine>
+std::uint32_t next_u32(RandomEngine& random_algo) {
+    if constexpr (RandomEngine::min() == 0 && RandomEngine::max() == 0xFFFFFFFF) {
+        return static_cast<std::uint32_t>(random_algo());
+    } else {
+        return static_cast<std::uint32_t>(next_u64(random_algo));
     }
-    ostream << ");";
 }
 
-/// @brief output data to std::ostream in json format (nested array)
-/// @tparam T Type of the generated data
-template <typename T>
-void output_json(const Data<T>& data, std::ostream& ostream,
-                 const OutputFunction<T>& o = detail::output_id_json<T>) {
-    ostream << "[\n";
-    for (unsigned int row = 0; row < data.row_count - 1; ++row) {
-        ostream << "  [";
-        o(data[row][0], ostream);
-        for (unsigned int col = 1; col < data.col_count; ++col) {
-            ostream << ", ";
-            o(data[row][col], ostream);
-        }
-        ostream << "],\n";
-    }
-    ostream << "  [";
-    o(data[data.row_count - 1][0], ostream);
-    for (unsigned int col = 1; col < data.col_count; ++col) {
-        ostream << ", ";
-        o(data[data.row_count - 1][col], ostream);
-    }
-    ostream << "]\n]";
+/// @brief upper 64 bits of the 128 bit product a * b
+inline std::uint64_t mul_high(std::uint64_t a, std::uint64_t b) {
+    const std::uint64_t mask = 0xFFFFFFFF;
+    std::uint64_t low_low = (a & mask) * (b & mask);
+    std::uint64_t high_low = (a >> 32) * (b & mask);
+    std::uint64_t low_high = (a & mask) * (b >> 32);
+    std::uint64_t high_high = (a >> 32) * (b >> 32);
+    std::uint64_t cross = (low_low >> 32) + (high_low & mask) + low_high;
+    return high_high + (high_low >> 32) + (cross >> 32);
+}
+
+/// @brief number of random words the batch distributions draw at once
+inline constexpr std::size_t batch_size = 256;
+
+}  // namespace detail
+
+/// @brief random number distributions that can fill whole spans at once
+/// @details fill(random_algo, values) yields the same values as calling
+/// random(random_algo) for every value; fill_from_cells(words0, words1,
+/// values) computes values[i] from the first (words0[i]) and second
+/// (words1[i]) 64 bits of the random stream of cell i, i.e. the same value as
+/// random(random_algo) directly after seeking a @see Philox4x32 to that cell
+/// and calling reset()
+template <typename Distribution>
+concept BatchDistribution = requires(Distribution random, std::mt19937 random_algo,
+                                     std::span<typename Distribution::result_type> values,
+                                     const std::uint64_t* words) {
+    random.fill(random_algo, values);
+    random.fill_from_cells(words, words, values);
+};
+
+/// @brief batch distributions of booleans that can also write the values as
+/// bits (value i to bit i % 64 of bits[i / 64]), like @see fill and
+/// @see fill_from_cells
+template <typename Distribution>
+concept BitBatchDistribution =
+    BatchDistribution<Distribution> &&
+    std::is_same_v<typename Distribution::result_type, bool> &&
+    requires(Distribution random, std::mt19937 random_algo, std::uint64_t* bits,
+             const std::uint64_t* words, std::size_t count) {
+        random.fill_bits(random_algo, bits, count);
+        random.fill_bits_from_cells(words, words, bits, count);
+    };
+
+/// @brief random number distributions whose values are generated a whole
+/// row at a time, e.g. because the columns of a row are correlated
+/// @details fill_row(random_algo, row) generates the values of a row from
+/// the random stream at its current position; with a @see CellSeekableEngine
+/// every row uses the stream of its first cell
+template <typename Distribution>
+concept RowDistribution = requires(Distribution random, std::mt19937 random_algo,
+                                   std::span<typename Distribution::result_type> row) {
+    random.fill_row(random_algo, row);
+};
+
+/// @brief distributions whose values are a function of the seed and the
+/// position of the cell rather than of a random stream, e.g. for unique keys
+/// @details fill_indexed(seed, first_index, values) computes the values of
+/// the cells first_index, first_index + 1, ... of a table in row-major order,
+/// so they are the same whatever the random engine
+template <typename Distribution>
+concept IndexDistribution =
+    requires(const Distribution random, typename std::random_device::result_type seed,
+             std::uint64_t index, std::span<typename Distribution::result_type> values) {
+        random.fill_indexed(seed, index, values);
+    };
+
+/// @brief integers uniformly distributed in [a, b] with batch kernels
+/// @details value = a + floor(w (b - a + 1) / 2^64) for 64 random bits w; the
+/// bias is at most (b - a + 1) / 2^64
+template <typename T = int>
+class UniformIntDistribution {
+    static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>);
+
+   public:
+    using result_type = T;
+
+    explicit UniformIntDistribution(
+        T a = 0, T b = std::numeric_limits<T>::max())
+        : _a{a},
+          _b{b},
+          range{static_cast<std::uint64_t>(b) - static_cast<std::uint64_t>(a) + 1} {
+        assert(a <= b);
+    }
+
+    T a() const { return _a; }
+    T b() const { return _b; }
+    T min() const { return _a; }
+    T max() const { return _b; }
+    void reset() {}
+
+    template <std::uniform_random_bit_generator RandomEngine>
+    T operator()(RandomEngine& random_algo) {
+        return from_word(detail::next_u64(random_algo));
+    }
+
+    template <std::uniform_random_bit_generator RandomEngine>
+    void fill(RandomEngine& random_algo, std::span<T> values) {
+        std::array<std::uint64_t, detail::batch_size> words;
+        for (std::size_t begin = 0; begin < values.size();
+             begin += detail::batch_size) {
+            auto batch = values.subspan(
+                begin, std::min(detail::batch_size, values.size() - begin));
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                words[i] = detail::next_u64(random_algo);
+            }
+            from_words(words.data(), batch);
+        }
+    }
+
+    void fill_from_cells(const std::uint64_t* words0, const std::uint64_t*,
+                         std::span<T> values) {
+        from_words(words0, values);
+    }
+
+   private:
+    T _a;
+    T _b;
+    /// b - a + 1; 0 stands for 2^64
+    std::uint64_t range;
+
+    T from_word(std::uint64_t word) const {
+        std::uint64_t offset = range == 0 ? word : detail::mul_high(word, range);
+        return static_cast<T>(static_cast<std::uint64_t>(_a) + offset);
+    }
+
+    void from_words(const std::uint64_t* words, std::span<T> values) const {
+        if constexpr (sizeof(T) == sizeof(std::uint32_t)) {
+            auto* out = reinterpret_cast<std::make_unsigned_t<T>*>(values.data());
+            auto offset = static_cast<std::uint32_t>(_a);
+            detail::simd::dispatch(values.size(), [&](auto kernels, std::size_t begin,
+                                                      std::size_t end) {
+                decltype(kernels)::uniform(words, offset, range, out, begin, end);
+            });
+        } else if constexpr (sizeof(T) < sizeof(std::uint32_t)) {
+            // the lower bits of the 32 bit kernel's values
+            std::array<std::uint32_t, detail::batch_size> wide;
+            auto offset = static_cast<std::uint32_t>(_a);
+            for (std::size_t first = 0; first < values.size(); first += detail::batch_size) {
+                std::size_t n = std::min(detail::batch_size, values.size() - first);
+                detail::simd::dispatch(n, [&](auto kernels, std::size_t begin,
+                                              std::size_t end) {
+                    decltype(kernels)::uniform(words + first, offset, range, wide.data(),
+                                               begin, end);
+                });
+                for (std::size_t i = 0; i < n; ++i) {
+                    values[first + i] = static_cast<T>(wide[i]);
+                }
+            }
+        } else {
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                values[i] = from_word(words[i]);
+            }
+        }
+    }
+};
+
+/// @brief a @see UniformIntDistribution of the smallest type that holds its
+/// range, see @see narrowest_uniform
+using NarrowUniformIntDistribution =
+    std::variant<UniformIntDistribution<std::int8_t>,
+                 UniformIntDistribution<std::int16_t>, UniformIntDistribution<int>>;
+
+/// @brief uniform distribution over [a, b] with the smallest of std::int8_t,
+/// std::int16_t and int that holds a and b as result type
+/// @details generates the same values as UniformIntDistribution<int>{a, b},
+/// but a table of them takes 4 (int8_t) or 2 (int16_t) times less memory and
+/// bandwidth; use with std::visit
+inline NarrowUniformIntDistribution narrowest_uniform(int a, int b) {
+    auto fits = [&]<typename T>(T) {
+        return a >= std::numeric_limits<T>::min() && b <= std::numeric_limits<T>::max();
+    };
+    if (fits(std::int8_t{})) {
+        return UniformIntDistribution<std::int8_t>{static_cast<std::int8_t>(a),
+                                                   static_cast<std::int8_t>(b)};
+    }
+    if (fits(std::int16_t{})) {
+        return UniformIntDistribution<std::int16_t>{static_cast<std::int16_t>(a),
+                                                    static_cast<std::int16_t>(b)};
+    }
+    return UniformIntDistribution<int>{a, b};
+}
+
+/// @brief normally distributed doubles with batch kernels
+/// @details uses the Box-Muller transform, so every two values are computed
+/// from 2 * 64 random bits; the transcendental functions are evaluated with
+/// the same polynomials on every instruction set
+class NormalDistribution {
+   public:
+    using result_type = double;
+
+    explicit NormalDistribution(double mean = 0.0, double stddev = 1.0)
+        : _mean{mean}, _stddev{stddev} {
+        assert(stddev > 0.0);
+    }
+
+    double mean() const { return _mean; }
+    double stddev() const { return _stddev; }
+    void reset() { has_next = false; }
+
+    template <std::uniform_random_bit_generator RandomEngine>
+    double operator()(RandomEngine& random_algo) {
+        if (has_next) {
+            has_next = false;
+            return next;
+        }
+        std::uint64_t word0 = detail::next_u64(random_algo);
+        std::uint64_t word1 = detail::next_u64(random_algo);
+        double value;
+        transform(&word0, &word1, 1, &value, &next);
+        has_next = true;
+        return value;
+    }
+
+    template <std::uniform_random_bit_generator RandomEngine>
+    void fill(RandomEngine& random_algo, std::span<double> values) {
+        std::size_t i = 0;
+        if (has_next && !values.empty()) {
+            values[i++] = (*this)(random_algo);
+        }
+        std::array<std::uint64_t, detail::batch_size> words0, words1;
+        std::array<double, detail::batch_size> values0, values1;
+        while (values.size() - i >= 2) {
+            std::size_t pairs = std::min(detail::batch_size, (values.size() - i) / 2);
+            for (std::size_t pair = 0; pair < pairs; ++pair) {
+                words0[pair] = detail::next_u64(random_algo);
+                words1[pair] = detail::next_u64(random_algo);
+            }
+            transform(words0.data(), words1.data(), pairs, values0.data(),
+                      values1.data());
+            for (std::size_t pair = 0; pair < pairs; ++pair) {
+                values[i++] = values0[pair];
+                values[i++] = values1[pair];
+            }
+        }
+        if (i < values.size()) {
+            values[i] = (*this)(random_algo);
+        }
+    }
+
+    void fill_from_cells(const std::uint64_t* words0,
+                         const std::uint64_t* words1, std::span<double> values) {
+        transform(words0, words1, values.size(), values.data(), nullptr);
+    }
+
+   private:
+    double _mean;
+    double _stddev;
+    /// second value of the last Box-Muller pair
+    double next = 0.0;
+    bool has_next = false;
+
+    void transform(const std::uint64_t* words0, const std::uint64_t* words1,
+                   std::size_t n, double* values0, double* values1) const {
+        detail::simd::dispatch(n, [&](auto kernels, std::size_t begin,
+                                      std::size_t end) {
+            decltype(kernels)::normal(words0, words1, _mean, _stddev, values0,
+                                      values1, begin, end);
+        });
+    }
+};
+
+/// @brief booleans that are true with probability p, with batch kernels
+/// @details value = w < p 2^32 for 32 random bits w
+class BernoulliDistribution {
+   public:
+    using result_type = bool;
+
+    explicit BernoulliDistribution(double p = 0.5)
+        : _p{p}, threshold{static_cast<std::uint64_t>(std::ldexp(p, 32))} {
+        assert(p >= 0.0 && p <= 1.0);
+    }
+
+    double p() const { return _p; }
+    void reset() {}
+
+    template <std::uniform_random_bit_generator RandomEngine>
+    bool operator()(RandomEngine& random_algo) {
+        return detail::next_u32(random_algo) < threshold;
+    }
+
+    template <std::uniform_random_bit_generator RandomEngine>
+    void fill(RandomEngine& random_algo, std::span<bool> values) {
+        std::array<std::uint64_t, detail::batch_size> words;
+        for (std::size_t begin = 0; begin < values.size();
+             begin += detail::batch_size) {
+            auto batch = values.subspan(
+                begin, std::min(detail::batch_size, values.size() - begin));
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                words[i] = detail::next_u32(random_algo);
+            }
+            fill_from_cells(words.data(), nullptr, batch);
+        }
+    }
+
+    void fill_from_cells(const std::uint64_t* words0, const std::uint64_t*,
+                         std::span<bool> values) {
+        detail::simd::dispatch(values.size(), [&](auto kernels, std::size_t begin,
+                                                  std::size_t end) {
+            decltype(kernels)::bernoulli(words0, threshold, values.data(), begin,
+                                         end);
+        });
+    }
+
+    /// @brief the values of @see fill as bits, value i as bit i % 64 of
+    /// bits[i / 64]
+    template <std::uniform_random_bit_generator RandomEngine>
+    void fill_bits(RandomEngine& random_algo, std::uint64_t* bits, std::size_t count) {
+        std::array<std::uint64_t, detail::batch_size> words;
+        for (std::size_t begin = 0; begin < count; begin += detail::batch_size) {
+            std::size_t n = std::min(detail::batch_size, count - begin);
+            for (std::size_t i = 0; i < n; ++i) {
+                words[i] = detail::next_u32(random_algo);
+            }
+            fill_bits_from_cells(words.data(), nullptr, bits + begin / 64, n);
+        }
+    }
+
+    /// @brief the values of @see fill_from_cells as bits (see @see fill_bits)
+    void fill_bits_from_cells(const std::uint64_t* words0, const std::uint64_t*,
+                              std::uint64_t* bits, std::size_t count) {
+        std::fill_n(bits, (count + 63) / 64, 0);
+        detail::simd::dispatch(count, [&](auto kernels, std::size_t begin,
+                                          std::size_t end) {
+            decltype(kernels)::bernoulli_bits(words0, threshold, bits, begin, end);
+        });
+    }
+
+   private:
+    double _p;
+    std::uint64_t threshold;
+};
+
+/// @brief largest number of elements of a @see ZipfDistribution that draws
+/// its values from an alias table
+inline constexpr std::int64_t zipf_table_size = 1 << 16;
+
+namespace detail {
+
+/// @brief SplitMix64, a tiny generator for the rare values that need more
+/// random words than a cell's stream provides
+inline std::uint64_t splitmix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return z ^ (z >> 31);
+}
+
+/// @brief a double in [0, 1) from the upper 53 bits of word
+inline double unit_double(std::uint64_t word) {
+    return static_cast<double>(word >> 11) * 0x1.0p-53;
+}
+
+}  // namespace detail
+
+/// @brief integers 1, ..., n where k has a probability proportional to
+/// 1 / k^s (Zipf's law)
+/// @details up to @see zipf_table_size elements, the constructor computes an
+/// alias table (Walker, Vose) once, which all copies share (e.g. those of
+/// the threads); every value is then a table lookup at mul_high(w, n) for 64
+/// random bits w. Larger n use rejection-inversion (Hörmann, Derflinger),
+/// which needs no table but a log and an exp per value: every value is
+/// computed from two random words, and in the rare case that both are
+/// rejected from a SplitMix64 sequence seeded with the second one, so that
+/// values consume a fixed number of words. The values are computed one at a
+/// time; only the random words of a @see CellSeekableEngine are generated in
+/// batches (@see fill_from_cells)
+class ZipfDistribution {
+   public:
+    using result_type = std::int64_t;
+
+    explicit ZipfDistribution(std::int64_t n = 1000, double s = 1.0)
+        : _n{n}, _s{s} {
+        assert(n > 0);
+        assert(s > 0.0);
+        if (n <= zipf_table_size) {
+            table = make_table(n, s);
+        } else {
+            h_integral_x1 = h_integral(1.5) - 1.0;
+            h_integral_n = h_integral(static_cast<double>(n) + 0.5);
+            squeeze = 2.0 - h_integral_inverse(h_integral(2.5) - h(2.0));
+        }
+    }
+
+    std::int64_t n() const { return _n; }
+    double s() const { return _s; }
+    std::int64_t min() const { return 1; }
+    std::int64_t max() const { return _n; }
+    void reset() {}
+
+    template <std::uniform_random_bit_generator RandomEngine>
+    std::int64_t operator()(RandomEngine& random_algo) {
+        std::uint64_t word0 = detail::next_u64(random_algo);
+        if (table) {
+            return from_table(word0);
+        }
+        return from_words(word0, detail::next_u64(random_algo));
+    }
+
+    template <std::uniform_random_bit_generator RandomEngine>
+    void fill(RandomEngine& random_algo, std::span<std::int64_t> values) {
+        for (std::int64_t& value : values) {
+            value = (*this)(random_algo);
+        }
+    }
+
+    void fill_from_cells(const std::uint64_t* words0, const std::uint64_t* words1,
+                         std::span<std::int64_t> values) {
+        if (table) {
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                values[i] = from_table(words0[i]);
+            }
+        } else {
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                values[i] = from_words(words0[i], words1[i]);
+            }
+        }
+    }
+
+   private:
+    /// @brief alias table: element i is kept if the fraction of the draw is
+    /// below threshold[i], otherwise alias[i] is taken
+    struct AliasTable {
+        std::vector<std::uint64_t> threshold;
+        std::vector<std::uint32_t> alias;
+    };
+
+    std::int64_t _n;
+    double _s;
+    std::shared_ptr<const AliasTable> table;
+    // constants of rejection-inversion
+    double h_integral_x1 = 0.0;
+    double h_integral_n = 0.0;
+    double squeeze = 0.0;
+
+    static std::shared_ptr<const AliasTable> make_table(std::int64_t n, double s) {
+        auto size = static_cast<std::size_t>(n);
+        std::vector<double> weights(size);
+        double sum = 0.0;
+        for (std::size_t k = 0; k < size; ++k) {
+            weights[k] = std::pow(static_cast<double>(k + 1), -s);
+            sum += weights[k];
+        }
+        // Vose: pair every element below the average with one above it
+        std::vector<std::uint32_t> small, large;
+        for (std::size_t k = 0; k < size; ++k) {
+            weights[k] *= static_cast<double>(size) / sum;
+            (weights[k] < 1.0 ? small : large).push_back(static_cast<std::uint32_t>(k));
+        }
+        auto table = std::make_shared<AliasTable>();
+        table->threshold.assign(size, std::numeric_limits<std::uint64_t>::max());
+        table->alias.resize(size);
+        for (std::size_t k = 0; k < size; ++k) {
+            table->alias[k] = static_cast<std::uint32_t>(k);
+        }
+        while (!small.empty() && !large.empty()) {
+            std::uint32_t less = small.back();
+            std::uint32_t more = large.back();
+            small.pop_back();
+            table->threshold[less] = static_cast<std::uint64_t>(std::ldexp(weights[less], 64));
+            table->alias[less] = more;
+            weights[more] -= 1.0 - weights[less];
+            if (weights[more] < 1.0) {
+                large.pop_back();
+                small.push_back(more);
+            }
+        }
+        // the rest is 1 up to rounding and keeps itself
+        return table;
+    }
+
+    std::int64_t from_table(std::uint64_t word) const {
+        auto size = static_cast<std::uint64_t>(_n);
+        std::uint64_t i = detail::mul_high(word, size);
+        // the lower 64 bits of word * n, uniform and independent of i
+        std::uint64_t fraction = word * size;
+        std::uint64_t k = fraction < table->threshold[i] ? i : table->alias[i];
+        return static_cast<std::int64_t>(k) + 1;
+    }
+
+    std::int64_t from_words(std::uint64_t word0, std::uint64_t word1) const {
+        std::int64_t k;
+        if (try_value(word0, k) || try_value(word1, k)) {
+            return k;
+        }
+        std::uint64_t state = word1;
+        while (!try_value(detail::splitmix64(state), k)) {
+        }
+        return k;
+    }
+
+    /// @brief one round of rejection-inversion with the uniform value from
+    /// word; true if k was accepted
+    bool try_value(std::uint64_t word, std::int64_t& k) const {
+        double u = h_integral_n + detail::unit_double(word) * (h_integral_x1 - h_integral_n);
+        double x = h_integral_inverse(u);
+        k = std::clamp(static_cast<std::int64_t>(x + 0.5), std::int64_t{1}, _n);
+        auto value = static_cast<double>(k);
+        return value - x <= squeeze || u >= h_integral(value + 0.5) - h(value);
+    }
+
+    /// @brief h(x) = 1 / x^s
+    double h(double x) const { return std::exp(-_s * std::log(x)); }
+
+    /// @brief integral of h, up to a constant
+    double h_integral(double x) const {
+        double log_x = std::log(x);
+        return expm1_over_x((1.0 - _s) * log_x) * log_x;
+    }
+
+    double h_integral_inverse(double x) const {
+        // rounding errors may go below -1
+        double t = std::max(x * (1.0 - _s), -1.0);
+        return std::exp(log1p_over_x(t) * x);
+    }
+
+    /// @brief log(1 + x) / x, also close to 0
+    static double log1p_over_x(double x) {
+        if (std::abs(x) > 1e-8) {
+            return std::log1p(x) / x;
+        }
+        return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+    }
+
+    /// @brief (exp(x) - 1) / x, also close to 0
+    static double expm1_over_x(double x) {
+        if (std::abs(x) > 1e-8) {
+            return std::expm1(x) / x;
+        }
+        return 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+    }
+};
+
+/// @brief keys of another table for foreign key columns: integers in
+/// [first_key, first_key + key_count), uniformly distributed or, with a
+/// skew s > 0, the first keys referenced most often (@see ZipfDistribution)
+/// @details the referenced keys are those of a key range like that of an id
+/// column of the other table; the cost per value is that of
+/// UniformIntDistribution<std::int64_t> or of the ZipfDistribution
+class ForeignKeyDistribution {
+   public:
+    using result_type = std::int64_t;
+
+    explicit ForeignKeyDistribution(std::int64_t first_key = 1, std::int64_t key_count = 1000,
+                                    double skew = 0.0)
+        : uniform{first_key, first_key + key_count - 1}, _skew{skew} {
+        assert(key_count > 0);
+        assert(skew >= 0.0);
+        if (skew > 0.0) {
+            zipf.emplace(key_count, skew);
+        }
+    }
+
+    std::int64_t first_key() const { return uniform.a(); }
+    std::int64_t key_count() const { return uniform.b() - uniform.a() + 1; }
+    double skew() const { return _skew; }
+    std::int64_t min() const { return uniform.a(); }
+    std::int64_t max() const { return uniform.b(); }
+    void reset() {}
+
+    template <std::uniform_random_bit_generator RandomEngine>
+    std::int64_t operator()(RandomEngine& random_algo) {
+        if (!zipf) {
+            return uniform(random_algo);
+        }
+        return first_key() - 1 + (*zipf)(random_algo);
+    }
+
+    template <std::uniform_random_bit_generator RandomEngine>
+    void fill(RandomEngine& random_algo, std::span<std::int64_t> values) {
+        if (!zipf) {
+            uniform.fill(random_algo, values);
+        } else {
+            zipf->fill(random_algo, values);
+            shift(values);
+        }
+    }
+
+    void fill_from_cells(const std::uint64_t* words0, const std::uint64_t* words1,
+                         std::span<std::int64_t> values) {
+        if (!zipf) {
+            uniform.fill_from_cells(words0, words1, values);
+        } else {
+            zipf->fill_from_cells(words0, words1, values);
+            shift(values);
+        }
+    }
+
+   private:
+    UniformIntDistribution<std::int64_t> uniform;
+    /// only with a skew, so that uniform keys don't compute an alias table
+    std::optional<ZipfDistribution> zipf;
+    double _skew;
+
+    /// @brief ranks 1, 2, ... to keys
+    void shift(std::span<std::int64_t> values) const {
+        for (std::int64_t& value : values) {
+            value += first_key() - 1;
+        }
+    }
+};
+
+/// @brief rows of normally distributed doubles whose columns are correlated
+/// (multivariate normal distribution)
+/// @details a row is mean + L z for a vector z of standard normal values
+/// (@see NormalDistribution) and the Cholesky factor L of the covariance
+/// matrix, which the constructor computes once and all copies share. The
+/// values are generated a whole row at a time (@see RowDistribution), so
+/// tables with this distribution need as many columns as it has dimensions;
+/// the generators throw std::invalid_argument otherwise.
+class MultivariateNormalDistribution {
+   public:
+    using result_type = double;
+
+    /// @param mean mean of every column
+    /// @param covariance symmetric positive definite matrix with mean.size()
+    /// rows and columns, row-major
+    /// @throws std::invalid_argument if covariance isn't such a matrix
+    MultivariateNormalDistribution(std::vector<double> mean, std::vector<double> covariance)
+        : factor{cholesky(std::move(mean), std::move(covariance))} {}
+
+    std::size_t dimension() const { return factor->mean.size(); }
+    const std::vector<double>& mean() const { return factor->mean; }
+    const std::vector<double>& covariance() const { return factor->covariance; }
+    void reset() { standard.reset(); }
+
+    /// @brief generates a row of dimension() values
+    template <std::uniform_random_bit_generator RandomEngine>
+    void fill_row(RandomEngine& random_algo, std::span<double> row) {
+        assert(row.size() == dimension());
+        // every row starts with a new Box-Muller pair
+        standard.reset();
+        standard.fill(random_algo, row);
+        // in place from the last value, which is the only one using all of z
+        const std::size_t n = row.size();
+        for (std::size_t i = n; i-- > 0;) {
+            const double* l = factor->lower.data() + i * n;
+            double value = factor->mean[i];
+            for (std::size_t j = 0; j <= i; ++j) {
+                value += l[j] * row[j];
+            }
+            row[i] = value;
+        }
+    }
+
+   private:
+    struct Factor {
+        std::vector<double> mean;
+        std::vector<double> covariance;
+        /// Cholesky factor, row-major; the upper triangle is 0
+        std::vector<double> lower;
+    };
+
+    std::shared_ptr<const Factor> factor;
+    NormalDistribution standard;
+
+    static std::shared_ptr<const Factor> cholesky(std::vector<double> mean,
+                                                  std::vector<double> covariance) {
+        const std::size_t n = mean.size();
+        if (n == 0 || covariance.size() != n * n) {
+            throw std::invalid_argument{"the covariance matrix needs as many rows and columns as there are means"};
+        }
+        std::vector<double> lower(n * n, 0.0);
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j <= i; ++j) {
+                double a = covariance[i * n + j];
+                if (std::abs(a - covariance[j * n + i]) > 1e-12 * std::max(std::abs(a), 1.0)) {
+                    throw std::invalid_argument{"the covariance matrix isn't symmetric"};
+                }
+                for (std::size_t k = 0; k < j; ++k) {
+                    a -= lower[i * n + k] * lower[j * n + k];
+                }
+                if (i == j) {
+                    if (!(a > 0.0)) {
+                        throw std::invalid_argument{"the covariance matrix isn't positive definite"};
+                    }
+                    lower[i * n + i] = std::sqrt(a);
+                } else {
+                    lower[i * n + j] = a / lower[j * n + j];
+                }
+            }
+        }
+        return std::make_shared<const Factor>(
+            Factor{std::move(mean), std::move(covariance), std::move(lower)});
+    }
+};
+
+namespace detail {
+
+/// @brief keyed bijection of [0, size) onto itself
+/// @details a Feistel network permutes the numbers of 2h bits for the
+/// smallest h with 2^2h >= size; values outside [0, size) are encrypted
+/// again until one falls inside (cycle walking, on average less than 4
+/// times). Every value is computed on its own in O(1) memory.
+class FeistelPermutation {
+   public:
+    /// @param size number of values; 0 stands for 2^64
+    FeistelPermutation(std::uint64_t size, std::uint64_t key) : size{size} {
+        while (half_bits < 32 && (size - 1) >> (2 * half_bits) != 0) {
+            ++half_bits;
+        }
+        mask = (std::uint64_t{1} << half_bits) - 1;
+        for (std::uint64_t& round_key : keys) {
+            round_key = splitmix64(key);
+        }
+    }
+
+    std::uint64_t operator()(std::uint64_t index) const {
+        assert(size == 0 || index < size);
+        do {
+            index = encrypt(index);
+        } while (size != 0 && index >= size);
+        return index;
+    }
+
+   private:
+    std::uint64_t size;
+    unsigned int half_bits = 1;
+    std::uint64_t mask;
+    std::array<std::uint64_t, 6> keys;
+
+    std::uint64_t encrypt(std::uint64_t value) const {
+        std::uint64_t left = value >> half_bits;
+        std::uint64_t right = value & mask;
+        for (std::uint64_t key : keys) {
+            std::uint64_t next = left ^ (mix(right ^ key) & mask);
+            left = right;
+            right = next;
+        }
+        return left << half_bits | right;
+    }
+
+    static std::uint64_t mix(std::uint64_t z) {
+        z = (z ^ (z >> 33)) * 0xFF51AFD7ED558CCD;
+        z = (z ^ (z >> 33)) * 0xC4CEB9FE1A85EC53;
+        return z ^ (z >> 33);
+    }
+};
+
+}  // namespace detail
+
+/// @brief unique random integers in [min, max]: cell i of a table (in
+/// row-major order) is min + p(i) for a permutation p of [0, max - min]
+/// keyed with the seed (@see IndexDistribution)
+/// @details e.g. a table of n rows with min = 1 and max = n is a random
+/// permutation of 1, ..., n. Since the values don't depend on each other
+/// they are generated in O(1) memory, by several threads and for any rows
+/// (@see generate_rows), like every other distribution. The table must not
+/// have more cells than [min, max] has values.
+class UniqueKeyDistribution {
+   public:
+    using result_type = std::int64_t;
+
+    explicit UniqueKeyDistribution(std::int64_t min = 1,
+                                   std::int64_t max = std::numeric_limits<std::int64_t>::max())
+        : _min{min}, _max{max} {
+        assert(min <= max);
+    }
+
+    std::int64_t min() const { return _min; }
+    std::int64_t max() const { return _max; }
+    void reset() {}
+
+    void fill_indexed(typename std::random_device::result_type seed, std::uint64_t first_index,
+                      std::span<std::int64_t> values) const {
+        // 0 for the full range of 2^64 values
+        std::uint64_t size = static_cast<std::uint64_t>(_max) - static_cast<std::uint64_t>(_min) + 1;
+        assert(size == 0 || first_index + values.size() <= size);
+        detail::FeistelPermutation permutation{size, seed};
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            values[i] = static_cast<std::int64_t>(static_cast<std::uint64_t>(_min) +
+                                                  permutation(first_index + i));
+        }
+    }
+
+   private:
+    std::int64_t _min;
+    std::int64_t _max;
+};
+
+/// @brief strictly increasing integers for sorted (e.g. clustered) key
+/// columns: cell i of a table (in row-major order) is first + i * step, or
+/// with random gaps first + i * step + g for a random g in [0, step)
+/// (@see IndexDistribution)
+/// @details the values wrap around if they leave the range of std::int64_t
+class SequenceDistribution {
+   public:
+    using result_type = std::int64_t;
+
+    explicit SequenceDistribution(std::int64_t first = 1, std::int64_t step = 1,
+                                  bool random_gaps = false)
+        : _first{first}, _step{step}, _random_gaps{random_gaps} {
+        assert(step > 0);
+    }
+
+    std::int64_t first() const { return _first; }
+    std::int64_t step() const { return _step; }
+    bool random_gaps() const { return _random_gaps; }
+    void reset() {}
+
+    void fill_indexed(typename std::random_device::result_type seed, std::uint64_t first_index,
+                      std::span<std::int64_t> values) const {
+        auto step = static_cast<std::uint64_t>(_step);
+        std::uint64_t value = static_cast<std::uint64_t>(_first) + first_index * step;
+        for (std::size_t i = 0; i < values.size(); ++i, value += step) {
+            std::uint64_t gap = 0;
+            if (_random_gaps) {
+                // a stream of its own for every cell
+                std::uint64_t state = seed ^ (first_index + i) * 0xD1B54A32D192ED03;
+                gap = detail::mul_high(detail::splitmix64(state), step);
+            }
+            values[i] = static_cast<std::int64_t>(value + gap);
+        }
+    }
+
+   private:
+    std::int64_t _first;
+    std::int64_t _step;
+    bool _random_gaps;
+};
+
+/// @brief number of cells that roughly make up one block of rows
+/// @see block_rows
+inline constexpr unsigned int cells_per_block = 1 << 16;
+
+/// @brief number of rows that share one random number stream
+/// @details the rows of a table are grouped into blocks of this many rows and
+/// the random engine of every block is seeded from (seed, block index); this
+/// way blocks can be generated independently and in any order (e.g. by
+/// several threads) and the result only depends on the seed. The row count is
+/// a multiple of 64 so that blocks of Data<bool> never share a storage word
+inline std::uint64_t block_rows(std::uint64_t col_count) {
+    assert(col_count > 0);
+    return std::max<std::uint64_t>(64, cells_per_block / col_count / 64 * 64);
+}
+
+namespace detail {
+
+/// @brief checks that a distribution whose rows have a fixed number of
+/// values (e.g. @see MultivariateNormalDistribution) fits a table
+/// @throws std::invalid_argument if the table has another number of columns
+template <typename RandomNumberDistribution>
+void check_row_width(const RandomNumberDistribution& random, std::uint64_t col_count) {
+    if constexpr (requires { random.dimension(); }) {
+        if (random.dimension() != col_count) {
+            throw std::invalid_argument{"the distribution needs as many columns as it has dimensions"};
+        }
+    }
+}
+
+/// @brief generates consecutive rows of a table from the random streams of
+/// its blocks (@see block_rows) or cells (@see CellSeekableEngine)
+/// @throws std::invalid_argument if the rows of the distribution don't have
+/// col_count values (@see check_row_width)
+template <typename RandomNumberDistribution, typename RandomEngine>
+class RowGenerator {
+   public:
+    using T = typename RandomNumberDistribution::result_type;
+
+    RowGenerator(RandomNumberDistribution random,
+                 typename std::random_device::result_type seed,
+                 std::uint64_t col_count, std::uint64_t first_row = 0)
+        : random{std::move(random)},
+          seed{seed},
+          col_count{col_count},
+          rows_per_block{block_rows(col_count)} {
+        check_row_width(this->random, col_count);
+        if constexpr (CellSeekableEngine<RandomEngine>) {
+            // the column is a 32 bit part of the engine's counter
+            assert(col_count <= std::uint64_t{1} << 32);
+            random_algo.seed(seed);
+        }
+        seek(first_row);
+    }
+
+    /// @brief continue generating at the given row
+    void seek(std::uint64_t row) {
+        next_row = row;
+        // values of an IndexDistribution don't come from the random streams
+        if constexpr (!CellSeekableEngine<RandomEngine> &&
+                      !IndexDistribution<RandomNumberDistribution>) {
+            start_block(row / rows_per_block);
+            if constexpr (RowDistribution<RandomNumberDistribution>) {
+                std::unique_ptr<T[]> values{new T[col_count]};
+                for (std::uint64_t i = 0; i < row % rows_per_block; ++i) {
+                    random.fill_row(random_algo, std::span<T>{values.get(), col_count});
+                }
+            } else {
+                for (std::uint64_t i = 0; i < row % rows_per_block * col_count; ++i) {
+                    random(random_algo);
+                }
+            }
+        }
+    }
+
+    /// @brief generates the next rows rows into data, starting at data_row
+    /// @details the values are generated in row-major order, which defines
+    /// them; other layouts are filled column by column (@see fill_transposed)
+    template <DataLayout Layout>
+    void fill(Data<T, Layout>& data, std::uint64_t data_row, std::uint64_t rows) {
+        DATAGEN_STATS_PHASE(Phase::generate);
+        DATAGEN_STATS_CELLS(rows * col_count);
+        fill_values(data, data_row, rows);
+    }
+
+   private:
+    /// whether the values are generated with the batch kernels of the
+    /// distribution; the only cell seekable engine they support is Philox4x32
+    static constexpr bool batched =
+        BatchDistribution<RandomNumberDistribution> &&
+        (!CellSeekableEngine<RandomEngine> ||
+         std::is_same_v<RandomEngine, Philox4x32>);
+
+    /// whether the batches are generated as bits straight into the bitmap
+    /// of DataStorage<bool>
+    static constexpr bool packed = BitBatchDistribution<RandomNumberDistribution>;
+
+    RandomNumberDistribution random;
+    RandomEngine random_algo;
+    typename std::random_device::result_type seed;
+    std::uint64_t col_count;
+    std::uint64_t rows_per_block;
+    std::uint64_t next_row = 0;
+
+    /// @brief @see fill without instrumentation
+    template <DataLayout Layout>
+    void fill_values(Data<T, Layout>& data, std::uint64_t data_row, std::uint64_t rows) {
+        assert(data.col_count == col_count);
+        assert(data_row + rows <= data.row_count);
+        if constexpr (!std::is_same_v<Layout, RowMajor>) {
+            fill_transposed(data, data_row, rows);
+        } else if constexpr (IndexDistribution<RandomNumberDistribution>) {
+            fill_from_indices(data, data_row, rows);
+        } else if constexpr (RowDistribution<RandomNumberDistribution>) {
+            fill_whole_rows(data, data_row, rows);
+        } else if constexpr (batched) {
+            fill_batches(data, data_row, rows);
+        } else {
+            for (std::uint64_t row = data_row; row < data_row + rows; ++row) {
+                if constexpr (CellSeekableEngine<RandomEngine>) {
+                    for (std::uint64_t col = 0; col < col_count; ++col) {
+                        random_algo.seek_cell(next_row, static_cast<unsigned int>(col));
+                        reset_distribution();
+                        data.set_value(row, col, random(random_algo));
+                    }
+                } else {
+                    if (next_row % rows_per_block == 0) {
+                        start_block(next_row / rows_per_block);
+                    }
+                    for (std::uint64_t col = 0; col < col_count; ++col) {
+                        data.set_value(row, col, random(random_algo));
+                    }
+                }
+                ++next_row;
+            }
+        }
+    }
+
+    /// @brief fill for the layouts that aren't row-major: generates up to a
+    /// block of rows at a time into a row-major buffer that stays in the
+    /// cache and copies it into data column by column, so data is written
+    /// sequentially within every column
+    template <DataLayout Layout>
+    void fill_transposed(Data<T, Layout>& data, std::uint64_t data_row, std::uint64_t rows) {
+        const std::uint64_t buffer_rows = std::min(rows, rows_per_block);
+        Data<T> buffer{buffer_rows, col_count, for_overwrite};
+        // not a std::vector, which would be a std::vector<bool> for bool
+        std::unique_ptr<T[]> column{new T[buffer_rows]};
+        for (std::uint64_t done = 0; done < rows;) {
+            std::uint64_t count = std::min(buffer_rows, rows - done);
+            fill_values(buffer, 0, count);
+            for (std::uint64_t col = 0; col < col_count; ++col) {
+                std::copy_n(buffer.column(col).begin(), count, column.get());
+                data.set_column_values(data_row + done, col,
+                                       std::span<const T>{column.get(), count});
+            }
+            done += count;
+        }
+    }
+
+    /// @brief fill for @see IndexDistribution: computes up to batch_size
+    /// cells at once and copies them into data row by row
+    void fill_from_indices(Data<T>& data, std::uint64_t data_row, std::uint64_t rows) {
+        std::array<T, detail::batch_size> values;
+        std::uint64_t index = next_row * col_count;
+        const std::uint64_t end = (next_row + rows) * col_count;
+        std::uint64_t col = 0;
+        while (index < end) {
+            auto count = static_cast<std::size_t>(
+                std::min<std::uint64_t>(end - index, detail::batch_size));
+            std::span<T> batch{values.data(), count};
+            random.fill_indexed(seed, index, batch);
+            // the batch continues in the following rows of data
+            data.set_values(data_row, col, batch);
+            col += count;
+            data_row += col / col_count;
+            col %= col_count;
+            index += count;
+        }
+        next_row += rows;
+    }
+
+    /// @brief fill for @see RowDistribution: generates one row after the
+    /// other into a buffer and copies it into data
+    void fill_whole_rows(Data<T>& data, std::uint64_t data_row, std::uint64_t rows) {
+        // not a std::vector, which would be a std::vector<bool> for bool
+        std::unique_ptr<T[]> values{new T[col_count]};
+        std::span<T> row{values.get(), col_count};
+        for (std::uint64_t i = 0; i < rows; ++i) {
+            if constexpr (CellSeekableEngine<RandomEngine>) {
+                random_algo.seek_cell(next_row, 0);
+                reset_distribution();
+            } else if (next_row % rows_per_block == 0) {
+                start_block(next_row / rows_per_block);
+            }
+            random.fill_row(random_algo, row);
+            data.set_values(data_row + i, 0, row);
+            ++next_row;
+        }
+    }
+
+    /// @brief fill for @see BatchDistribution: generates up to batch_size
+    /// cells at once (for Philox4x32 from the random streams of the cells)
+    /// and copies them into data row by row
+    void fill_batches(Data<T>& data, std::uint64_t data_row, std::uint64_t rows) {
+        std::array<T, detail::batch_size> values;
+        std::array<std::uint64_t, detail::batch_size / 64> bits;
+        std::array<std::uint64_t, detail::batch_size> words0, words1;
+        const std::uint64_t end_row = next_row + rows;
+        while (next_row < end_row) {
+            // a batch never spans two blocks
+            std::uint64_t segment_end = end_row;
+            if constexpr (!CellSeekableEngine<RandomEngine>) {
+                if (next_row % rows_per_block == 0) {
+                    start_block(next_row / rows_per_block);
+                }
+                segment_end = std::min(
+                    end_row, (next_row / rows_per_block + 1) * rows_per_block);
+            }
+            std::uint64_t cells = (segment_end - next_row) * col_count;
+            std::uint64_t row = next_row;
+            std::uint64_t col = 0;
+            while (cells > 0) {
+                auto count = static_cast<std::size_t>(
+                    std::min<std::uint64_t>(cells, detail::batch_size));
+                if constexpr (CellSeekableEngine<RandomEngine>) {
+                    cell_words(row, col, count, words0.data(), words1.data());
+                }
+                // the batch continues in the following rows of data
+                if constexpr (packed) {
+                    if constexpr (CellSeekableEngine<RandomEngine>) {
+                        random.fill_bits_from_cells(words0.data(), words1.data(),
+                                                    bits.data(), count);
+                    } else {
+                        random.fill_bits(random_algo, bits.data(), count);
+                    }
+                    data.set_bits(data_row + row - next_row, col, bits.data(), count);
+                } else {
+                    std::span<T> batch{values.data(), count};
+                    if constexpr (CellSeekableEngine<RandomEngine>) {
+                        random.fill_from_cells(words0.data(), words1.data(), batch);
+                    } else {
+                        random.fill(random_algo, batch);
+                    }
+                    data.set_values(data_row + row - next_row, col, batch);
+                }
+                col += count;
+                row += col / col_count;
+                col %= col_count;
+                cells -= count;
+            }
+            data_row += segment_end - next_row;
+            next_row = segment_end;
+        }
+    }
+
+    /// @brief computes the first 128 bits of the Philox4x32 streams of the
+    /// count cells starting at (row, col) in row-major order
+    void cell_words(std::uint64_t row, std::uint64_t col, std::size_t count,
+                    std::uint64_t* words0, std::uint64_t* words1) {
+        std::array<std::uint32_t, detail::batch_size> cols, rows_low, rows_high;
+        for (std::size_t i = 0; i < count; ++i) {
+            cols[i] = static_cast<std::uint32_t>(col);
+            rows_low[i] = static_cast<std::uint32_t>(row);
+            rows_high[i] = static_cast<std::uint32_t>(row >> 32);
+            if (++col == col_count) {
+                col = 0;
+                ++row;
+            }
+        }
+        const auto& key = random_algo.key();
+        detail::simd::dispatch(count, [&](auto kernels, std::size_t begin,
+                                          std::size_t end) {
+            decltype(kernels)::philox(key[0], key[1], cols.data(), rows_low.data(),
+                                      rows_high.data(), words0, words1, begin, end);
+        });
+    }
+
+    void start_block(std::uint64_t block) {
+        std::seed_seq seed_seq{static_cast<std::uint32_t>(seed),
+                               static_cast<std::uint32_t>(block),
+                               static_cast<std::uint32_t>(block >> 32)};
+        random_algo.seed(seed_seq);
+        reset_distribution();
+    }
+
+    /// @brief forget values the distribution cached from the previous stream
+    void reset_distribution() {
+        if constexpr (requires { random.reset(); }) {
+            random.reset();
+        }
+    }
+};
+
+/// @brief calls f(i) for every i in [0, n), each on its own thread (0 on the
+/// calling thread); rethrows the first exception after all threads finished
+/// @details within a @see NumaScope, thread i of n > 1 runs on the cpu
+/// topology.cpu(i, n) (the calling thread only until f(0) returns); a single
+/// thread keeps its cpus, e.g. one that is pinned by an outer run_parallel
+template <typename Function>
+void run_parallel(unsigned int n, Function f) {
+    const NumaTopology* topology =
+        n > 1 ? active_topology.load(std::memory_order_relaxed) : nullptr;
+    std::vector<std::exception_ptr> errors(n);
+    auto run = [&](unsigned int i) {
+        try {
+            if (topology) {
+                pin_thread(topology->cpu(i, n));
+            }
+            f(i);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+    {
+        std::optional<AffinityGuard> caller;
+        if (topology) {
+            caller.emplace();
+        }
+        std::vector<std::jthread> threads;
+        threads.reserve(n);
+        for (unsigned int i = 1; i < n; ++i) {
+            threads.emplace_back(run, i);
+        }
+        if (n > 0) {
+            run(0);
+        }
+    }
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/// @brief the first of count items that part part of part_count gets, when
+/// they are split into consecutive parts whose sizes differ by at most one
+/// (the larger ones first); part_count gives count
+inline std::uint64_t split_begin(std::uint64_t count, unsigned int part,
+                                 unsigned int part_count) {
+    assert(part <= part_count && part_count > 0);
+    std::uint64_t base = count / part_count;
+    std::uint64_t larger = count % part_count;
+    return part * base + std::min<std::uint64_t>(part, larger);
+}
+
+/// @brief number of blocks (@see block_rows) of rows_per_block rows that the
+/// table rows first_row, ..., first_row + rows - 1 touch
+inline std::uint64_t block_count(std::uint64_t first_row, std::uint64_t rows,
+                                 std::uint64_t rows_per_block) {
+    assert(rows > 0);
+    return (first_row + rows - 1) / rows_per_block - first_row / rows_per_block + 1;
+}
+
+/// @brief the table rows [first, last) that part part of part_count gets when
+/// the rows first_row, ..., first_row + rows - 1 are split into consecutive
+/// blocks of rows_per_block rows (@see split_begin); the first and the last
+/// block are cut to the rows
+/// @details this is how @see fill_rows splits the rows among its threads
+/// within a @see NumaScope, so a @see FileTableWriter formats the same parts
+inline std::pair<std::uint64_t, std::uint64_t> split_blocks(
+    std::uint64_t first_row, std::uint64_t rows, std::uint64_t rows_per_block,
+    unsigned int part, unsigned int part_count) {
+    const std::uint64_t first_block = first_row / rows_per_block;
+    const std::uint64_t blocks = block_count(first_row, rows, rows_per_block);
+    auto row = [&](unsigned int p) {
+        return std::clamp((first_block + split_begin(blocks, p, part_count)) * rows_per_block,
+                          first_row, first_row + rows);
+    };
+    return {row(part), row(part + 1)};
+}
+
+/// @brief generates the table rows first_row, ..., first_row + rows - 1 into
+/// the first rows rows of data, using up to thread_count threads
+/// @details the work is split along block boundaries, so the result doesn't
+/// depend on thread_count. For bool the blocks have to start at multiples of
+/// 64 rows of data, or threads would share words of the bitmap; otherwise a
+/// single thread generates the rows. The threads take one block after the
+/// other, or within a @see NumaScope consecutive blocks each.
+template <typename RandomEngine, typename T, DataLayout Layout,
+          typename RandomNumberDistribution>
+void fill_rows(Data<T, Layout>& data, std::uint64_t first_row, std::uint64_t rows,
+               const RandomNumberDistribution& random,
+               typename std::random_device::result_type seed,
+               unsigned int thread_count) {
+    assert(rows <= data.row_count);
+    // on this thread, before the generators on the other threads could throw
+    check_row_width(random, data.col_count);
+    const std::uint64_t rows_per_block = block_rows(data.col_count);
+    const std::uint64_t first_block = first_row / rows_per_block;
+    const std::uint64_t blocks = block_count(first_row, rows, rows_per_block);
+
+    // generates the part of the block first_block + i that lies in the range
+    auto fill_block = [&](std::uint64_t i) {
+        std::uint64_t begin =
+            std::max(first_row, (first_block + i) * rows_per_block);
+        std::uint64_t end = std::min(first_row + rows,
+                                    (first_block + i + 1) * rows_per_block);
+        RowGenerator<RandomNumberDistribution, RandomEngine> generator{
+            random, seed, data.col_count, begin};
+        generator.fill(data, begin - first_row, end - begin);
+    };
+
+    thread_count = static_cast<unsigned int>(
+        std::min<std::uint64_t>(thread_count, blocks));
+    if (std::is_same_v<T, bool> && first_row % 64 != 0) {
+        thread_count = 1;
+    }
+    if (thread_count <= 1) {
+        RowGenerator<RandomNumberDistribution, RandomEngine> generator{
+            random, seed, data.col_count, first_row};
+        generator.fill(data, 0, rows);
+        return;
+    }
+
+    if (active_topology.load(std::memory_order_relaxed)) {
+        // the pages of a thread's rows are touched first on its node
+        run_parallel(thread_count, [&](unsigned int t) {
+            auto [begin, end] = split_blocks(first_row, rows, rows_per_block, t, thread_count);
+            for (std::uint64_t row = begin; row < end;
+                 row = (row / rows_per_block + 1) * rows_per_block) {
+                fill_block(row / rows_per_block - first_block);
+            }
+        });
+        return;
+    }
+    std::atomic<std::uint64_t> next_block{0};
+    auto work = [&]() {
+        for (std::uint64_t i = next_block++; i < blocks; i = next_block++) {
+            fill_block(i);
+        }
+    };
+    std::vector<std::jthread> threads;
+    for (unsigned int t = 1; t < thread_count; ++t) {
+        threads.emplace_back(work);
+    }
+    work();
+}
+
+}  // namespace detail
+
+/// @brief the rows first_row, ..., first_row + row_count - 1 of a table
+struct RowRange {
+    std::uint64_t first_row;
+    std::uint64_t row_count;
+};
+
+/// @brief the rows of shard shard_index when a table of row_count rows is
+/// split into shard_count consecutive shards
+/// @details the shards differ by at most one row (the first ones are the
+/// larger ones), and only depend on the arguments, so every shard can be
+/// generated on its own (e.g. with @see generate_rows) and contains the same
+/// rows as the whole table
+inline RowRange shard_rows(std::uint64_t row_count, std::uint64_t shard_count,
+                           std::uint64_t shard_index) {
+    assert(shard_count > 0);
+    assert(shard_index < shard_count);
+    std::uint64_t base = row_count / shard_count;
+    std::uint64_t larger = row_count % shard_count;
+    return {shard_index * base + std::min(shard_index, larger),
+            base + (shard_index < larger ? 1 : 0)};
+}
+
+/// @brief function to do the actual work of generating the data
+/// @tparam RandomEngine uniform random bit generator such as std::mt19937 or
+/// @see Philox4x32
+/// @tparam Layout @see DataLayout of the result; doesn't change the
+/// generated values
+/// @tparam RandomNumberDistribution see
+/// https://en.cppreference.com/w/cpp/named_req/RandomNumberDistribution
+/// @param sample_count number of rows to be generated
+/// @param col_count number of columns to be generated
+/// @param random random number distribution such as
+/// uniform_int_distribution from stdlib
+/// @param seed seed value for random number generation (same seed leads
+/// to same random values)
+/// @param thread_count number of threads generating the data; doesn't change
+/// the generated values
+/// @param memory where the data is stored (see @see Data)
+template <typename RandomEngine = std::mt19937, DataLayout Layout = RowMajor,
+          typename RandomNumberDistribution>
+Data<typename RandomNumberDistribution::result_type, Layout> generate_data(
+    std::uint64_t sample_count, std::uint64_t col_count,
+    RandomNumberDistribution&& random,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    unsigned int thread_count = 1,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource()) {
+    assert(sample_count > 0);
+    assert(col_count > 0);
+    using T = typename RandomNumberDistribution::result_type;
+    Data<T, Layout> data{sample_count, col_count, for_overwrite, memory};
+    detail::fill_rows<RandomEngine>(data, 0, sample_count, random, seed,
+                                    thread_count);
+    return data;
+}
+
+/// @brief generates only the rows first_row, ..., first_row + row_count - 1
+/// of a table
+/// @details the result equals these rows of @see generate_data with the same
+/// seed; with a @see CellSeekableEngine the cost doesn't depend on
+/// first_row, otherwise at most one block (@see block_rows) is generated in
+/// vain
+template <typename RandomEngine = std::mt19937, DataLayout Layout = RowMajor,
+          typename RandomNumberDistribution>
+Data<typename RandomNumberDistribution::result_type, Layout> generate_rows(
+    std::uint64_t first_row, std::uint64_t row_count, std::uint64_t col_count,
+    RandomNumberDistribution&& random,
+    typename std::random_device::result_type seed,
+    unsigned int thread_count = 1) {
+    assert(row_count > 0);
+    assert(col_count > 0);
+    using T = typename RandomNumberDistribution::result_type;
+    Data<T, Layout> data{row_count, col_count, for_overwrite};
+    detail::fill_rows<RandomEngine>(data, first_row, row_count, random, seed,
+                                    thread_count);
+    return data;
+}
+
+/// @brief generates data chunk by chunk without ever holding the whole table
+/// @details the rows are generated into one reusable buffer of chunk_rows
+/// rows which is handed to consume after each chunk, so memory usage does
+/// not depend on sample_count; for the same seed the concatenated chunks are
+/// identical to the result of @see generate_data
+/// @tparam RandomEngine see @see generate_data
+/// @tparam Layout see @see generate_data
+/// @tparam ChunkConsumer callable as consume(const Data<T, Layout>& chunk,
+/// std::uint64_t rows) where only the first rows rows of chunk are valid
+/// @param consume called once per chunk, in row order
+/// @param chunk_rows maximum number of rows per chunk; 0 means one block
+/// (@see block_rows) per thread
+/// @param thread_count number of threads generating each chunk
+template <typename RandomEngine = std::mt19937, DataLayout Layout = RowMajor,
+          typename RandomNumberDistribution, typename ChunkConsumer>
+void generate_stream(
+    std::uint64_t sample_count, std::uint64_t col_count,
+    RandomNumberDistribution&& random, ChunkConsumer&& consume,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    std::uint64_t chunk_rows = 0, unsigned int thread_count = 1) {
+    generate_stream<RandomEngine, Layout>(
+        RowRange{0, sample_count}, col_count,
+        std::forward<RandomNumberDistribution>(random),
+        std::forward<ChunkConsumer>(consume), seed, chunk_rows, thread_count);
+}
+
+/// @brief generates only the given rows of a table chunk by chunk, see
+/// @see generate_stream
+/// @details the concatenated chunks equal these rows of @see generate_data
+/// with the same seed (see @see generate_rows)
+template <typename RandomEngine = std::mt19937, DataLayout Layout = RowMajor,
+          typename RandomNumberDistribution, typename ChunkConsumer>
+void generate_stream(
+    RowRange rows, std::uint64_t col_count, RandomNumberDistribution&& random,
+    ChunkConsumer&& consume,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    std::uint64_t chunk_rows = 0, unsigned int thread_count = 1) {
+    assert(rows.row_count > 0);
+    assert(col_count > 0);
+    assert(thread_count > 0);
+    using Distribution = std::remove_cvref_t<RandomNumberDistribution>;
+    using T = typename Distribution::result_type;
+    if (chunk_rows == 0) {
+        chunk_rows = thread_count * block_rows(col_count);
+    }
+    Data<T, Layout> chunk{std::min(rows.row_count, chunk_rows), col_count, for_overwrite};
+    // a single thread keeps its position in the random stream between chunks
+    detail::RowGenerator<Distribution, RandomEngine> generator{
+        random, seed, col_count, rows.first_row};
+    for (std::uint64_t done = 0; done < rows.row_count; done += chunk.row_count) {
+        std::uint64_t count = std::min(chunk.row_count, rows.row_count - done);
+        if (thread_count == 1) {
+            generator.fill(chunk, 0, count);
+        } else {
+            detail::fill_rows<RandomEngine>(chunk, rows.first_row + done, count,
+                                            random, seed, thread_count);
+        }
+        consume(std::as_const(chunk), count);
+    }
+}
+
+/// @brief distribution of a column of a @see ColumnTable; narrow integer
+/// ranges can use a smaller type (@see narrowest_uniform)
+using ColumnDistribution =
+    std::variant<UniformIntDistribution<int>, UniformIntDistribution<std::int8_t>,
+                 UniformIntDistribution<std::int16_t>, NormalDistribution,
+                 BernoulliDistribution, ZipfDistribution, ForeignKeyDistribution,
+                 UniqueKeyDistribution, SequenceDistribution>;
+
+/// @brief name and distribution of a column of a @see ColumnTable
+struct ColumnSchema {
+    std::string name;
+    ColumnDistribution distribution;
+};
+
+/// @brief the columns of a @see ColumnTable
+using Schema = std::vector<ColumnSchema>;
+
+namespace detail {
+
+/// @brief the shortest representation of value that reads back to the same
+/// value (std::to_chars)
+inline std::string exact_string(double value) {
+    std::array<char, 32> chars;
+    auto result = std::to_chars(chars.data(), chars.data() + chars.size(), value);
+    assert(result.ec == std::errc{});
+    return {chars.data(), result.ptr};
+}
+
+}  // namespace detail
+
+/// @brief prints the column specification name:distribution(parameters)
+/// that gendata --column reads back, the doubles in the shortest form that
+/// reads back to the same value
+inline std::ostream& operator<<(std::ostream& os, const ColumnSchema& column) {
+    os << column.name << ":";
+    std::visit([&](const auto& random) {
+        using Distribution = std::remove_cvref_t<decltype(random)>;
+        if constexpr (std::is_same_v<Distribution, NormalDistribution>) {
+            os << "normal(" << detail::exact_string(random.mean()) << ","
+               << detail::exact_string(random.stddev()) << ")";
+        } else if constexpr (std::is_same_v<Distribution, BernoulliDistribution>) {
+            os << "bernoulli(" << detail::exact_string(random.p()) << ")";
+        } else if constexpr (std::is_same_v<Distribution, ZipfDistribution>) {
+            os << "zipf(" << random.n() << "," << detail::exact_string(random.s()) << ")";
+        } else if constexpr (std::is_same_v<Distribution, ForeignKeyDistribution>) {
+            os << "fk(" << random.first_key() << "," << random.key_count() << ","
+               << detail::exact_string(random.skew()) << ")";
+        } else if constexpr (std::is_same_v<Distribution, UniqueKeyDistribution>) {
+            os << "unique(" << random.min() << "," << random.max() << ")";
+        } else if constexpr (std::is_same_v<Distribution, SequenceDistribution>) {
+            os << (random.random_gaps() ? "sorted(" : "sequence(") << random.first() << ","
+               << random.step() << ")";
+        } else {
+            // as int, int8_t would be printed as a character
+            os << "uniform(" << int{random.min()} << "," << int{random.max()} << ")";
+        }
+    }, column.distribution);
+    return os;
+}
+
+/// @brief table whose columns have their own type and distribution
+/// @details every column is stored in its own buffer (a @see Data with a
+/// single column), i.e. as structure of arrays
+class ColumnTable {
+   public:
+    /// @brief a column; the type follows from the column's distribution
+    using Column = std::variant<Data<int>, Data<std::int8_t>, Data<std::int16_t>,
+                                Data<std::int64_t>, Data<double>, Data<bool>>;
+
+    const std::uint64_t row_count;
+    const std::uint64_t col_count;
+
+    ColumnTable(std::uint64_t row_count, const Schema& schema)
+        : ColumnTable{row_count, schema, true} {}
+
+    /// @brief like the other constructor, but the cells are not zeroed (see
+    /// @see ForOverwrite)
+    ColumnTable(std::uint64_t row_count, const Schema& schema, ForOverwrite)
+        : ColumnTable{row_count, schema, false} {}
+
+    const Column& column(std::uint64_t col) const { return columns[col]; }
+
+    Column& column(std::uint64_t col) { return columns[col]; }
+
+    const std::string& name(std::uint64_t col) const { return names[col]; }
+
+   private:
+    std::vector<std::string> names;
+    std::vector<Column> columns;
+
+    ColumnTable(std::uint64_t row_count, const Schema& schema, bool zero)
+        : row_count{row_count}, col_count{schema.size()} {
+        assert(row_count > 0);
+        assert(col_count > 0);
+        columns.reserve(col_count);
+        for (const ColumnSchema& column : schema) {
+            names.push_back(column.name);
+            std::visit(
+                [&](const auto& random) {
+                    using T = std::remove_cvref_t<decltype(random)>::result_type;
+                    if (zero) {
+                        columns.emplace_back(std::in_place_type<Data<T>>, row_count, 1);
+                    } else {
+                        columns.emplace_back(std::in_place_type<Data<T>>, row_count, 1,
+                                             for_overwrite);
+                    }
+                },
+                column.distribution);
+        }
+    }
+};
+
+namespace detail {
+
+/// @brief name c0, c1, ... of column col of a table without column names
+inline std::string column_name(std::uint64_t col) {
+    // appended instead of "c" + ..., which trips GCC 12's -Wrestrict at -O2
+    std::string name{"c"};
+    name += std::to_string(col);
+    return name;
+}
+
+/// @brief seed of the random numbers of column col of a @see ColumnTable
+inline typename std::random_device::result_type column_seed(
+    typename std::random_device::result_type seed, std::uint64_t col) {
+    assert(col <= std::numeric_limits<std::uint32_t>::max());
+    std::seed_seq seed_seq{static_cast<std::uint32_t>(seed),
+                           static_cast<std::uint32_t>(col)};
+    std::array<std::uint32_t, 1> column_seed;
+    seed_seq.generate(column_seed.begin(), column_seed.end());
+    return column_seed[0];
+}
+
+/// @brief generates the table rows first_row, ..., first_row + rows - 1 into
+/// the first rows rows of table, column by column
+/// @details every column is generated like a table with a single column by
+/// @see fill_rows, i.e. by the loop specialized for its distribution
+template <typename RandomEngine>
+void fill_columns(ColumnTable& table, std::uint64_t first_row, std::uint64_t rows,
+                  const Schema& schema,
+                  typename std::random_device::result_type seed,
+                  unsigned int thread_count) {
+    assert(schema.size() == table.col_count);
+    for (std::uint64_t col = 0; col < table.col_count; ++col) {
+        std::visit(
+            [&](const auto& random) {
+                using T = std::remove_cvref_t<decltype(random)>::result_type;
+                fill_rows<RandomEngine>(std::get<Data<T>>(table.column(col)),
+                                        first_row, rows, random,
+                                        column_seed(seed, col), thread_count);
+            },
+            schema[col].distribution);
+    }
+}
+
+}  // namespace detail
+
+/// @brief generates a table whose columns have their own type and
+/// distribution
+/// @details the result doesn't depend on thread_count; see @see generate_data
+template <typename RandomEngine = std::mt19937>
+ColumnTable generate_table(
+    std::uint64_t sample_count, const Schema& schema,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    unsigned int thread_count = 1) {
+    return generate_table<RandomEngine>(RowRange{0, sample_count}, schema, seed,
+                                        thread_count);
+}
+
+/// @brief generates only the given rows of a table whose columns have their
+/// own type and distribution
+/// @details the result equals these rows of @see generate_table with the
+/// same seed, see @see generate_rows
+template <typename RandomEngine = std::mt19937>
+ColumnTable generate_table(
+    RowRange rows, const Schema& schema,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    unsigned int thread_count = 1) {
+    assert(rows.row_count > 0);
+    ColumnTable table{rows.row_count, schema, for_overwrite};
+    detail::fill_columns<RandomEngine>(table, rows.first_row, rows.row_count,
+                                       schema, seed, thread_count);
+    return table;
+}
+
+/// @brief generates a table whose columns have their own type and
+/// distribution chunk by chunk, see @see generate_stream
+/// @details for the same seed the concatenated chunks are identical to the
+/// result of @see generate_table
+/// @tparam ChunkConsumer callable as consume(const ColumnTable& chunk,
+/// std::uint64_t rows) where only the first rows rows of chunk are valid
+/// @param chunk_rows maximum number of rows per chunk; 0 means one block
+/// (@see block_rows) per thread
+template <typename RandomEngine = std::mt19937, typename ChunkConsumer>
+void generate_table_stream(
+    std::uint64_t sample_count, const Schema& schema, ChunkConsumer&& consume,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    std::uint64_t chunk_rows = 0, unsigned int thread_count = 1) {
+    generate_table_stream<RandomEngine>(RowRange{0, sample_count}, schema,
+                                        std::forward<ChunkConsumer>(consume), seed,
+                                        chunk_rows, thread_count);
+}
+
+/// @brief generates only the given rows of a table whose columns have their
+/// own type and distribution chunk by chunk, see @see generate_table_stream
+template <typename RandomEngine = std::mt19937, typename ChunkConsumer>
+void generate_table_stream(
+    RowRange rows, const Schema& schema, ChunkConsumer&& consume,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    std::uint64_t chunk_rows = 0, unsigned int thread_count = 1) {
+    assert(rows.row_count > 0);
+    assert(thread_count > 0);
+    if (chunk_rows == 0) {
+        chunk_rows = thread_count * block_rows(1);
+    }
+    ColumnTable chunk{std::min(rows.row_count, chunk_rows), schema, for_overwrite};
+    for (std::uint64_t done = 0; done < rows.row_count; done += chunk.row_count) {
+        std::uint64_t count = std::min(chunk.row_count, rows.row_count - done);
+        detail::fill_columns<RandomEngine>(chunk, rows.first_row + done, count,
+                                           schema, seed, thread_count);
+        consume(std::as_const(chunk), count);
+    }
+}
+
+/// @brief function template for outputting a single value (used for output
+/// functions)
+template <typename T>
+using OutputFunction = std::function<void(const T&, std::ostream&)>;
+
+namespace detail {
+
+/// @brief simply output the given value
+/// @details used for types that can't be formatted by @see OutputBuffer
+template <typename T>
+void output_id(const T& t, std::ostream& ostream) {
+    ostream << t;
+}
+
+/// @brief size of the buffer @see OutputBuffer fills before it writes to the
+/// stream
+inline constexpr std::size_t output_buffer_size = 1 << 20;
+
+/// @brief types that @see OutputBuffer formats itself (with std::to_chars)
+template <typename T>
+concept FastFormattable = std::is_arithmetic_v<T>;
+
+/// @brief collects output in a large contiguous buffer and writes it to a
+/// std::ostream in big blocks
+class OutputBuffer {
+   public:
+    explicit OutputBuffer(std::ostream& ostream,
+                          std::size_t capacity = output_buffer_size)
+        : ostream{&ostream}, chars{new char[capacity]}, capacity{capacity} {
+        assert(capacity >= max_value_chars);
+    }
+
+    OutputBuffer(OutputBuffer&& other) noexcept
+        : ostream{other.ostream},
+          chars{std::move(other.chars)},
+          capacity{other.capacity},
+          used{std::exchange(other.used, 0)} {}
+
+    OutputBuffer& operator=(OutputBuffer&&) = delete;
+
+    ~OutputBuffer() { flush(); }
+
+    void append(std::string_view s) {
+        if (s.size() > capacity - used) {
+            flush();
+            if (s.size() > capacity) {
+                ostream->write(s.data(), static_cast<std::streamsize>(s.size()));
+                return;
+            }
+        }
+        std::copy(s.begin(), s.end(), chars.get() + used);
+        used += s.size();
+    }
+
+    /// @brief appends s, which is followed by at least padded - s.size()
+    /// chars that may be read, by copying padded chars at once
+    void append_padded(std::string_view s, std::size_t padded) {
+        assert(s.size() <= padded && padded <= max_value_chars);
+        if (capacity - used < max_value_chars) {
+            flush();
+        }
+        std::copy_n(s.data(), padded, chars.get() + used);
+        used += s.size();
+    }
+
+    /// @brief appends the shortest representation of value that reads back
+    /// to the same value (booleans as 1/0 or true/false)
+    template <FastFormattable T>
+    void append_value(T value, bool bool_literals) {
+        if constexpr (std::is_same_v<T, bool>) {
+            append(bool_literals ? (value ? "true" : "false")
+                                 : (value ? "1" : "0"));
+        } else {
+            if (capacity - used < max_value_chars) {
+                flush();
+            }
+            char* begin = chars.get() + used;
+            auto result = std::to_chars(begin, begin + max_value_chars, value);
+            assert(result.ec == std::errc{});
+            used += static_cast<std::size_t>(result.ptr - begin);
+        }
+    }
+
+    /// @brief writes the buffered output to the stream
+    void flush() {
+        if (used > 0) {
+            ostream->write(chars.get(), static_cast<std::streamsize>(used));
+            used = 0;
+        }
+    }
+
+   private:
+    /// enough for every arithmetic type, including long double
+    static constexpr std::size_t max_value_chars = 64;
+
+    std::ostream* ostream;
+    std::unique_ptr<char[]> chars;
+    std::size_t capacity;
+    std::size_t used = 0;
+};
+
+}  // namespace detail
+
+/// @brief delimiters that make up a text output format
+/// @details a table is written as prefix, then every row as row_begin, the
+/// values separated by value_separator and row_end, with row_separator
+/// between two rows, and finally suffix. If batch_rows is not 0, the rows are
+/// grouped into batches of batch_rows rows which are separated by
+/// batch_separator instead of row_separator (e.g. to start a new statement)
+struct TextFormat {
+    std::string prefix;
+    std::string row_begin;
+    std::string value_separator;
+    std::string row_end;
+    std::string row_separator;
+    std::string suffix;
+    /// write booleans as true/false instead of 1/0
+    bool bool_literals = false;
+    unsigned int batch_rows = 0;
+    std::string batch_separator{};
+};
+
+namespace detail {
+
+/// @brief a string literal as a template argument
+template <std::size_t N>
+struct FixedString {
+    char chars[N]{};
+
+    constexpr FixedString(const char (&s)[N]) { std::copy_n(s, N, chars); }
+
+    constexpr std::string_view view() const { return {chars, N - 1}; }
+};
+
+/// @brief the delimiters within the rows of a @see TextFormat, fixed at
+/// compile time, so that the row loop appends them as constants
+template <FixedString RowBegin, FixedString ValueSeparator, FixedString RowEnd,
+          FixedString RowSeparator, bool BoolLiterals>
+struct StaticDelimiters {
+    static constexpr std::string_view row_begin = RowBegin.view();
+    static constexpr std::string_view value_separator = ValueSeparator.view();
+    static constexpr std::string_view row_end = RowEnd.view();
+    static constexpr std::string_view row_separator = RowSeparator.view();
+    static constexpr bool bool_literals = BoolLiterals;
+
+    static bool matches(const TextFormat& format) {
+        return format.row_begin == row_begin && format.value_separator == value_separator &&
+               format.row_end == row_end && format.row_separator == row_separator &&
+               format.bool_literals == bool_literals;
+    }
+};
+
+/// @brief the delimiters within the rows of any other @see TextFormat
+struct DynamicDelimiters {
+    std::string row_begin;
+    std::string value_separator;
+    std::string row_end;
+    std::string row_separator;
+    bool bool_literals = false;
+};
+
+using CsvDelimiters = StaticDelimiters<"", ",", "", "\n", false>;
+using SqlDelimiters = StaticDelimiters<"  (", ", ", ")", ",\n", false>;
+using JsonDelimiters = StaticDelimiters<"  [", ", ", "]", ",\n", true>;
+using CopyDelimiters = StaticDelimiters<"", "\t", "", "\n", true>;
+
+/// @brief the delimiters of the formats of this library (@see csv_format,
+/// @see sql_format, @see json_format, @see postgres_copy_format), or of any
+/// other format at runtime
+using RowDelimiters = std::variant<CsvDelimiters, SqlDelimiters, JsonDelimiters,
+                                   CopyDelimiters, DynamicDelimiters>;
+
+/// @brief the static delimiters that format has, or else its delimiters at
+/// runtime
+inline RowDelimiters row_delimiters(const TextFormat& format) {
+    if (CsvDelimiters::matches(format)) {
+        return CsvDelimiters{};
+    }
+    if (SqlDelimiters::matches(format)) {
+        return SqlDelimiters{};
+    }
+    if (JsonDelimiters::matches(format)) {
+        return JsonDelimiters{};
+    }
+    if (CopyDelimiters::matches(format)) {
+        return CopyDelimiters{};
+    }
+    return DynamicDelimiters{format.row_begin, format.value_separator, format.row_end,
+                             format.row_separator, format.bool_literals};
+}
+
+/// @brief what a @see ValueFormatter appends a value to
+template <typename Delimiters>
+class ValueSink {
+   public:
+    ValueSink(OutputBuffer& buffer, const Delimiters& delimiters)
+        : buffer{&buffer}, delimiters{&delimiters} {}
+
+    void append(std::string_view s) { buffer->append(s); }
+
+    /// @brief see @see OutputBuffer::append_padded
+    void append_padded(std::string_view s, std::size_t padded) {
+        buffer->append_padded(s, padded);
+    }
+
+    /// @brief appends value with std::to_chars, booleans as the format
+    /// writes them
+    template <FastFormattable T>
+    void append_value(T value) {
+        buffer->append_value(value, delimiters->bool_literals);
+    }
+
+   private:
+    OutputBuffer* buffer;
+    const Delimiters* delimiters;
+};
+
+/// @brief the part of the text writers that handles the delimiters of a
+/// @see TextFormat and the buffering
+/// @details the rows of all writers are written by the same loop
+/// (@see write_rows), which is instantiated for every @see RowDelimiters
+/// alternative and every value formatter, so that both are inlined
+class TextWriter {
+   public:
+    /// @brief writes the prefix of the format
+    TextWriter(std::ostream& ostream, TextFormat format)
+        : buffer{ostream},
+          format{std::move(format)},
+          delimiters{row_delimiters(this->format)} {
+        buffer.append(this->format.prefix);
+    }
+
+    /// @brief writes count rows of col_count values, the value in column col
+    /// of row row (counted from 0 in this call) with write_value(row, col,
+    /// sink), where sink is a @see ValueSink
+    template <typename WriteValue>
+    void write_rows(std::uint64_t count, std::uint64_t col_count, WriteValue&& write_value) {
+        assert(col_count > 0);
+        std::visit(
+            [&](const auto& delimiters) {
+                ValueSink sink{buffer, delimiters};
+                for (std::uint64_t row = 0; row < count; ++row) {
+                    begin_row(delimiters);
+                    write_value(row, std::uint64_t{0}, sink);
+                    for (std::uint64_t col = 1; col < col_count; ++col) {
+                        buffer.append(delimiters.value_separator);
+                        write_value(row, col, sink);
+                    }
+                    buffer.append(delimiters.row_end);
+                }
+            },
+            delimiters);
+    }
+
+    /// @brief continue with row number row of the table (for writing only a
+    /// part of a table), i.e. as if row rows had been written already
+    void resume_at(std::uint64_t row) { this->row = row; }
+
+    const TextFormat& text_format() const { return format; }
+
+    /// @brief writes the suffix of the format and flushes the buffer
+    void finish() {
+        buffer.append(format.suffix);
+        buffer.flush();
+    }
+
+   private:
+    OutputBuffer buffer;
+    TextFormat format;
+    RowDelimiters delimiters;
+    /// number of the next row in the table
+    std::uint64_t row = 0;
+
+    template <typename Delimiters>
+    void begin_row(const Delimiters& delimiters) {
+        if (row > 0) {
+            bool new_batch = format.batch_rows > 0 && row % format.batch_rows == 0;
+            buffer.append(new_batch ? std::string_view{format.batch_separator}
+                                    : std::string_view{delimiters.row_separator});
+        }
+        ++row;
+        buffer.append(delimiters.row_begin);
+    }
+};
+
+}  // namespace detail
+
+/// @brief formats a single value of type T for the text writers
+/// @details called as formatter(value, sink) for every value, where sink has
+/// append(std::string_view) and append_value(value), which formats an
+/// arithmetic value with std::to_chars (booleans as the format writes them).
+/// The formatter is a template argument of @see TableWriter and is inlined
+/// into its row loop
+template <typename Formatter, typename T>
+concept ValueFormatter =
+    requires(Formatter& formatter, const T& value,
+             detail::ValueSink<detail::DynamicDelimiters>& sink) { formatter(value, sink); };
+
+/// @brief formats arithmetic values with std::to_chars, doubles in the
+/// shortest form that reads back to the same value
+struct ToCharsFormatter {
+    template <detail::FastFormattable T, typename Sink>
+    void operator()(T value, Sink& sink) const {
+        sink.append_value(value);
+    }
+};
+
+/// @brief formats values through a std::ostream, with an @see OutputFunction
+/// or operator<<
+/// @details slow, but uses the formatting flags of the stream given to
+/// @see copyfmt
+template <typename T>
+class StreamFormatter {
+   public:
+    /// @brief formats with operator<<
+    StreamFormatter() : o{detail::output_id<T>} {}
+
+    explicit StreamFormatter(OutputFunction<T> o) : o{std::move(o)} {}
+
+    /// @brief format like ostream (flags, precision, locale)
+    void copyfmt(const std::ostream& ostream) { stream.copyfmt(ostream); }
+
+    template <typename Sink>
+    void operator()(const T& value, Sink& sink) {
+        stream.str({});
+        o(value, stream);
+        sink.append(stream.view());
+    }
+
+   private:
+    OutputFunction<T> o;
+    std::ostringstream stream;
+};
+
+/// @brief @see ToCharsFormatter for the types it formats, otherwise
+/// @see StreamFormatter with operator<<
+template <typename T>
+using DefaultFormatter =
+    std::conditional_t<detail::FastFormattable<T>, ToCharsFormatter, StreamFormatter<T>>;
+
+/// @brief writes a table in a @see TextFormat piece by piece
+/// @details rows can be handed over in several calls (e.g. the chunks of
+/// @see generate_stream); the output is the same as if all rows had been
+/// written at once. The values are formatted by Formatter, by default
+/// arithmetic values with std::to_chars into a large buffer (doubles in the
+/// shortest form that reads back exactly) and other types through a
+/// std::ostream with the formatting flags of ostream. The row loop is
+/// specialized for Formatter and for the delimiters of the formats of this
+/// library, so that neither costs an indirect call per value; an
+/// @see OutputFunction given at runtime is called through std::function
+/// @tparam T type of the generated data
+/// @tparam Formatter a @see ValueFormatter for T
+template <typename T, ValueFormatter<T> Formatter = DefaultFormatter<T>>
+class TableWriter {
+   public:
+    /// @brief writes the prefix of the format
+    TableWriter(std::ostream& ostream, TextFormat format, Formatter formatter = {})
+        : writer{ostream, std::move(format)}, formatter{std::move(formatter)} {
+        if constexpr (requires { this->formatter.copyfmt(ostream); }) {
+            this->formatter.copyfmt(ostream);
+        }
+    }
+
+    /// @brief writes the prefix of the format
+    /// @param o function that formats a single value instead of Formatter
+    /// (slow path); none if empty
+    TableWriter(std::ostream& ostream, TextFormat format, OutputFunction<T> o)
+        : TableWriter{ostream, std::move(format)} {
+        if (o) {
+            function.emplace(std::move(o));
+            function->copyfmt(ostream);
+        }
+    }
+
+    /// @brief writes the rows [begin, end) of data
+    /// @details the rows of layouts other than @see RowMajor are first copied
+    /// 64 at a time into a row-major buffer, column by column, so that every
+    /// column is read sequentially
+    template <DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data, std::uint64_t begin, std::uint64_t end) {
+        DATAGEN_STATS_PHASE(Phase::format);
+        if (function) {
+            write_rows(data, begin, end, *function);
+        } else {
+            write_rows(data, begin, end, formatter);
+        }
+    }
+
+    /// @brief writes the first rows rows of data
+    template <DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data, std::uint64_t rows) {
+        write_rows(data, 0, rows);
+    }
+
+    /// @brief writes all rows of data
+    template <DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data) {
+        write_rows(data, data.row_count);
+    }
+
+    /// @brief continue with row number row of the table (for writing only a
+    /// part of a table), i.e. as if row rows had been written already
+    void resume_at(std::uint64_t row) { writer.resume_at(row); }
+
+    /// @brief writes the suffix of the format and flushes the buffer; call
+    /// after the last row
+    void finish() { writer.finish(); }
+
+   private:
+    detail::TextWriter writer;
+    Formatter formatter;
+    std::optional<StreamFormatter<T>> function;
+
+    template <DataLayout Layout, typename F>
+    void write_rows(const Data<T, Layout>& data, std::uint64_t begin, std::uint64_t end,
+                    F& format_value) {
+        assert(begin <= end && end <= data.row_count);
+        if constexpr (std::is_same_v<Layout, RowMajor>) {
+            writer.write_rows(end - begin, data.col_count,
+                              [&](std::uint64_t row, std::uint64_t col, auto& sink) {
+                                  format_value(data[begin + row][col], sink);
+                              });
+        } else {
+            constexpr std::uint64_t group_rows = 64;
+            // not a std::vector, which would be a std::vector<bool> for bool
+            std::unique_ptr<T[]> rows{new T[group_rows * data.col_count]};
+            for (std::uint64_t first = begin; first < end; first += group_rows) {
+                std::uint64_t count = std::min(group_rows, end - first);
+                for (std::uint64_t col = 0; col < data.col_count; ++col) {
+                    auto values = data.column(col).begin() + static_cast<std::ptrdiff_t>(first);
+                    for (std::uint64_t i = 0; i < count; ++i) {
+                        rows[i * data.col_count + col] = values[static_cast<std::ptrdiff_t>(i)];
+                    }
+                }
+                writer.write_rows(count, data.col_count,
+                                  [&](std::uint64_t row, std::uint64_t col, auto& sink) {
+                                      format_value(rows[row * data.col_count + col], sink);
+                                  });
+            }
+        }
+    }
+};
+
+namespace detail {
+
+/// @brief the formatted values of a group of rows of a table, column by
+/// column, for writing them row by row
+/// @details every value has a slot of slot_chars chars, enough for the
+/// types of a @see ColumnTable (at most 24 chars for a double), so that the
+/// values are copied into the output as whole slots
+class CellBuffer {
+   public:
+    static constexpr std::size_t slot_chars = 32;
+
+    /// @brief a sink like @see ValueSink that fills the slot of a value
+    class Sink {
+       public:
+        Sink(char* slot, bool bool_literals) : slot{slot}, bool_literals{bool_literals} {}
+
+        void append(std::string_view s) {
+            assert(s.size() <= slot_chars - used);
+            std::copy(s.begin(), s.end(), slot + used);
+            used += s.size();
+        }
+
+        template <FastFormattable T>
+        void append_value(T value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                append(bool_literals ? (value ? "true" : "false") : (value ? "1" : "0"));
+            } else {
+                auto result = std::to_chars(slot + used, slot + slot_chars, value);
+                assert(result.ec == std::errc{});
+                used = static_cast<std::size_t>(result.ptr - slot);
+            }
+        }
+
+        std::size_t size() const { return used; }
+
+       private:
+        char* slot;
+        bool bool_literals;
+        std::size_t used = 0;
+    };
+
+    /// @brief makes room for row_count rows of col_count columns
+    void resize(std::uint64_t row_count, std::uint64_t col_count) {
+        auto cells = static_cast<std::size_t>(row_count * col_count);
+        if (cells > sizes.size()) {
+            // zeroed, as whole slots are copied
+            chars.reset(new char[cells * slot_chars]());
+            sizes.resize(cells);
+        }
+        rows = row_count;
+    }
+
+    /// @brief formats the values of column col with format_value(row, sink)
+    /// for every row
+    template <typename FormatValue>
+    void format_column(std::uint64_t col, bool bool_literals, FormatValue&& format_value) {
+        for (std::uint64_t row = 0; row < rows; ++row) {
+            auto index = static_cast<std::size_t>(col * rows + row);
+            Sink sink{chars.get() + index * slot_chars, bool_literals};
+            format_value(row, sink);
+            sizes[index] = static_cast<std::uint8_t>(sink.size());
+        }
+    }
+
+    /// @brief the formatted value in column col of row row
+    std::string_view cell(std::uint64_t row, std::uint64_t col) const {
+        auto index = static_cast<std::size_t>(col * rows + row);
+        return {chars.get() + index * slot_chars, sizes[index]};
+    }
+
+   private:
+    std::unique_ptr<char[]> chars;
+    std::vector<std::uint8_t> sizes;
+    std::uint64_t rows = 0;
+};
+
+}  // namespace detail
+
+/// @brief writes a @see ColumnTable in a @see TextFormat piece by piece,
+/// row by row with the values of all its columns
+/// @details works like @see TableWriter. The rows are formatted 64 at a
+/// time column by column, so that the type of a column is looked up once
+/// per group instead of for every value
+class ColumnTableWriter {
+   public:
+    /// @brief writes the prefix of the format
+    ColumnTableWriter(std::ostream& ostream, TextFormat format)
+        : writer{ostream, std::move(format)} {}
+
+    /// @brief writes the rows [begin, end) of table
+    void write_rows(const ColumnTable& table, std::uint64_t begin,
+                    std::uint64_t end) {
+        assert(begin <= end && end <= table.row_count);
+        DATAGEN_STATS_PHASE(Phase::format);
+        constexpr std::uint64_t group_rows = 64;
+        bool bool_literals = writer.text_format().bool_literals;
+        for (std::uint64_t first = begin; first < end; first += group_rows) {
+            std::uint64_t count = std::min(group_rows, end - first);
+            cells.resize(count, table.col_count);
+            for (std::uint64_t col = 0; col < table.col_count; ++col) {
+                std::visit(
+                    [&](const auto& column) {
+                        cells.format_column(col, bool_literals, [&](std::uint64_t row, auto& sink) {
+                            ToCharsFormatter{}(column[first + row][0], sink);
+                        });
+                    },
+                    table.column(col));
+            }
+            writer.write_rows(count, table.col_count,
+                              [&](std::uint64_t row, std::uint64_t col, auto& sink) {
+                                  sink.append_padded(cells.cell(row, col),
+                                                     detail::CellBuffer::slot_chars);
+                              });
+        }
+    }
+
+    /// @brief writes the first rows rows of table
+    void write_rows(const ColumnTable& table, std::uint64_t rows) {
+        write_rows(table, 0, rows);
+    }
+
+    /// @brief writes all rows of table
+    void write_rows(const ColumnTable& table) {
+        write_rows(table, table.row_count);
+    }
+
+    /// @brief see @see TableWriter::resume_at
+    void resume_at(std::uint64_t row) { writer.resume_at(row); }
+
+    /// @brief writes the suffix of the format and flushes the buffer; call
+    /// after the last row
+    void finish() { writer.finish(); }
+
+   private:
+    detail::TextWriter writer;
+    detail::CellBuffer cells;
+};
+
+/// @brief the csv @see TextFormat
+inline TextFormat csv_format() { return {"", "", ",", "", "\n", ""}; }
+
+namespace detail {
+
+/// @brief name as an sql identifier: in double quotes, with every double
+/// quote in it doubled
+inline std::string quote_identifier(const std::string& name) {
+    std::string quoted = "\"";
+    for (char c : name) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/// @brief "table" ("column", ...) or "table" if there are no column names
+/// (@see quote_identifier)
+inline std::string sql_table(const std::string& tablename,
+                             const std::vector<std::string>& column_names) {
+    std::string table = quote_identifier(tablename);
+    for (std::size_t col = 0; col < column_names.size(); ++col) {
+        table += (col == 0 ? " (" : ", ") + quote_identifier(column_names[col]);
+    }
+    return column_names.empty() ? table : table + ")";
+}
+
+}  // namespace detail
+
+/// @brief the sql @see TextFormat (INSERT statements)
+/// @param tablename name of the table to insert the data into
+/// @param column_names names of the columns to insert into; if empty, the
+/// values are inserted in the order of the table's columns
+/// @param batch_rows rows per INSERT statement; 0 means a single statement,
+/// otherwise the statements are wrapped in one transaction
+inline TextFormat sql_format(const std::string& tablename,
+                             const std::vector<std::string>& column_names = {},
+                             unsigned int batch_rows = 0) {
+    std::string insert =
+        "INSERT INTO " + detail::sql_table(tablename, column_names) + " VALUES\n";
+    if (batch_rows == 0) {
+        return {insert, "  (", ", ", ")", ",\n", ";"};
+    }
+    return {"BEGIN;\n" + insert, "  (", ", ", ")", ",\n",
+            ";\nCOMMIT;", false, batch_rows, ";\n" + insert};
+}
+
+/// @brief the @see TextFormat of a PostgreSQL COPY FROM STDIN command with its
+/// data in text format, e.g. for psql
+/// @param tablename name of the table to copy the data into
+/// @param column_names see @see sql_format
+inline TextFormat postgres_copy_format(
+    const std::string& tablename,
+    const std::vector<std::string>& column_names = {}) {
+    return {"COPY " + detail::sql_table(tablename, column_names) +
+                " FROM STDIN;\n",
+            "", "\t", "", "\n", "\n\\.\n", true};
+}
+
+/// @brief the json @see TextFormat (nested array)
+inline TextFormat json_format() {
+    return {"[\n", "  [", ", ", "]", ",\n", "\n]", true};
+}
+
+/// @brief format for shard (see @see shard_rows) of a table of row_count rows
+/// @details every shard is written as a complete table in format. Formats
+/// without prefix and suffix, such as csv, additionally end every shard
+/// before the last with the row separator, so that the concatenated shards
+/// equal the whole table
+inline TextFormat shard_format(TextFormat format, RowRange shard,
+                               std::uint64_t row_count) {
+    if (format.prefix.empty() && format.suffix.empty() && shard.row_count > 0 &&
+        shard.first_row + shard.row_count < row_count) {
+        format.suffix = format.row_separator;
+    }
+    return format;
+}
+
+/// @brief creates a @see TableWriter for csv format
+template <typename T>
+TableWriter<T> csv_writer(std::ostream& ostream,
+                          const OutputFunction<T>& o = {}) {
+    return TableWriter<T>{ostream, csv_format(), o};
+}
+
+/// @brief creates a @see TableWriter for sql format
+/// @param tablename name of the table to insert the data into
+template <typename T>
+TableWriter<T> sql_writer(std::ostream& ostream, const std::string& tablename,
+                          const OutputFunction<T>& o = {}) {
+    return TableWriter<T>{ostream, sql_format(tablename), o};
+}
+
+/// @brief creates a @see TableWriter for json format (nested array)
+template <typename T>
+TableWriter<T> json_writer(std::ostream& ostream,
+                           const OutputFunction<T>& o = {}) {
+    return TableWriter<T>{ostream, json_format(), o};
+}
+
+/// @brief output data to std::ostream in csv format
+/// @tparam T type of the generated data
+/// @param o optional function to output a single value
+template <typename T, DataLayout Layout>
+void output_csv(const Data<T, Layout>& data, std::ostream& ostream,
+                const OutputFunction<T>& o = {}) {
+    TableWriter<T> writer = csv_writer<T>(ostream, o);
+    writer.write_rows(data);
+    writer.finish();
+}
+
+/// @brief output data to std::ostream in sql format
+/// @tparam T Type of the generated data
+/// @param tablename name of the table to insert the data into
+/// @param o optional function to output a single value
+template <typename T, DataLayout Layout>
+void output_sql(const Data<T, Layout>& data, std::ostream& ostream,
+                const std::string& tablename,
+                const OutputFunction<T>& o = {}) {
+    TableWriter<T> writer = sql_writer<T>(ostream, tablename, o);
+    writer.write_rows(data);
+    writer.finish();
+}
+
+/// @brief output data to std::ostream in json format (nested array)
+/// @tparam T Type of the generated data
+/// @param o optional function to output a single value
+template <typename T, DataLayout Layout>
+void output_json(const Data<T, Layout>& data, std::ostream& ostream,
+                 const OutputFunction<T>& o = {}) {
+    TableWriter<T> writer = json_writer<T>(ostream, o);
+    writer.write_rows(data);
+    writer.finish();
 }
 
 }  // namespace datagen
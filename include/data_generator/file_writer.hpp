@@ -0,0 +1,371 @@
+#ifndef __DATAGEN_FILE_WRITER_HPP__
+#define __DATAGEN_FILE_WRITER_HPP__
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "compression.hpp"
+#include "data_generator.hpp"
+#include "stats.hpp"
+
+namespace datagen {
+
+namespace detail {
+
+/// @brief stream buffer that appends everything to a std::string
+class StringAppendBuffer : public std::streambuf {
+   public:
+    StringAppendBuffer() = default;
+
+    explicit StringAppendBuffer(std::string& s) : s{&s} {}
+
+    /// @brief append to s from now on
+    void target(std::string& s) { this->s = &s; }
+
+   protected:
+    std::streamsize xsputn(const char* chars, std::streamsize count) override {
+        s->append(chars, static_cast<std::size_t>(count));
+        return count;
+    }
+
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            s->push_back(traits_type::to_char_type(c));
+        }
+        return traits_type::not_eof(c);
+    }
+
+   private:
+    std::string* s = nullptr;
+};
+
+/// @brief table type and text writer for tables of values of type T
+template <typename T>
+struct TextTable {
+    using Table = Data<T>;
+    using Writer = TableWriter<T>;
+};
+
+template <>
+struct TextTable<ColumnTable> {
+    using Table = ColumnTable;
+    using Writer = ColumnTableWriter;
+};
+
+/// @brief formats parts of a table into strings, with one writer (and its
+/// buffer) for all parts
+template <typename T>
+class PartFormatter {
+   public:
+    using Table = typename TextTable<T>::Table;
+
+    /// @param format format without prefix and suffix
+    /// @param o optional function that formats a single value (not for
+    /// @see ColumnTable)
+    PartFormatter(const TextFormat& format, const OutputFunction<T>& o)
+        : os{&buffer}, writer{make_writer(format, o)} {
+        assert(format.prefix.empty() && format.suffix.empty());
+    }
+
+    /// @brief formats the rows [begin, end) of data into part, reusing its
+    /// memory
+    /// @param table_row number of row begin in the whole table
+    void format(const Table& data, std::uint64_t begin, std::uint64_t end,
+                std::uint64_t table_row, std::string& part) {
+        DATAGEN_STATS_PHASE(Phase::format);
+        part.clear();
+        buffer.target(part);
+        writer.resume_at(table_row);
+        writer.write_rows(data, begin, end);
+        // without a suffix this only flushes the buffer into part
+        writer.finish();
+    }
+
+   private:
+    StringAppendBuffer buffer;
+    std::ostream os;
+    typename TextTable<T>::Writer writer;
+
+    typename TextTable<T>::Writer make_writer(const TextFormat& format,
+                                              const OutputFunction<T>& o) {
+        if constexpr (std::is_same_v<T, ColumnTable>) {
+            return {os, format};
+        } else {
+            return {os, format, o};
+        }
+    }
+};
+
+}  // namespace detail
+
+/// @brief position of a @see FileTableWriter in its table: the rows written
+/// so far and the size of the file with them (without the suffix)
+struct FileCheckpoint {
+    std::uint64_t rows = 0;
+    std::uint64_t bytes = 0;
+};
+
+/// @brief writes a table in a @see TextFormat to a file, formatting and
+/// writing on several threads
+/// @details the rows are split into up to thread_count parts (of at most
+/// 65536 rows each) that are formatted in parallel, each into its own buffer
+/// by a formatter that the part keeps for all calls. Once the sizes of the
+/// parts are known, the file is extended by exactly their total size with
+/// posix_fallocate and every thread writes its part with pwrite at its own
+/// offset, so no thread waits for a shared stream.
+/// The output is the same as that of a @see TableWriter, or every part is
+/// compressed by its thread (@see Compression). Between two calls the file
+/// holds exactly the rows written so far (@see checkpoint), so a table can be
+/// continued from there by another writer, e.g. after the process died.
+/// POSIX only.
+/// @tparam T type of the generated data, or @see ColumnTable
+template <typename T>
+class FileTableWriter {
+   public:
+    using Table = typename detail::TextTable<T>::Table;
+
+    /// @brief creates (or truncates) the file at path and writes the prefix
+    /// of the format
+    /// @param o optional function that formats a single value (not for
+    /// @see ColumnTable)
+    /// @param resume continue the table in the file from this checkpoint of a
+    /// writer with the same format instead: the file is truncated to
+    /// resume->bytes, the prefix isn't written again and the next row is row
+    /// resume->rows of the table
+    /// @throws std::system_error if the file can't be opened or written,
+    /// std::invalid_argument if the compression isn't available,
+    /// std::runtime_error if the file is shorter than the checkpoint
+    FileTableWriter(const std::string& path, TextFormat format,
+                    unsigned int thread_count = 1, OutputFunction<T> o = {},
+                    Compression compression = Compression::none,
+                    std::optional<FileCheckpoint> resume = {})
+        : format{std::move(format)},
+          thread_count{thread_count},
+          o{std::move(o)},
+          compression{compression} {
+        assert(thread_count > 0);
+        if (!compression_available(compression)) {
+            throw std::invalid_argument{"compression not available in this build"};
+        }
+        int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (resume ? 0 : O_TRUNC);
+        fd = ::open(path.c_str(), flags, 0666);
+        if (fd < 0) {
+            throw std::system_error{errno, std::generic_category(), path};
+        }
+        part_format = this->format;
+        part_format.prefix.clear();
+        part_format.suffix.clear();
+        try {
+            if (resume) {
+                continue_at(*resume, path);
+            } else {
+                append(this->format.prefix);
+            }
+        } catch (...) {
+            // the destructor doesn't run
+            ::close(fd);
+            throw;
+        }
+    }
+
+    FileTableWriter(const FileTableWriter&) = delete;
+    FileTableWriter& operator=(const FileTableWriter&) = delete;
+
+    ~FileTableWriter() { ::close(fd); }
+
+    /// @brief writes the first rows rows of data
+    void write_rows(const Table& data, std::uint64_t rows) {
+        assert(rows <= data.row_count);
+        std::uint64_t round_rows = thread_count * max_part_rows;
+        for (std::uint64_t begin = 0; begin < rows;) {
+            std::uint64_t end = begin + std::min(rows - begin, round_rows);
+            write_round(data, begin, end);
+            begin = end;
+        }
+    }
+
+    /// @brief writes all rows of data
+    void write_rows(const Table& data) { write_rows(data, data.row_count); }
+
+    /// @brief the rows written so far and the bytes they take in the file;
+    /// a @see FileTableWriter given it as resume continues the table from here
+    FileCheckpoint checkpoint() const {
+        return {rows_written, static_cast<std::uint64_t>(offset)};
+    }
+
+    /// @brief makes the rows written so far durable (fdatasync), e.g. before
+    /// recording their @see checkpoint
+    /// @throws std::system_error if syncing failed
+    void sync() const {
+        DATAGEN_STATS_PHASE(Phase::write);
+        if (::fdatasync(fd) != 0) {
+            throw std::system_error{errno, std::generic_category(), "fdatasync"};
+        }
+    }
+
+    /// @brief writes the suffix of the format; call after the last row
+    void finish() { append(format.suffix); }
+
+   private:
+    /// parts with fewer rows aren't worth a thread
+    static constexpr unsigned int min_part_rows = 1024;
+
+    /// bounds the memory for the formatted rows
+    static constexpr unsigned int max_part_rows = 1 << 16;
+
+    int fd;
+    TextFormat format;
+    /// format without prefix and suffix for the parts
+    TextFormat part_format;
+    unsigned int thread_count;
+    OutputFunction<T> o;
+    Compression compression;
+    off_t offset = 0;
+    /// number of rows written so far
+    std::uint64_t rows_written = 0;
+    /// formatters of the parts, created by their threads on first use
+    std::vector<std::unique_ptr<detail::PartFormatter<T>>> formatters;
+    /// formatted rows of the current round, one string per thread
+    std::vector<std::string> parts;
+    /// buffers for compressing the parts
+    std::vector<std::string> spares;
+
+    /// @brief formats the rows [begin, end) in up to thread_count parts in
+    /// parallel and writes them
+    /// @details within a @see NumaScope, the parts are the blocks that
+    /// @see fill_rows gives each thread when it generates the same table rows
+    /// (from rows_written on), e.g. a chunk of @see generate_stream with
+    /// thread_count threads, so that a thread formats the rows it generated
+    void write_round(const Table& data, std::uint64_t begin, std::uint64_t end) {
+        std::uint64_t rows = end - begin;
+        auto part_count = static_cast<unsigned int>(std::clamp<std::uint64_t>(
+            rows / min_part_rows, 1, thread_count));
+        // within a NumaScope the parts are split along the blocks of rows_per_block rows
+        std::uint64_t rows_per_block = 0;
+        if constexpr (!std::is_same_v<T, ColumnTable>) {
+            if (thread_count > 1 && detail::active_topology.load(std::memory_order_relaxed)) {
+                rows_per_block = block_rows(data.col_count);
+                part_count = static_cast<unsigned int>(std::min<std::uint64_t>(
+                    thread_count, detail::block_count(rows_written, rows, rows_per_block)));
+                if (std::is_same_v<T, bool> && rows_written % 64 != 0) {
+                    // as in fill_rows
+                    part_count = 1;
+                }
+            }
+        }
+        // the table rows [first, last) of part
+        auto part_rows = [&](unsigned int part) -> std::pair<std::uint64_t, std::uint64_t> {
+            if (rows_per_block > 0) {
+                return detail::split_blocks(rows_written, rows, rows_per_block, part, part_count);
+            }
+            return {rows_written + detail::split_begin(rows, part, part_count),
+                    rows_written + detail::split_begin(rows, part + 1, part_count)};
+        };
+        formatters.resize(std::max<std::size_t>(formatters.size(), part_count));
+        parts.resize(part_count);
+        spares.resize(part_count);
+
+        detail::run_parallel(part_count, [&](unsigned int part) {
+            auto [first, last] = part_rows(part);
+            if (!formatters[part]) {
+                formatters[part] = std::make_unique<detail::PartFormatter<T>>(part_format, o);
+            }
+            formatters[part]->format(data, begin + (first - rows_written),
+                                     begin + (last - rows_written), first, parts[part]);
+            detail::compress_in_place(compression, parts[part], spares[part]);
+        });
+        rows_written += rows;
+
+        std::vector<off_t> offsets(part_count);
+        off_t size = 0;
+        for (unsigned int part = 0; part < part_count; ++part) {
+            offsets[part] = offset + size;
+            size += static_cast<off_t>(parts[part].size());
+        }
+        allocate(size);
+
+        detail::run_parallel(part_count, [&](unsigned int part) {
+            write_at(parts[part], offsets[part]);
+        });
+        offset += size;
+    }
+
+    /// @brief drops everything after checkpoint from the file and continues
+    /// from there
+    void continue_at(FileCheckpoint checkpoint, const std::string& path) {
+        struct stat status {};
+        if (::fstat(fd, &status) != 0) {
+            throw std::system_error{errno, std::generic_category(), path};
+        }
+        if (static_cast<std::uint64_t>(status.st_size) < checkpoint.bytes) {
+            throw std::runtime_error{path + " is shorter than its checkpoint"};
+        }
+        offset = static_cast<off_t>(checkpoint.bytes);
+        if (::ftruncate(fd, offset) != 0) {
+            throw std::system_error{errno, std::generic_category(), path};
+        }
+        rows_written = checkpoint.rows;
+    }
+
+    /// @brief writes s (compressed) at the end of the file
+    void append(std::string_view s) {
+        std::string compressed;
+        if (compression != Compression::none) {
+            detail::compress_block(compression, s, compressed);
+            s = compressed;
+        }
+        allocate(static_cast<off_t>(s.size()));
+        write_at(s, offset);
+        offset += static_cast<off_t>(s.size());
+    }
+
+    /// @brief reserves size bytes after offset; only fails if the disk is full
+    void allocate(off_t size) {
+        if (size == 0) {
+            return;
+        }
+        int error = ::posix_fallocate(fd, offset, size);
+        if (error == ENOSPC || error == EFBIG) {
+            throw std::system_error{error, std::generic_category(),
+                                    "posix_fallocate"};
+        }
+    }
+
+    void write_at(std::string_view s, off_t position) const {
+        DATAGEN_STATS_PHASE(Phase::write);
+        DATAGEN_STATS_BYTES(s.size());
+        while (!s.empty()) {
+            ssize_t written = ::pwrite(fd, s.data(), s.size(), position);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error{errno, std::generic_category(), "pwrite"};
+            }
+            s.remove_prefix(static_cast<std::size_t>(written));
+            position += written;
+        }
+    }
+};
+
+}  // namespace datagen
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef __DATAGEN_MAPPED_FILE_HPP__
+#define __DATAGEN_MAPPED_FILE_HPP__
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <system_error>
+
+namespace datagen {
+
+/// @brief memory resource that places its allocations in a file mapped into
+/// memory, for tables that are bigger than the RAM (POSIX only)
+/// @details every allocation gets its own page aligned region at the end of
+/// the file, which is extended with ftruncate and mapped with MAP_SHARED.
+/// The kernel writes dirty pages back to the file and drops them when memory
+/// gets scarce, so only the pages that are in use occupy RAM. A @see Data
+/// created with this resource stores its values there, e.g.
+/// `Data<int> data{rows, cols, &resource}`. The file is kept after the
+/// resource is destroyed; for a single @see Data it then contains the values
+/// row-major in native byte order (booleans as the 64 bit words of the
+/// bitmap, see DataStorage<bool>). The resource must outlive
+/// everything allocated from it.
+class MappedFileResource : public std::pmr::memory_resource {
+   public:
+    /// @brief creates (or truncates) the file at path
+    /// @throws std::system_error if the file can't be opened
+    explicit MappedFileResource(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        if (fd < 0) {
+            throw std::system_error{errno, std::generic_category(), path};
+        }
+    }
+
+    MappedFileResource(const MappedFileResource&) = delete;
+    MappedFileResource& operator=(const MappedFileResource&) = delete;
+
+    ~MappedFileResource() override { ::close(fd); }
+
+    /// @brief current size of the file in bytes
+    off_t file_size() const { return size; }
+
+   private:
+    int fd;
+    off_t size = 0;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        const auto page_size = static_cast<off_t>(::sysconf(_SC_PAGESIZE));
+        assert(static_cast<off_t>(alignment) <= page_size);
+        (void)alignment;
+        bytes = std::max<std::size_t>(bytes, 1);
+        off_t offset = (size + page_size - 1) / page_size * page_size;
+        if (::ftruncate(fd, offset + static_cast<off_t>(bytes)) != 0) {
+            throw std::system_error{errno, std::generic_category(), "ftruncate"};
+        }
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+        if (p == MAP_FAILED) {
+            throw std::system_error{errno, std::generic_category(), "mmap"};
+        }
+        size = offset + static_cast<off_t>(bytes);
+        return p;
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t) override {
+        ::munmap(p, std::max<std::size_t>(bytes, 1));
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+}  // namespace datagen
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef __DATAGEN_NUMA_HPP__
+#define __DATAGEN_NUMA_HPP__
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace datagen {
+
+namespace detail {
+
+/// @brief the numbers of a list like /sys/devices/system/node/online or a
+/// cpulist, e.g. "0-3,8,10-11"
+inline std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> numbers;
+    std::istringstream ranges{list};
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        std::istringstream is{range};
+        int first = 0;
+        int last = 0;
+        if (!(is >> first)) {
+            continue;
+        }
+        char dash = 0;
+        if (!(is >> dash >> last) || dash != '-') {
+            last = first;
+        }
+        for (int number = first; number <= last; ++number) {
+            numbers.push_back(number);
+        }
+    }
+    return numbers;
+}
+
+}  // namespace detail
+
+/// @brief the numa nodes of the machine with the cpus of each that the
+/// process may run on
+class NumaTopology {
+   public:
+    /// @param node_cpus the cpus of every node (-1 for a cpu that can't be
+    /// pinned to); nodes without cpus are left out
+    explicit NumaTopology(std::vector<std::vector<int>> node_cpus) {
+        for (std::vector<int>& cpus : node_cpus) {
+            if (!cpus.empty()) {
+                nodes.push_back(std::move(cpus));
+            }
+        }
+        assert(!nodes.empty());
+    }
+
+    /// @brief the nodes of /sys/devices/system/node with the cpus that the
+    /// calling thread may run on (Linux); without numa information a single
+    /// node with these cpus, and elsewhere a single node of
+    /// std::thread::hardware_concurrency() cpus that aren't pinned to
+    static NumaTopology detect() {
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (::sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+            auto is_allowed = [&](int cpu) {
+                return cpu >= 0 && cpu < CPU_SETSIZE &&
+                       CPU_ISSET(static_cast<std::size_t>(cpu), &allowed);
+            };
+            const std::string sys = "/sys/devices/system/node/";
+            std::vector<std::vector<int>> node_cpus;
+            std::ifstream online{sys + "online"};
+            std::string list;
+            if (std::getline(online, list)) {
+                for (int node : detail::parse_cpu_list(list)) {
+                    std::ifstream file{sys + "node" + std::to_string(node) + "/cpulist"};
+                    std::getline(file, list);
+                    std::vector<int> cpus = detail::parse_cpu_list(list);
+                    std::erase_if(cpus, [&](int cpu) { return !is_allowed(cpu); });
+                    node_cpus.push_back(std::move(cpus));
+                }
+            }
+            if (std::none_of(node_cpus.begin(), node_cpus.end(),
+                             [](const std::vector<int>& cpus) { return !cpus.empty(); })) {
+                std::vector<int> cpus;
+                for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                    if (is_allowed(cpu)) {
+                        cpus.push_back(cpu);
+                    }
+                }
+                node_cpus = {std::move(cpus)};
+            }
+            return NumaTopology{std::move(node_cpus)};
+        }
+#endif
+        return NumaTopology{{std::vector<int>(std::max(1u, std::thread::hardware_concurrency()), -1)}};
+    }
+
+    std::size_t node_count() const { return nodes.size(); }
+
+    /// @brief the cpus of node
+    const std::vector<int>& cpus(std::size_t node) const { return nodes[node]; }
+
+    std::size_t cpu_count() const {
+        return std::accumulate(nodes.begin(), nodes.end(), std::size_t{0},
+                               [](std::size_t sum, const std::vector<int>& cpus) {
+                                   return sum + cpus.size();
+                               });
+    }
+
+    /// @brief only the first count nodes, e.g. to measure the scaling per
+    /// socket
+    NumaTopology first_nodes(std::size_t count) const {
+        assert(count > 0 && count <= nodes.size());
+        return NumaTopology{{nodes.begin(), nodes.begin() + static_cast<std::ptrdiff_t>(count)}};
+    }
+
+    /// @brief node of thread thread of thread_count threads: the threads are
+    /// split into consecutive groups of (almost) equal size, one per node
+    std::size_t node(unsigned int thread, unsigned int thread_count) const {
+        assert(thread < thread_count);
+        return static_cast<std::size_t>(std::uint64_t{thread} * nodes.size() / thread_count);
+    }
+
+    /// @brief the cpu of thread thread of thread_count threads: the cpus of
+    /// its node (@see node) in turn
+    int cpu(unsigned int thread, unsigned int thread_count) const {
+        std::size_t n = node(thread, thread_count);
+        // the first thread of the node
+        std::uint64_t first = (n * std::uint64_t{thread_count} + nodes.size() - 1) / nodes.size();
+        return nodes[n][static_cast<std::size_t>((thread - first) % nodes[n].size())];
+    }
+
+   private:
+    std::vector<std::vector<int>> nodes;
+};
+
+namespace detail {
+
+/// @brief the topology of the active @see NumaScope, if any
+inline std::atomic<const NumaTopology*> active_topology{nullptr};
+
+/// @brief lets the calling thread run on cpu only (Linux); nothing for a
+/// negative cpu or elsewhere
+inline void pin_thread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<std::size_t>(cpu), &set);
+    // fails only if the cpu went offline, and then the thread isn't pinned
+    static_cast<void>(::sched_setaffinity(0, sizeof(set), &set));
+#else
+    static_cast<void>(cpu);
+#endif
+}
+
+/// @brief lets the calling thread, and the threads it starts from now on,
+/// run on the cpus of topology only (Linux); nothing if topology has cpus
+/// that can't be pinned to, or elsewhere
+inline void restrict_thread(const NumaTopology& topology) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (std::size_t node = 0; node < topology.node_count(); ++node) {
+        for (int cpu : topology.cpus(node)) {
+            if (cpu < 0 || cpu >= CPU_SETSIZE) {
+                return;
+            }
+            CPU_SET(static_cast<std::size_t>(cpu), &set);
+        }
+    }
+    static_cast<void>(::sched_setaffinity(0, sizeof(set), &set));
+#else
+    static_cast<void>(topology);
+#endif
+}
+
+/// @brief restores the cpus that the calling thread may run on at the end of
+/// the scope
+class AffinityGuard {
+   public:
+#ifdef __linux__
+    AffinityGuard() { saved = ::sched_getaffinity(0, sizeof(mask), &mask) == 0; }
+
+    ~AffinityGuard() {
+        if (saved) {
+            static_cast<void>(::sched_setaffinity(0, sizeof(mask), &mask));
+        }
+    }
+
+   private:
+    cpu_set_t mask;
+    bool saved;
+#endif
+};
+
+}  // namespace detail
+
+/// @brief pins the threads of the generators and writers to the cpus of a
+/// @see NumaTopology for the lifetime of the scope
+/// @details thread i of the n threads that work on a table at a time
+/// (@see detail::run_parallel) runs on topology.cpu(i, n), so consecutive
+/// threads share a node, and the generators give every thread consecutive
+/// blocks of rows instead of the next free block. The pages of a table that
+/// isn't zeroed (for_overwrite, as @see generate_data and the chunks of
+/// @see generate_stream are) are touched first by the thread that generates
+/// them, so the kernel puts them on its node. Data<bool> is the exception:
+/// its bitmap is always zeroed by the thread that creates the table, so it
+/// lies on that thread's node. A @see FileTableWriter splits
+/// the rows it writes at once into the same blocks (@see
+/// detail::split_blocks), so thread i formats the rows that it generated if
+/// they come from a single call with as many threads, e.g. every chunk of
+/// generate_stream, but not a whole table of generate_data, which is written
+/// in smaller rounds; @see generate_text generates and formats every block
+/// on one thread anyway. Scopes can't overlap, like @see StatsScope.
+class NumaScope {
+   public:
+    explicit NumaScope(NumaTopology topology) : topology{std::move(topology)} {
+        [[maybe_unused]] const NumaTopology* previous =
+            detail::active_topology.exchange(&this->topology);
+        assert(previous == nullptr);
+    }
+
+    NumaScope(const NumaScope&) = delete;
+    NumaScope& operator=(const NumaScope&) = delete;
+
+    ~NumaScope() { detail::active_topology.store(nullptr); }
+
+   private:
+    NumaTopology topology;
+};
+
+}  // namespace datagen
+
+#endif
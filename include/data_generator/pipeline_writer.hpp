@@ -0,0 +1,570 @@
+#ifndef __DATAGEN_PIPELINE_WRITER_HPP__
+#define __DATAGEN_PIPELINE_WRITER_HPP__
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "compression.hpp"
+#include "data_generator.hpp"
+#include "file_writer.hpp"
+
+namespace datagen {
+
+namespace detail {
+
+/// @brief a piece of the output and its position among the pieces
+struct OutputPart {
+    std::uint64_t sequence;
+    std::string text;
+    /// buffer for compressing text
+    std::string spare;
+};
+
+/// @brief writes parts of the output, which are produced in any order by
+/// several threads, to a std::ostream in the order of their sequence numbers
+/// @details a producer takes the next sequence number together with an empty
+/// buffer from @see acquire, fills the buffer and hands it back with
+/// @see submit. A thread of its own writes the parts as soon as all previous
+/// ones have been written. At most capacity parts are being filled or wait
+/// to be written at a time, so acquire blocks while the stream is behind.
+/// Sequence numbers are handed out with the buffers, which means the part
+/// that is written next always has one and the producers can't deadlock.
+/// The buffers are reused, so their memory is allocated only once. With a
+/// @see Compression every part is compressed by the thread that submits it.
+/// Whenever the writing thread has written every part that is ready, it
+/// flushes the stream, so slow producers (e.g. paced by a
+/// @see RateLimiter) don't leave their output in the stream's buffer.
+class OrderedOutput {
+   public:
+    /// @param capacity maximum number of parts in flight
+    /// @throws std::invalid_argument if the compression isn't available
+    OrderedOutput(std::ostream& ostream, std::size_t capacity,
+                  Compression compression = Compression::none)
+        : ostream{&ostream}, capacity{capacity}, compression{compression} {
+        assert(capacity > 0);
+        if (!compression_available(compression)) {
+            throw std::invalid_argument{"compression not available in this build"};
+        }
+        writer = std::thread{[this] { write_parts(); }};
+    }
+
+    OrderedOutput(const OrderedOutput&) = delete;
+    OrderedOutput& operator=(const OrderedOutput&) = delete;
+
+    /// @brief stops the writing thread; parts that haven't been written yet
+    /// are dropped unless @see finish was called
+    ~OrderedOutput() { stop(false); }
+
+    /// @brief takes the next sequence number and a buffer for its part,
+    /// waiting while capacity parts are in flight
+    /// @return nothing if all sequence numbers below end have been handed out
+    /// or the output failed (@see cancel)
+    std::optional<OutputPart> acquire(std::uint64_t end) {
+        std::unique_lock lock{mutex};
+        space.wait(lock, [&] { return in_flight < capacity || failure || next_sequence >= end; });
+        if (failure || next_sequence >= end) {
+            return std::nullopt;
+        }
+        ++in_flight;
+        OutputPart part;
+        if (!buffers.empty()) {
+            part = std::move(buffers.back());
+            buffers.pop_back();
+        }
+        part.sequence = next_sequence++;
+        return part;
+    }
+
+    /// @brief the sequence number that @see acquire hands out next
+    std::uint64_t next() {
+        std::lock_guard lock{mutex};
+        return next_sequence;
+    }
+
+    /// @brief hands a part from @see acquire over for writing, compressing
+    /// it first
+    void submit(OutputPart part) {
+        try {
+            compress_in_place(compression, part.text, part.spare);
+        } catch (...) {
+            cancel();
+            throw;
+        }
+        {
+            std::lock_guard lock{mutex};
+            std::uint64_t sequence = part.sequence;
+            pending.emplace(sequence, std::move(part));
+        }
+        ready.notify_one();
+    }
+
+    /// @brief writes text as the next part
+    void write(std::string_view text) {
+        std::optional<OutputPart> part = acquire(next() + 1);
+        if (part) {
+            part->text = text;
+            submit(std::move(*part));
+        }
+    }
+
+    /// @brief whether writing failed or a producer gave up (@see cancel)
+    bool failed() {
+        std::lock_guard lock{mutex};
+        return failure;
+    }
+
+    /// @brief makes @see acquire return nothing, for producers that give up;
+    /// parts that were acquired but never submitted aren't waited for
+    void cancel() {
+        {
+            std::lock_guard lock{mutex};
+            failure = true;
+        }
+        space.notify_all();
+        ready.notify_one();
+    }
+
+    /// @brief waits until every part that was handed out has been written
+    /// (unless the output failed, e.g. a producer gave up with a part it
+    /// never submitted), stops the writing thread and flushes the stream
+    /// @throws the exception of the stream, std::system_error with the errno
+    /// of the failed write (e.g. EPIPE if the reader of a pipe went away) or
+    /// std::runtime_error if writing failed
+    void finish() {
+        stop(true);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if (!failure && !ostream->flush()) {
+            error_number = errno;
+            failure = true;
+        }
+        if (failure && error_number != 0) {
+            throw std::system_error{error_number, std::generic_category(),
+                                    "writing the output failed"};
+        }
+        if (failure) {
+            throw std::runtime_error{"writing the output failed"};
+        }
+    }
+
+   private:
+    std::ostream* ostream;
+    std::size_t capacity;
+    Compression compression;
+
+    std::mutex mutex;
+    /// signaled when a part was submitted or the writing thread should stop
+    std::condition_variable ready;
+    /// signaled when a part was written or the output failed
+    std::condition_variable space;
+    /// parts waiting to be written by sequence number
+    std::map<std::uint64_t, OutputPart> pending;
+    /// empty buffers for @see acquire
+    std::vector<OutputPart> buffers;
+    std::uint64_t next_sequence = 0;
+    /// sequence number of the next part to write
+    std::uint64_t next_written = 0;
+    /// number of parts acquired but not written yet
+    std::size_t in_flight = 0;
+    bool failure = false;
+    bool stopping = false;
+    /// whether the writing thread writes all parts before it stops
+    bool drain = false;
+    /// exception thrown by the stream
+    std::exception_ptr error;
+    /// errno of the write that failed, if any
+    int error_number = 0;
+    std::thread writer;
+
+    /// @brief loop of the writing thread
+    void write_parts() {
+        std::unique_lock lock{mutex};
+        bool unflushed = false;
+        while (true) {
+            if (unflushed && !stopping &&
+                (pending.empty() || pending.begin()->first != next_written)) {
+                // nothing to write until the next part is submitted
+                lock.unlock();
+                bool flushed = write_to_stream([&] { ostream->flush(); });
+                lock.lock();
+                unflushed = false;
+                if (!flushed) {
+                    failure = true;
+                    space.notify_all();
+                }
+                continue;
+            }
+            ready.wait(lock, [&] {
+                return stopping || (!pending.empty() && pending.begin()->first == next_written);
+            });
+            if (stopping && (!drain || failure || next_written == next_sequence)) {
+                return;
+            }
+            if (pending.empty() || pending.begin()->first != next_written) {
+                // draining, but a part hasn't been submitted yet
+                ready.wait(lock);
+                continue;
+            }
+            OutputPart part = std::move(pending.begin()->second);
+            pending.erase(pending.begin());
+            bool write = !failure;
+            lock.unlock();
+            if (write) {
+                write = write_to_stream([&] {
+                    ostream->write(part.text.data(),
+                                   static_cast<std::streamsize>(part.text.size()));
+                });
+                unflushed = write;
+            }
+            part.text.clear();
+            lock.lock();
+            if (!write) {
+                failure = true;
+            }
+            buffers.push_back(std::move(part));
+            ++next_written;
+            --in_flight;
+            space.notify_all();
+        }
+    }
+
+    /// @brief calls f, which writes to the stream, on the writing thread
+    /// @return whether the stream is still good; otherwise the exception or
+    /// errno is kept for @see finish
+    template <typename Function>
+    bool write_to_stream(Function f) {
+        try {
+            errno = 0;
+            f();
+            if (!*ostream) {
+                error_number = errno;
+                return false;
+            }
+            return true;
+        } catch (...) {
+            error = std::current_exception();
+            return false;
+        }
+    }
+
+    void stop(bool drain) {
+        if (!writer.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard lock{mutex};
+            stopping = true;
+            this->drain = drain;
+        }
+        ready.notify_one();
+        writer.join();
+    }
+};
+
+/// @brief number of parts in flight for thread_count producing threads: one
+/// being written and up to two per thread, so that no thread waits for the
+/// stream as long as it keeps up
+inline std::size_t pipeline_capacity(unsigned int thread_count) {
+    return 2 * std::size_t{thread_count} + 1;
+}
+
+/// @brief format for the parts of a table: without prefix and suffix, which
+/// are written separately
+inline TextFormat part_format(TextFormat format) {
+    format.prefix.clear();
+    format.suffix.clear();
+    return format;
+}
+
+}  // namespace detail
+
+/// @brief writes a table in a @see TextFormat to a std::ostream, formatting
+/// on several threads while a thread of its own writes the stream
+/// @details the rows of every call of @see write_rows are split into parts
+/// that thread_count threads format into their own buffers; the parts are
+/// written in order (@see detail::OrderedOutput) as soon as they are
+/// complete. write_rows returns once all its rows are formatted, so the
+/// table can be reused for the next chunk (e.g. by @see generate_stream)
+/// while the stream is still being written. The output is the same as that
+/// of a @see TableWriter, or compressed block by block (@see Compression).
+/// @tparam T type of the generated data, or @see ColumnTable
+template <typename T>
+class PipelineTableWriter {
+   public:
+    using Table = typename detail::TextTable<T>::Table;
+
+    /// @brief writes the prefix of the format
+    /// @param o optional function that formats a single value (not for
+    /// @see ColumnTable)
+    /// @param compression compression of the parts, on the formatting threads
+    /// @throws std::invalid_argument if the compression isn't available
+    PipelineTableWriter(std::ostream& ostream, TextFormat format,
+                        unsigned int thread_count = 1, OutputFunction<T> o = {},
+                        Compression compression = Compression::none)
+        : format{std::move(format)},
+          part_format{detail::part_format(this->format)},
+          thread_count{thread_count},
+          o{std::move(o)},
+          output{ostream, detail::pipeline_capacity(thread_count), compression} {
+        assert(thread_count > 0);
+        output.write(this->format.prefix);
+    }
+
+    /// @brief writes the first rows rows of data
+    void write_rows(const Table& data, std::uint64_t rows) {
+        assert(rows <= data.row_count);
+        if (rows == 0) {
+            return;
+        }
+        std::uint64_t part_rows = std::clamp<std::uint64_t>(
+            (rows + thread_count - 1) / thread_count, min_part_rows, max_part_rows);
+        std::uint64_t part_count = (rows + part_rows - 1) / part_rows;
+        std::uint64_t first = output.next();
+        auto threads = static_cast<unsigned int>(
+            std::min<std::uint64_t>(thread_count, part_count));
+        detail::run_parallel(threads, [&](unsigned int) {
+            try {
+                detail::PartFormatter<T> formatter{part_format, o};
+                while (auto part = output.acquire(first + part_count)) {
+                    std::uint64_t begin = (part->sequence - first) * part_rows;
+                    std::uint64_t end = std::min(begin + part_rows, rows);
+                    formatter.format(data, begin, end, rows_written + begin, part->text);
+                    output.submit(std::move(*part));
+                }
+            } catch (...) {
+                output.cancel();
+                throw;
+            }
+        });
+        if (output.failed()) {
+            // throws the error, so that the caller stops producing rows
+            output.finish();
+        }
+        rows_written += rows;
+    }
+
+    /// @brief writes all rows of data
+    void write_rows(const Table& data) { write_rows(data, data.row_count); }
+
+    /// @brief continue with row number row of the table (for writing only a
+    /// part of a table), i.e. as if row rows had been written already
+    void resume_at(std::uint64_t row) { rows_written = row; }
+
+    /// @brief writes the suffix of the format and waits until everything has
+    /// been written; call after the last row
+    /// @throws std::runtime_error if writing failed
+    void finish() {
+        output.write(format.suffix);
+        output.finish();
+    }
+
+   private:
+    /// parts with fewer rows aren't worth a thread
+    static constexpr unsigned int min_part_rows = 1024;
+
+    /// bounds the memory for the formatted rows
+    static constexpr unsigned int max_part_rows = 1 << 16;
+
+    TextFormat format;
+    TextFormat part_format;
+    unsigned int thread_count;
+    OutputFunction<T> o;
+    /// number of rows written so far
+    std::uint64_t rows_written = 0;
+    detail::OrderedOutput output;
+};
+
+namespace detail {
+
+/// @brief splits rows along the blocks of rows_per_block rows (@see
+/// block_rows), so that every part is generated from a single random stream
+class BlockParts {
+   public:
+    BlockParts(RowRange rows, std::uint64_t rows_per_block)
+        : rows{rows},
+          rows_per_block{rows_per_block},
+          first_block{rows.first_row / rows_per_block} {
+        assert(rows.row_count > 0);
+    }
+
+    std::uint64_t count() const {
+        return (rows.first_row + rows.row_count - 1) / rows_per_block - first_block + 1;
+    }
+
+    /// @brief the rows of part i
+    RowRange operator[](std::uint64_t i) const {
+        std::uint64_t begin = std::max(rows.first_row, (first_block + i) * rows_per_block);
+        std::uint64_t end = std::min(rows.first_row + rows.row_count,
+                                     (first_block + i + 1) * rows_per_block);
+        return {begin, end - begin};
+    }
+
+   private:
+    RowRange rows;
+    std::uint64_t rows_per_block;
+    std::uint64_t first_block;
+};
+
+}  // namespace detail
+
+/// @brief generates a table and writes it in a @see TextFormat to ostream,
+/// with generation, formatting and writing overlapping
+/// @details thread_count threads take one block (@see block_rows) after the
+/// other, generate it into a buffer of their own and format it; a thread of
+/// its own writes the formatted blocks in order while the next ones are being
+/// generated (@see detail::OrderedOutput). At most
+/// 2 * thread_count + 1 formatted blocks are held at a time, so memory usage
+/// doesn't depend on sample_count. The output is the same as writing the
+/// result of @see generate_data with a @see TableWriter, or compressed block
+/// by block (@see Compression).
+/// @tparam RandomEngine see @see generate_data
+/// @param o optional function that formats a single value
+/// @param compression compression of the blocks, on the generating threads
+/// @throws std::runtime_error if writing failed, std::invalid_argument if the
+/// compression isn't available
+template <typename RandomEngine = std::mt19937, typename RandomNumberDistribution>
+void generate_text(
+    std::uint64_t sample_count, std::uint64_t col_count,
+    RandomNumberDistribution&& random, std::ostream& ostream,
+    const TextFormat& format,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    unsigned int thread_count = 1,
+    OutputFunction<typename std::remove_cvref_t<RandomNumberDistribution>::result_type> o = {},
+    Compression compression = Compression::none) {
+    generate_text<RandomEngine>(RowRange{0, sample_count}, col_count,
+                                std::forward<RandomNumberDistribution>(random), ostream,
+                                format, seed, thread_count, std::move(o), compression);
+}
+
+/// @brief generates only the given rows of a table and writes them as a
+/// table of their own in a @see TextFormat, like @see generate_text
+/// @details the values equal these rows of @see generate_data with the same
+/// seed (e.g. for a shard, @see shard_rows)
+template <typename RandomEngine = std::mt19937, typename RandomNumberDistribution>
+void generate_text(
+    RowRange rows, std::uint64_t col_count, RandomNumberDistribution&& random,
+    std::ostream& ostream, const TextFormat& format,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    unsigned int thread_count = 1,
+    OutputFunction<typename std::remove_cvref_t<RandomNumberDistribution>::result_type> o = {},
+    Compression compression = Compression::none) {
+    assert(rows.row_count > 0);
+    assert(col_count > 0);
+    assert(thread_count > 0);
+    using Distribution = std::remove_cvref_t<RandomNumberDistribution>;
+    using T = typename Distribution::result_type;
+    const std::uint64_t part_rows = block_rows(col_count);
+    const detail::BlockParts parts{rows, part_rows};
+    const std::uint64_t part_count = parts.count();
+    const TextFormat part_format = detail::part_format(format);
+
+    detail::OrderedOutput output{ostream, detail::pipeline_capacity(thread_count),
+                                 compression};
+    output.write(format.prefix);
+    const std::uint64_t first = output.next();
+    auto threads = static_cast<unsigned int>(
+        std::min<std::uint64_t>(thread_count, part_count));
+    detail::run_parallel(threads, [&](unsigned int) {
+        try {
+            Data<T> buffer{std::min(rows.row_count, part_rows), col_count, for_overwrite};
+            detail::PartFormatter<T> formatter{part_format, o};
+            while (auto part = output.acquire(first + part_count)) {
+                RowRange block = parts[part->sequence - first];
+                detail::RowGenerator<Distribution, RandomEngine> generator{
+                    random, seed, col_count, block.first_row};
+                generator.fill(buffer, 0, block.row_count);
+                formatter.format(buffer, 0, block.row_count,
+                                 block.first_row - rows.first_row, part->text);
+                output.submit(std::move(*part));
+            }
+        } catch (...) {
+            output.cancel();
+            throw;
+        }
+    });
+    output.write(format.suffix);
+    output.finish();
+}
+
+/// @brief generates a table whose columns have their own type and
+/// distribution and writes it in a @see TextFormat to ostream, like
+/// @see generate_text
+/// @details the threads work on the blocks of the columns, i.e. on
+/// block_rows(1) rows at a time. The output is the same as writing the result
+/// of @see generate_table with a @see ColumnTableWriter.
+/// @throws std::runtime_error if writing failed, std::invalid_argument if the
+/// compression isn't available
+template <typename RandomEngine = std::mt19937>
+void generate_table_text(
+    std::uint64_t sample_count, const Schema& schema, std::ostream& ostream,
+    const TextFormat& format,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    unsigned int thread_count = 1, Compression compression = Compression::none) {
+    generate_table_text<RandomEngine>(RowRange{0, sample_count}, schema, ostream, format,
+                                      seed, thread_count, compression);
+}
+
+/// @brief generates only the given rows of a table whose columns have their
+/// own type and distribution and writes them as a table of their own, like
+/// @see generate_text
+template <typename RandomEngine = std::mt19937>
+void generate_table_text(
+    RowRange rows, const Schema& schema, std::ostream& ostream,
+    const TextFormat& format,
+    typename std::random_device::result_type seed = std::random_device{}(),
+    unsigned int thread_count = 1, Compression compression = Compression::none) {
+    assert(rows.row_count > 0);
+    assert(thread_count > 0);
+    const std::uint64_t part_rows = block_rows(1);
+    const detail::BlockParts parts{rows, part_rows};
+    const std::uint64_t part_count = parts.count();
+    const TextFormat part_format = detail::part_format(format);
+
+    detail::OrderedOutput output{ostream, detail::pipeline_capacity(thread_count),
+                                 compression};
+    output.write(format.prefix);
+    const std::uint64_t first = output.next();
+    auto threads = static_cast<unsigned int>(
+        std::min<std::uint64_t>(thread_count, part_count));
+    detail::run_parallel(threads, [&](unsigned int) {
+        try {
+            ColumnTable buffer{std::min(rows.row_count, part_rows), schema, for_overwrite};
+            detail::PartFormatter<ColumnTable> formatter{part_format, {}};
+            while (auto part = output.acquire(first + part_count)) {
+                RowRange block = parts[part->sequence - first];
+                detail::fill_columns<RandomEngine>(buffer, block.first_row,
+                                                   block.row_count, schema, seed, 1);
+                formatter.format(buffer, 0, block.row_count,
+                                 block.first_row - rows.first_row, part->text);
+                output.submit(std::move(*part));
+            }
+        } catch (...) {
+            output.cancel();
+            throw;
+        }
+    });
+    output.write(format.suffix);
+    output.finish();
+}
+
+}  // namespace datagen
+
+#endif
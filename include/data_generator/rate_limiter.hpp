@@ -0,0 +1,101 @@
+#ifndef __DATAGEN_RATE_LIMITER_HPP__
+#define __DATAGEN_RATE_LIMITER_HPP__
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+namespace datagen {
+
+/// @brief paces a stream of rows, batch by batch, to a target rate
+/// @details every batch has an absolute deadline: a batch may start once the
+/// rows before it are due at rows_per_second since the first batch, so the
+/// rate doesn't drift with the time that generating and writing take, and a
+/// single sleep per batch keeps the overhead independent of the rate (see
+/// @see batch_rows). If the consumer falls behind the schedule by more than
+/// max_lag (backpressure, e.g. a full pipe), the schedule starts over at the
+/// current time instead of catching up with a burst.
+/// ```
+/// RateLimiter limiter{50000.0};
+/// generate_stream(rows, cols, random, [&](const auto& chunk, std::uint64_t count) {
+///     limiter.wait(count);
+///     writer.write_rows(chunk, count);
+/// }, seed, limiter.batch_rows(block_rows(cols)));
+/// ```
+class RateLimiter {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    /// @param rows_per_second target rate; 0 for no limit
+    /// @param max_lag how far the consumer may fall behind before the
+    /// schedule starts over
+    explicit RateLimiter(double rows_per_second,
+                         Clock::duration max_lag = std::chrono::seconds{1})
+        : rate{rows_per_second}, max_lag{max_lag} {
+        assert(rows_per_second >= 0.0);
+    }
+
+    double rows_per_second() const { return rate; }
+
+    /// @brief rows per batch such that a batch lasts about interval at the
+    /// target rate, between 1 and max_rows; max_rows without a limit
+    std::uint64_t batch_rows(std::uint64_t max_rows,
+                             Clock::duration interval = std::chrono::milliseconds{10}) const {
+        assert(max_rows > 0);
+        if (rate == 0.0) {
+            return max_rows;
+        }
+        double rows = std::ceil(rate * std::chrono::duration<double>(interval).count());
+        return std::clamp<std::uint64_t>(static_cast<std::uint64_t>(std::min(rows, 1e18)), 1,
+                                         max_rows);
+    }
+
+    /// @brief waits until the next rows rows are due; the first batch is due
+    /// at once
+    void wait(std::uint64_t rows) {
+        if (rate == 0.0) {
+            return;
+        }
+        Clock::time_point now = Clock::now();
+        Clock::time_point due = schedule(rows, now);
+        if (now < due) {
+            std::this_thread::sleep_until(due);
+        }
+    }
+
+    /// @brief hands out the next rows rows at now and returns when they are
+    /// due (now or earlier if they are overdue); @see wait without the
+    /// waiting
+    Clock::time_point schedule(std::uint64_t rows, Clock::time_point now) {
+        if (rate == 0.0) {
+            return now;
+        }
+        if (scheduled == 0) {
+            start = now;
+        }
+        auto due = start + std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double>(static_cast<double>(scheduled) / rate));
+        if (now - due > max_lag) {
+            start = now;
+            scheduled = 0;
+            due = now;
+        }
+        scheduled += rows;
+        return due;
+    }
+
+   private:
+    double rate;
+    Clock::duration max_lag;
+    /// when the schedule started
+    Clock::time_point start;
+    /// rows handed out since start
+    std::uint64_t scheduled = 0;
+};
+
+}  // namespace datagen
+
+#endif
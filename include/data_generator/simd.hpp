@@ -0,0 +1,313 @@
+#ifndef __DATAGEN_SIMD_HPP__
+#define __DATAGEN_SIMD_HPP__
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define DATAGEN_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define DATAGEN_X86_SIMD 0
+#endif
+
+namespace datagen {
+
+/// @brief instruction sets the batch kernels of the distributions can use
+/// @details all of them produce bit-identical results, they only differ in
+/// speed
+enum class InstructionSet { scalar, avx2, avx512 };
+
+namespace detail {
+
+/// @brief constants of the Philox4x32-10 random engine
+inline constexpr std::uint32_t philox_multiplier0 = 0xD2511F53;
+inline constexpr std::uint32_t philox_multiplier1 = 0xCD9E8D57;
+inline constexpr std::uint32_t philox_weyl0 = 0x9E3779B9;
+inline constexpr std::uint32_t philox_weyl1 = 0xBB67AE85;
+
+namespace simd {
+
+/// @brief coefficients of the Taylor series of sin(x) / x and cos(x) in x^2
+/// and of log(x) = 2 atanh(s) = 2 s (1 + s^2 / 3 + s^4 / 5 + ...)
+/// @details the kernels only use +, *, /, sqrt and fma, which are exactly
+/// rounded, so every instruction set computes the same bits
+inline constexpr auto sin_coefficients = [] {
+    std::array<double, 12> c{};
+    double factorial = 1.0;
+    for (std::size_t k = 0; k < c.size(); ++k) {
+        c[k] = (k % 2 == 0 ? 1.0 : -1.0) / factorial;
+        factorial *= static_cast<double>((2 * k + 2) * (2 * k + 3));
+    }
+    return c;
+}();
+
+inline constexpr auto cos_coefficients = [] {
+    std::array<double, 13> c{};
+    double factorial = 1.0;
+    for (std::size_t k = 0; k < c.size(); ++k) {
+        c[k] = (k % 2 == 0 ? 1.0 : -1.0) / factorial;
+        factorial *= static_cast<double>((2 * k + 1) * (2 * k + 2));
+    }
+    return c;
+}();
+
+inline constexpr auto log_coefficients = [] {
+    std::array<double, 11> c{};
+    for (std::size_t k = 0; k < c.size(); ++k) {
+        c[k] = 1.0 / static_cast<double>(2 * k + 1);
+    }
+    return c;
+}();
+
+inline constexpr double half_pi = 1.57079632679489661923;
+inline constexpr double ln2 = 0.693147180559945309417;
+inline constexpr double sqrt2 = 1.41421356237309504880;
+
+/// @brief vector operations on 64 bit lanes; the kernels in
+/// simd_kernels.inl are written against this interface and compiled once
+/// per instruction set
+namespace scalar {
+
+struct Ops {
+    using U = std::uint64_t;
+    using D = double;
+    using M = bool;
+    static constexpr std::size_t lanes = 1;
+
+    static U load(const std::uint64_t* p) { return *p; }
+    static U load32(const std::uint32_t* p) { return *p; }
+    static void store(std::uint64_t* p, U v) { *p = v; }
+    static void store32(std::uint32_t* p, U v) {
+        *p = static_cast<std::uint32_t>(v);
+    }
+    static U set1(std::uint64_t v) { return v; }
+    static U add(U a, U b) { return a + b; }
+    static U bit_and(U a, U b) { return a & b; }
+    static U bit_or(U a, U b) { return a | b; }
+    static U bit_xor(U a, U b) { return a ^ b; }
+    template <int bits>
+    static U shr(U v) { return v >> bits; }
+    template <int bits>
+    static U shl(U v) { return v << bits; }
+    static U mul32(U a, U b) { return (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF); }
+    static M less(U a, U b) { return a < b; }
+    static M equal(U a, U b) { return a == b; }
+    static U select(M m, U a, U b) { return m ? a : b; }
+    static unsigned int bits(M m) { return m ? 1u : 0u; }
+
+    static D as_double(U v) { return std::bit_cast<double>(v); }
+    static U as_u64(D v) { return std::bit_cast<std::uint64_t>(v); }
+    static D set1d(double v) { return v; }
+    static D add(D a, D b) { return a + b; }
+    static D sub(D a, D b) { return a - b; }
+    static D mul(D a, D b) { return a * b; }
+    static D div(D a, D b) { return a / b; }
+    static D fma(D a, D b, D c) { return std::fma(a, b, c); }
+    static D sqrt(D v) { return std::sqrt(v); }
+    static M greater(D a, D b) { return a > b; }
+    static D select(M m, D a, D b) { return m ? a : b; }
+    static void store(double* p, D v) { *p = v; }
+};
+
+#include "simd_kernels.inl"
+
+}  // namespace scalar
+
+#if DATAGEN_X86_SIMD
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+namespace avx2 {
+
+struct Ops {
+    using U = __m256i;
+    using D = __m256d;
+    using M = __m256i;
+    static constexpr std::size_t lanes = 4;
+
+    static U load(const std::uint64_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    static U load32(const std::uint32_t* p) {
+        return _mm256_cvtepu32_epi64(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    }
+    static void store(std::uint64_t* p, U v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+    }
+    static void store32(std::uint32_t* p, U v) {
+        __m256i low = _mm256_permutevar8x32_epi32(
+            v, _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+                         _mm256_castsi256_si128(low));
+    }
+    static U set1(std::uint64_t v) {
+        return _mm256_set1_epi64x(static_cast<long long>(v));
+    }
+    static U add(U a, U b) { return _mm256_add_epi64(a, b); }
+    static U bit_and(U a, U b) { return _mm256_and_si256(a, b); }
+    static U bit_or(U a, U b) { return _mm256_or_si256(a, b); }
+    static U bit_xor(U a, U b) { return _mm256_xor_si256(a, b); }
+    template <int bits>
+    static U shr(U v) { return _mm256_srli_epi64(v, bits); }
+    template <int bits>
+    static U shl(U v) { return _mm256_slli_epi64(v, bits); }
+    static U mul32(U a, U b) { return _mm256_mul_epu32(a, b); }
+    // the kernels only compare values below 2^63, so signed comparison works
+    static M less(U a, U b) { return _mm256_cmpgt_epi64(b, a); }
+    static M equal(U a, U b) { return _mm256_cmpeq_epi64(a, b); }
+    static U select(M m, U a, U b) { return _mm256_blendv_epi8(b, a, m); }
+    static unsigned int bits(M m) {
+        return static_cast<unsigned int>(
+            _mm256_movemask_pd(_mm256_castsi256_pd(m)));
+    }
+
+    static D as_double(U v) { return _mm256_castsi256_pd(v); }
+    static U as_u64(D v) { return _mm256_castpd_si256(v); }
+    static D set1d(double v) { return _mm256_set1_pd(v); }
+    static D add(D a, D b) { return _mm256_add_pd(a, b); }
+    static D sub(D a, D b) { return _mm256_sub_pd(a, b); }
+    static D mul(D a, D b) { return _mm256_mul_pd(a, b); }
+    static D div(D a, D b) { return _mm256_div_pd(a, b); }
+    static D fma(D a, D b, D c) { return _mm256_fmadd_pd(a, b, c); }
+    static D sqrt(D v) { return _mm256_sqrt_pd(v); }
+    static M greater(D a, D b) {
+        return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_GT_OQ));
+    }
+    static D select(M m, D a, D b) {
+        return _mm256_blendv_pd(b, a, _mm256_castsi256_pd(m));
+    }
+    static void store(double* p, D v) { _mm256_storeu_pd(p, v); }
+};
+
+#include "simd_kernels.inl"
+
+}  // namespace avx2
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+// gcc 12 reports the deliberately undefined vectors in avx512fintrin.h
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+namespace avx512 {
+
+struct Ops {
+    using U = __m512i;
+    using D = __m512d;
+    using M = __mmask8;
+    static constexpr std::size_t lanes = 8;
+
+    static U load(const std::uint64_t* p) { return _mm512_loadu_si512(p); }
+    static U load32(const std::uint32_t* p) {
+        return _mm512_cvtepu32_epi64(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+    }
+    static void store(std::uint64_t* p, U v) { _mm512_storeu_si512(p, v); }
+    static void store32(std::uint32_t* p, U v) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p),
+                            _mm512_cvtepi64_epi32(v));
+    }
+    static U set1(std::uint64_t v) {
+        return _mm512_set1_epi64(static_cast<long long>(v));
+    }
+    static U add(U a, U b) { return _mm512_add_epi64(a, b); }
+    static U bit_and(U a, U b) { return _mm512_and_si512(a, b); }
+    static U bit_or(U a, U b) { return _mm512_or_si512(a, b); }
+    static U bit_xor(U a, U b) { return _mm512_xor_si512(a, b); }
+    template <int bits>
+    static U shr(U v) { return _mm512_srli_epi64(v, bits); }
+    template <int bits>
+    static U shl(U v) { return _mm512_slli_epi64(v, bits); }
+    static U mul32(U a, U b) { return _mm512_mul_epu32(a, b); }
+    static M less(U a, U b) { return _mm512_cmplt_epu64_mask(a, b); }
+    static M equal(U a, U b) { return _mm512_cmpeq_epu64_mask(a, b); }
+    static U select(M m, U a, U b) { return _mm512_mask_blend_epi64(m, b, a); }
+    static unsigned int bits(M m) { return m; }
+
+    static D as_double(U v) { return _mm512_castsi512_pd(v); }
+    static U as_u64(D v) { return _mm512_castpd_si512(v); }
+    static D set1d(double v) { return _mm512_set1_pd(v); }
+    static D add(D a, D b) { return _mm512_add_pd(a, b); }
+    static D sub(D a, D b) { return _mm512_sub_pd(a, b); }
+    static D mul(D a, D b) { return _mm512_mul_pd(a, b); }
+    static D div(D a, D b) { return _mm512_div_pd(a, b); }
+    static D fma(D a, D b, D c) { return _mm512_fmadd_pd(a, b, c); }
+    static D sqrt(D v) { return _mm512_sqrt_pd(v); }
+    static M greater(D a, D b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+    static D select(M m, D a, D b) { return _mm512_mask_blend_pd(m, b, a); }
+    static void store(double* p, D v) { _mm512_storeu_pd(p, v); }
+};
+
+#include "simd_kernels.inl"
+
+}  // namespace avx512
+
+#pragma GCC diagnostic pop
+#pragma GCC pop_options
+
+#endif
+
+/// @brief the best instruction set the cpu supports
+inline InstructionSet detect_instruction_set() {
+#if DATAGEN_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return InstructionSet::avx512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return InstructionSet::avx2;
+    }
+#endif
+    return InstructionSet::scalar;
+}
+
+}  // namespace simd
+}  // namespace detail
+
+/// @brief instruction set used by the batch kernels
+/// @details detected once at startup; can be lowered (e.g. for testing),
+/// but must not be set to an instruction set the cpu doesn't support
+inline InstructionSet& instruction_set() {
+    static InstructionSet instruction_set = detail::simd::detect_instruction_set();
+    return instruction_set;
+}
+
+namespace detail::simd {
+
+/// @brief runs kernel with the kernels of the selected instruction set on as
+/// many values as possible and with the scalar kernels on the remainder
+/// @details kernel is called as kernel(Kernels{}, begin, end) and processes
+/// the values in [begin, end) with the static functions of Kernels
+template <typename Kernel>
+void dispatch(std::size_t n, Kernel&& kernel) {
+    std::size_t done = 0;
+#if DATAGEN_X86_SIMD
+    switch (instruction_set()) {
+        case InstructionSet::avx512:
+            done = n / avx512::Ops::lanes * avx512::Ops::lanes;
+            kernel(avx512::Kernels{}, std::size_t{0}, done);
+            break;
+        case InstructionSet::avx2:
+            done = n / avx2::Ops::lanes * avx2::Ops::lanes;
+            kernel(avx2::Kernels{}, std::size_t{0}, done);
+            break;
+        case InstructionSet::scalar:
+            break;
+    }
+#endif
+    kernel(scalar::Kernels{}, done, n);
+}
+
+}  // namespace detail::simd
+
+}  // namespace datagen
+
+#endif
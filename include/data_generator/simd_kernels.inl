@@ -0,0 +1,178 @@
+// batch kernels of the distributions; simd.hpp includes this file once per
+// instruction set, inside the namespace that defines the matching Ops, so
+// every instruction set runs exactly the same sequence of operations
+
+/// @brief kernels written against Ops; every function processes the values
+/// with index in [begin, end), end - begin must be a multiple of Ops::lanes
+struct Kernels {
+    using U = Ops::U;
+    using D = Ops::D;
+    using M = Ops::M;
+
+    /// @brief Philox4x32-10 blocks of the counters (0, cols[i], rows_low[i],
+    /// rows_high[i]); words0[i] and words1[i] receive the first and the
+    /// second half of the block, each as (first value) | (second value) << 32
+    static void philox(std::uint32_t key0, std::uint32_t key1,
+                       const std::uint32_t* cols, const std::uint32_t* rows_low,
+                       const std::uint32_t* rows_high, std::uint64_t* words0,
+                       std::uint64_t* words1, std::size_t begin,
+                       std::size_t end) {
+        const U low_mask = Ops::set1(0xFFFFFFFF);
+        const U multiplier0 = Ops::set1(philox_multiplier0);
+        const U multiplier1 = Ops::set1(philox_multiplier1);
+        for (std::size_t i = begin; i < end; i += Ops::lanes) {
+            U c0 = Ops::set1(0);
+            U c1 = Ops::load32(cols + i);
+            U c2 = Ops::load32(rows_low + i);
+            U c3 = Ops::load32(rows_high + i);
+            std::uint32_t k0 = key0;
+            std::uint32_t k1 = key1;
+            for (int round = 0; round < 10; ++round) {
+                if (round > 0) {
+                    k0 += philox_weyl0;
+                    k1 += philox_weyl1;
+                }
+                U product0 = Ops::mul32(multiplier0, c0);
+                U product1 = Ops::mul32(multiplier1, c2);
+                c0 = Ops::bit_xor(Ops::bit_xor(Ops::shr<32>(product1), c1),
+                                  Ops::set1(k0));
+                c1 = Ops::bit_and(product1, low_mask);
+                c2 = Ops::bit_xor(Ops::bit_xor(Ops::shr<32>(product0), c3),
+                                  Ops::set1(k1));
+                c3 = Ops::bit_and(product0, low_mask);
+            }
+            Ops::store(words0 + i, Ops::bit_or(c0, Ops::shl<32>(c1)));
+            Ops::store(words1 + i, Ops::bit_or(c2, Ops::shl<32>(c3)));
+        }
+    }
+
+    /// @brief values[i] = offset + floor(words[i] * range / 2^64) mod 2^32
+    /// (Lemire's multiply-shift without rejection); range <= 2^32
+    static void uniform(const std::uint64_t* words, std::uint32_t offset,
+                        std::uint64_t range, std::uint32_t* values,
+                        std::size_t begin, std::size_t end) {
+        const bool full_range = range == std::uint64_t{1} << 32;
+        const U range_vector = Ops::set1(range);
+        const U offset_vector = Ops::set1(offset);
+        for (std::size_t i = begin; i < end; i += Ops::lanes) {
+            U word = Ops::load(words + i);
+            U value = Ops::shr<32>(word);
+            if (!full_range) {
+                U high = Ops::mul32(value, range_vector);
+                U low = Ops::mul32(word, range_vector);
+                value = Ops::shr<32>(Ops::add(high, Ops::shr<32>(low)));
+            }
+            Ops::store32(values + i, Ops::add(value, offset_vector));
+        }
+    }
+
+    /// @brief values[i] = (lower 32 bits of words[i]) < threshold
+    static void bernoulli(const std::uint64_t* words, std::uint64_t threshold,
+                          bool* values, std::size_t begin, std::size_t end) {
+        const U low_mask = Ops::set1(0xFFFFFFFF);
+        const U threshold_vector = Ops::set1(threshold);
+        for (std::size_t i = begin; i < end; i += Ops::lanes) {
+            unsigned int bits = Ops::bits(Ops::less(
+                Ops::bit_and(Ops::load(words + i), low_mask), threshold_vector));
+            for (std::size_t lane = 0; lane < Ops::lanes; ++lane) {
+                values[i + lane] = ((bits >> lane) & 1u) != 0;
+            }
+        }
+    }
+
+    /// @brief like bernoulli, but sets bit i % 64 of bits[i / 64] instead of
+    /// values[i]; these bits must be 0 before, begin a multiple of Ops::lanes
+    static void bernoulli_bits(const std::uint64_t* words, std::uint64_t threshold,
+                               std::uint64_t* bits, std::size_t begin,
+                               std::size_t end) {
+        const U low_mask = Ops::set1(0xFFFFFFFF);
+        const U threshold_vector = Ops::set1(threshold);
+        for (std::size_t i = begin; i < end; i += Ops::lanes) {
+            unsigned int lane_bits = Ops::bits(Ops::less(
+                Ops::bit_and(Ops::load(words + i), low_mask), threshold_vector));
+            bits[i / 64] |= std::uint64_t{lane_bits} << (i % 64);
+        }
+    }
+
+    /// @brief Box-Muller transform of the uniform numbers in words0[i] and
+    /// words1[i]: values0[i] = mean + stddev * r cos(t) and values1[i] =
+    /// mean + stddev * r sin(t); values1 may be nullptr
+    static void normal(const std::uint64_t* words0, const std::uint64_t* words1,
+                       double mean, double stddev, double* values0,
+                       double* values1, std::size_t begin, std::size_t end) {
+        const U one = Ops::set1(1);
+        const D mean_vector = Ops::set1d(mean);
+        const D stddev_vector = Ops::set1d(stddev);
+        for (std::size_t i = begin; i < end; i += Ops::lanes) {
+            // u1 in (0, 1] from the upper 52 bits of words0
+            D u1 = Ops::sub(Ops::set1d(2.0),
+                            unit_interval(Ops::shr<12>(Ops::load(words0 + i))));
+            D r = Ops::sqrt(Ops::mul(Ops::set1d(-2.0), log(u1)));
+
+            // t = (quadrant + g) pi / 2 with the quadrant from the upper 2 bits
+            // of words1 and g in [0, 1) from the next 50 bits
+            U word1 = Ops::load(words1 + i);
+            U quadrant = Ops::shr<62>(word1);
+            D g = Ops::sub(unit_interval(Ops::shr<12>(Ops::shl<2>(word1))),
+                           Ops::set1d(1.0));
+            D a = Ops::mul(g, Ops::set1d(half_pi));
+            D a2 = Ops::mul(a, a);
+            D sin_a = Ops::mul(a, horner(a2, sin_coefficients));
+            D cos_a = horner(a2, cos_coefficients);
+
+            // rotate (cos a, sin a) by quadrant * 90 degrees
+            U odd = Ops::bit_and(quadrant, one);
+            M swap = Ops::equal(odd, one);
+            U cos_sign = Ops::shl<63>(Ops::bit_xor(Ops::shr<1>(quadrant), odd));
+            U sin_sign = Ops::shl<63>(Ops::shr<1>(quadrant));
+            D cos_t = Ops::as_double(Ops::bit_xor(
+                Ops::as_u64(Ops::select(swap, sin_a, cos_a)), cos_sign));
+            D sin_t = Ops::as_double(Ops::bit_xor(
+                Ops::as_u64(Ops::select(swap, cos_a, sin_a)), sin_sign));
+
+            Ops::store(values0 + i,
+                       Ops::fma(stddev_vector, Ops::mul(r, cos_t), mean_vector));
+            if (values1 != nullptr) {
+                Ops::store(values1 + i, Ops::fma(stddev_vector,
+                                                 Ops::mul(r, sin_t), mean_vector));
+            }
+        }
+    }
+
+   private:
+    /// @brief the double in [1, 2) with the given 52 mantissa bits
+    static D unit_interval(U mantissa) {
+        return Ops::as_double(
+            Ops::bit_or(mantissa, Ops::set1(0x3FF0000000000000)));
+    }
+
+    template <std::size_t n>
+    static D horner(D x, const std::array<double, n>& coefficients) {
+        D result = Ops::set1d(coefficients[n - 1]);
+        for (std::size_t k = n - 1; k > 0; --k) {
+            result = Ops::fma(result, x, Ops::set1d(coefficients[k - 1]));
+        }
+        return result;
+    }
+
+    /// @brief natural logarithm of a positive normal double
+    static D log(D x) {
+        // x = m 2^e with m in [sqrt(2) / 2, sqrt(2))
+        U bits = Ops::as_u64(x);
+        U exponent = Ops::shr<52>(bits);
+        D m = unit_interval(Ops::bit_and(bits, Ops::set1(0x000FFFFFFFFFFFFF)));
+        M large = Ops::greater(m, Ops::set1d(sqrt2));
+        m = Ops::select(large, Ops::mul(m, Ops::set1d(0.5)), m);
+        exponent = Ops::select(large, Ops::add(exponent, Ops::set1(1)), exponent);
+        // 2^52 + exponent as double minus the bias gives e exactly
+        D e = Ops::sub(
+            Ops::as_double(Ops::bit_or(exponent, Ops::set1(0x4330000000000000))),
+            Ops::set1d(4503599627370496.0 + 1023.0));
+
+        // log(m) = 2 atanh(s) with s = (m - 1) / (m + 1)
+        D f = Ops::sub(m, Ops::set1d(1.0));
+        D s = Ops::div(f, Ops::add(Ops::set1d(2.0), f));
+        return Ops::fma(Ops::add(s, s), horner(Ops::mul(s, s), log_coefficients),
+                        Ops::mul(e, Ops::set1d(ln2)));
+    }
+};
@@ -0,0 +1,198 @@
+#ifndef __DATAGEN_SQLITE_WRITER_HPP__
+#define __DATAGEN_SQLITE_WRITER_HPP__
+
+#include <sqlite3.h>
+
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "data_generator.hpp"
+
+namespace datagen {
+
+/// @brief loads a table into an SQLite database file (needs libsqlite3)
+/// @details the table is created if it doesn't exist yet, with the columns
+/// c0, c1, ... (or the names of a @see ColumnTable), and the rows are
+/// inserted with a single prepared statement. Every batch_rows rows the
+/// transaction is committed and a new one is started. The connection runs
+/// with synchronous = OFF, so a crash of the operating system during the load
+/// can corrupt the file; that's the usual trade-off for loading fixtures.
+/// For @see Stats, binding and inserting the rows count as format and the
+/// commits, which write the pages to the file, as write.
+class SqliteWriter {
+   public:
+    /// @brief opens (or creates) the database file at path
+    /// @param batch_rows rows per transaction
+    /// @throws std::runtime_error if the database can't be opened, e.g. if
+    /// path isn't a database
+    SqliteWriter(const std::string& path, std::string tablename,
+                 unsigned int batch_rows = 100000)
+        : tablename{std::move(tablename)}, batch_rows{batch_rows} {
+        assert(batch_rows > 0);
+        int result = sqlite3_open(path.c_str(), &db);
+        if (result != SQLITE_OK) {
+            std::string message = db != nullptr ? sqlite3_errmsg(db) : "out of memory";
+            sqlite3_close(db);
+            throw std::runtime_error{"sqlite: can't open " + path + ": " + message};
+        }
+        try {
+            exec("PRAGMA synchronous = OFF");
+            exec("PRAGMA journal_mode = MEMORY");
+        } catch (...) {
+            // the destructor doesn't run
+            sqlite3_close(db);
+            throw;
+        }
+    }
+
+    SqliteWriter(const SqliteWriter&) = delete;
+    SqliteWriter& operator=(const SqliteWriter&) = delete;
+
+    /// @brief closes the database; rows that weren't committed by @see finish
+    /// are rolled back
+    ~SqliteWriter() {
+        sqlite3_finalize(insert);
+        sqlite3_close(db);
+    }
+
+    /// @brief inserts the first rows rows of data
+    template <typename T, DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data, std::uint64_t rows) {
+        assert(rows <= data.row_count);
+        DATAGEN_STATS_PHASE(Phase::format);
+        if (insert == nullptr) {
+            std::vector<std::pair<std::string, std::string>> columns;
+            for (std::uint64_t col = 0; col < data.col_count; ++col) {
+                columns.emplace_back(detail::column_name(col), sql_type<T>());
+            }
+            prepare(columns);
+        }
+        for (std::uint64_t row = 0; row < rows; ++row) {
+            for (std::uint64_t col = 0; col < data.col_count; ++col) {
+                bind(static_cast<int>(col) + 1, data[row][col]);
+            }
+            insert_row();
+        }
+    }
+
+    /// @brief inserts all rows of data
+    template <typename T, DataLayout Layout>
+    void write_rows(const Data<T, Layout>& data) {
+        write_rows(data, data.row_count);
+    }
+
+    /// @brief inserts the first rows rows of table
+    void write_rows(const ColumnTable& table, std::uint64_t rows) {
+        assert(rows <= table.row_count);
+        DATAGEN_STATS_PHASE(Phase::format);
+        if (insert == nullptr) {
+            std::vector<std::pair<std::string, std::string>> columns;
+            for (std::uint64_t col = 0; col < table.col_count; ++col) {
+                std::visit(
+                    [&](const auto& column) {
+                        using T = std::remove_cvref_t<decltype(column[0][0])>;
+                        columns.emplace_back(table.name(col), sql_type<T>());
+                    },
+                    table.column(col));
+            }
+            prepare(columns);
+        }
+        for (std::uint64_t row = 0; row < rows; ++row) {
+            for (std::uint64_t col = 0; col < table.col_count; ++col) {
+                std::visit(
+                    [&](const auto& column) {
+                        bind(static_cast<int>(col) + 1, column[row][0]);
+                    },
+                    table.column(col));
+            }
+            insert_row();
+        }
+    }
+
+    /// @brief inserts all rows of table
+    void write_rows(const ColumnTable& table) {
+        write_rows(table, table.row_count);
+    }
+
+    /// @brief commits the last transaction; call after the last row
+    void finish() {
+        if (insert != nullptr) {
+            DATAGEN_STATS_PHASE(Phase::write);
+            exec("COMMIT");
+        }
+    }
+
+   private:
+    sqlite3* db = nullptr;
+    sqlite3_stmt* insert = nullptr;
+    std::string tablename;
+    std::uint64_t batch_rows;
+    std::uint64_t rows_in_transaction = 0;
+
+    template <typename T>
+    static const char* sql_type() {
+        if constexpr (std::is_same_v<T, bool>) {
+            return "BOOLEAN";
+        } else if constexpr (std::is_integral_v<T>) {
+            return "INTEGER";
+        } else {
+            static_assert(std::is_floating_point_v<T>, "no sqlite type for T");
+            return "REAL";
+        }
+    }
+
+    void check(int result, int expected = SQLITE_OK) {
+        if (result != expected) {
+            throw std::runtime_error{std::string{"sqlite: "} + sqlite3_errmsg(db)};
+        }
+    }
+
+    void exec(const std::string& sql) {
+        check(sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr));
+    }
+
+
+    /// @brief creates the table (with the given (name, type) columns) and the
+    /// insert statement and starts the first transaction
+    void prepare(const std::vector<std::pair<std::string, std::string>>& columns) {
+        std::string create = "CREATE TABLE IF NOT EXISTS " + detail::quote_identifier(tablename) + " (";
+        std::string insert_sql = "INSERT INTO " + detail::quote_identifier(tablename) + " VALUES (";
+        for (std::size_t col = 0; col < columns.size(); ++col) {
+            create += (col == 0 ? "" : ", ") + detail::quote_identifier(columns[col].first) + " " + columns[col].second;
+            insert_sql += col == 0 ? "?" : ", ?";
+        }
+        exec(create + ")");
+        check(sqlite3_prepare_v2(db, (insert_sql + ")").c_str(), -1, &insert, nullptr));
+        exec("BEGIN");
+    }
+
+    template <typename T>
+    void bind(int index, T value) {
+        if constexpr (std::is_floating_point_v<T>) {
+            check(sqlite3_bind_double(insert, index, static_cast<double>(value)));
+        } else {
+            check(sqlite3_bind_int64(insert, index, static_cast<sqlite3_int64>(value)));
+        }
+    }
+
+    void insert_row() {
+        check(sqlite3_step(insert), SQLITE_DONE);
+        check(sqlite3_reset(insert));
+        if (++rows_in_transaction == batch_rows) {
+            DATAGEN_STATS_PHASE(Phase::write);
+            exec("COMMIT");
+            exec("BEGIN");
+            rows_in_transaction = 0;
+        }
+    }
+};
+
+}  // namespace datagen
+
+#endif
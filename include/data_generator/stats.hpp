@@ -0,0 +1,396 @@
+#ifndef __DATAGEN_STATS_HPP__
+#define __DATAGEN_STATS_HPP__
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace datagen {
+
+/// @brief whether this build records @see Stats; the instrumentation of the
+/// library is compiled in with DATAGEN_WITH_STATS and compiles to nothing
+/// without it
+inline constexpr bool stats_available() {
+#ifdef DATAGEN_WITH_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/// @brief the phases that @see Stats times
+enum class Phase {
+    /// random numbers and distributions (@see detail::RowGenerator)
+    generate,
+    /// text and binary formats
+    format,
+    /// @see Compression
+    compress,
+    /// the sink: the output stream (through a @see StatsBuffer) or the file
+    write
+};
+
+inline constexpr std::size_t phase_count = 4;
+
+inline const char* phase_name(Phase phase) {
+    static constexpr const char* names[phase_count] = {"generate", "format", "compress",
+                                                       "write"};
+    return names[static_cast<std::size_t>(phase)];
+}
+
+/// @brief time spent in a phase, summed over the threads
+struct PhaseReport {
+    double seconds = 0.0;
+    /// time stamp counter ticks; 0 where there is none
+    std::uint64_t cycles = 0;
+    /// number of times the phase was entered
+    std::uint64_t calls = 0;
+};
+
+/// @brief snapshot of a @see Stats
+struct StatsReport {
+    std::array<PhaseReport, phase_count> phases;
+    double wall_seconds = 0.0;
+    /// generated values
+    std::uint64_t cells = 0;
+    /// bytes written to the sink, after compression
+    std::uint64_t bytes_written = 0;
+    /// peak resident set size of the process
+    std::uint64_t peak_rss_bytes = 0;
+
+    const PhaseReport& operator[](Phase phase) const {
+        return phases[static_cast<std::size_t>(phase)];
+    }
+
+    double cells_per_second() const {
+        return wall_seconds > 0.0 ? static_cast<double>(cells) / wall_seconds : 0.0;
+    }
+
+    double bytes_per_second() const {
+        return wall_seconds > 0.0 ? static_cast<double>(bytes_written) / wall_seconds : 0.0;
+    }
+};
+
+/// @brief peak resident set size of the process in bytes
+inline std::uint64_t peak_rss_bytes() {
+    rusage usage{};
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    // kilobytes
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+/// @brief counters of the instrumented phases of generating and writing a
+/// table: time and cycles per @see Phase, generated cells and written bytes
+/// @details the library records into the Stats of a @see StatsScope, from
+/// every thread, e.g.
+/// ```
+/// Stats stats;
+/// {
+///     StatsScope scope{stats};
+///     generate_text(n, 4, NormalDistribution{0.0, 1.0}, std::cout, csv_format(), seed, 8);
+/// }
+/// write_stats(stats.report(), std::cerr);
+/// ```
+/// A phase is timed per thread and without the phases nested in it, e.g. a
+/// binary writer's format doesn't include its writes to the stream; waiting
+/// for other threads counts to the phase that waits. Without
+/// DATAGEN_WITH_STATS (@see stats_available) nothing is recorded. The macro
+/// changes the bodies of inline functions of the headers, so all translation
+/// units of a program have to agree on it; otherwise the linker may pick
+/// either version of a function (an ODR violation).
+class Stats {
+   public:
+    /// @brief starts the wall clock
+    Stats() : start{std::chrono::steady_clock::now()} {}
+
+    Stats(const Stats&) = delete;
+    Stats& operator=(const Stats&) = delete;
+
+    void record(Phase phase, std::chrono::steady_clock::duration time, std::uint64_t cycles) {
+        Counter& counter = counters[static_cast<std::size_t>(phase)];
+        counter.nanoseconds.fetch_add(
+            static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(time).count()),
+            std::memory_order_relaxed);
+        counter.cycles.fetch_add(cycles, std::memory_order_relaxed);
+    }
+
+    void enter(Phase phase) {
+        counters[static_cast<std::size_t>(phase)].calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void add_cells(std::uint64_t count) { cells.fetch_add(count, std::memory_order_relaxed); }
+
+    void add_bytes(std::uint64_t count) { bytes.fetch_add(count, std::memory_order_relaxed); }
+
+    /// @brief the counters so far, with the wall time since construction
+    StatsReport report() const {
+        StatsReport report;
+        for (std::size_t i = 0; i < phase_count; ++i) {
+            report.phases[i].seconds =
+                static_cast<double>(counters[i].nanoseconds.load(std::memory_order_relaxed)) /
+                1e9;
+            report.phases[i].cycles = counters[i].cycles.load(std::memory_order_relaxed);
+            report.phases[i].calls = counters[i].calls.load(std::memory_order_relaxed);
+        }
+        report.wall_seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        report.cells = cells.load(std::memory_order_relaxed);
+        report.bytes_written = bytes.load(std::memory_order_relaxed);
+        report.peak_rss_bytes = peak_rss_bytes();
+        return report;
+    }
+
+   private:
+    struct Counter {
+        std::atomic<std::uint64_t> nanoseconds{0};
+        std::atomic<std::uint64_t> cycles{0};
+        std::atomic<std::uint64_t> calls{0};
+    };
+
+    std::chrono::steady_clock::time_point start;
+    std::array<Counter, phase_count> counters;
+    std::atomic<std::uint64_t> cells{0};
+    std::atomic<std::uint64_t> bytes{0};
+};
+
+namespace detail {
+
+/// @brief the Stats that the library records into, if any
+inline std::atomic<Stats*> active_stats{nullptr};
+
+inline std::uint64_t read_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/// @brief times a phase until its destruction, without the phases nested in
+/// it on the same thread; a phase nested in itself (e.g. a @see TableWriter
+/// in a formatter of the pipeline) continues the outer one
+class PhaseTimer {
+   public:
+    explicit PhaseTimer(Phase phase)
+        : stats{active_stats.load(std::memory_order_relaxed)}, phase{phase} {
+        if (stats && current && current->phase == phase) {
+            stats = nullptr;
+        }
+        if (stats) {
+            stats->enter(phase);
+            outer = current;
+            current = this;
+            auto now = std::chrono::steady_clock::now();
+            std::uint64_t cycles = read_cycles();
+            if (outer) {
+                outer->pause(now, cycles);
+            }
+            resume(now, cycles);
+        }
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    ~PhaseTimer() {
+        if (stats) {
+            auto now = std::chrono::steady_clock::now();
+            std::uint64_t cycles = read_cycles();
+            pause(now, cycles);
+            current = outer;
+            if (outer) {
+                outer->resume(now, cycles);
+            }
+        }
+    }
+
+   private:
+    /// innermost timer of this thread
+    static inline thread_local PhaseTimer* current = nullptr;
+
+    Stats* stats;
+    Phase phase;
+    PhaseTimer* outer = nullptr;
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t start_cycles = 0;
+
+    void pause(std::chrono::steady_clock::time_point now, std::uint64_t cycles) {
+        stats->record(phase, now - start, cycles - start_cycles);
+    }
+
+    void resume(std::chrono::steady_clock::time_point now, std::uint64_t cycles) {
+        start = now;
+        start_cycles = cycles;
+    }
+};
+
+inline void count_cells(std::uint64_t count) {
+    if (Stats* stats = active_stats.load(std::memory_order_relaxed)) {
+        stats->add_cells(count);
+    }
+}
+
+inline void count_bytes(std::uint64_t count) {
+    if (Stats* stats = active_stats.load(std::memory_order_relaxed)) {
+        stats->add_bytes(count);
+    }
+}
+
+}  // namespace detail
+
+#ifdef DATAGEN_WITH_STATS
+/// @brief times the rest of the enclosing block as the given @see Phase
+#define DATAGEN_STATS_PHASE(phase) ::datagen::detail::PhaseTimer datagen_phase_timer_{phase}
+/// @brief counts generated cells for @see Stats
+#define DATAGEN_STATS_CELLS(count) ::datagen::detail::count_cells(count)
+/// @brief counts bytes written to the sink for @see Stats
+#define DATAGEN_STATS_BYTES(count) ::datagen::detail::count_bytes(count)
+#else
+#define DATAGEN_STATS_PHASE(phase) static_cast<void>(0)
+#define DATAGEN_STATS_CELLS(count) static_cast<void>(0)
+#define DATAGEN_STATS_BYTES(count) static_cast<void>(0)
+#endif
+
+/// @brief makes the library record into stats for the lifetime of the scope
+/// @details scopes can't overlap; the generation and output that stats should
+/// cover have to finish within the scope
+class StatsScope {
+   public:
+    explicit StatsScope(Stats& stats) {
+        [[maybe_unused]] Stats* previous = detail::active_stats.exchange(&stats);
+        assert(previous == nullptr);
+    }
+
+    StatsScope(const StatsScope&) = delete;
+    StatsScope& operator=(const StatsScope&) = delete;
+
+    ~StatsScope() { detail::active_stats.store(nullptr); }
+};
+
+/// @brief stream buffer that forwards everything to another stream buffer
+/// and times the forwarding as @see Phase::write, e.g. around std::cout
+/// @details the data is collected in a buffer of its own, so small writes
+/// aren't timed one by one
+class StatsBuffer : public std::streambuf {
+   public:
+    explicit StatsBuffer(std::streambuf& target, std::size_t buffer_size = std::size_t{1} << 16)
+        : target{&target}, buffer{new char[buffer_size]}, buffer_size{buffer_size} {
+        assert(buffer_size > 0);
+        setp(buffer.get(), buffer.get() + buffer_size);
+    }
+
+    /// @brief forwards what is left; call sync first to see whether it fails
+    ~StatsBuffer() override { sync(); }
+
+   protected:
+    int_type overflow(int_type c) override {
+        if (!flush()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* chars, std::streamsize count) override {
+        if (static_cast<std::size_t>(count) < static_cast<std::size_t>(epptr() - pptr())) {
+            std::copy_n(chars, count, pptr());
+            pbump(static_cast<int>(count));
+            return count;
+        }
+        // too large for the buffer
+        if (!flush() || !forward(chars, count)) {
+            return 0;
+        }
+        return count;
+    }
+
+    int sync() override {
+        if (!flush()) {
+            return -1;
+        }
+        DATAGEN_STATS_PHASE(Phase::write);
+        return target->pubsync();
+    }
+
+   private:
+    std::streambuf* target;
+    std::unique_ptr<char[]> buffer;
+    std::size_t buffer_size;
+
+    bool forward(const char* chars, std::streamsize count) {
+        DATAGEN_STATS_PHASE(Phase::write);
+        std::streamsize written = target->sputn(chars, count);
+        DATAGEN_STATS_BYTES(static_cast<std::uint64_t>(written));
+        return written == count;
+    }
+
+    /// @brief forwards the buffer
+    bool flush() {
+        std::streamsize count = pptr() - pbase();
+        setp(buffer.get(), buffer.get() + buffer_size);
+        return count == 0 || forward(buffer.get(), count);
+    }
+};
+
+/// @brief writes report to os as comment lines, or as a single line of JSON
+inline void write_stats(const StatsReport& report, std::ostream& os, bool json = false) {
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os.setf(std::ios_base::fixed, std::ios_base::floatfield);
+    os.precision(3);
+    if (json) {
+        os << "{\"wall_seconds\":" << report.wall_seconds << ",\"cells\":" << report.cells
+           << ",\"cells_per_second\":" << report.cells_per_second()
+           << ",\"bytes_written\":" << report.bytes_written
+           << ",\"bytes_per_second\":" << report.bytes_per_second()
+           << ",\"peak_rss_bytes\":" << report.peak_rss_bytes << ",\"phases\":{";
+        for (std::size_t i = 0; i < phase_count; ++i) {
+            const PhaseReport& phase = report.phases[i];
+            os << (i > 0 ? "," : "") << "\"" << phase_name(static_cast<Phase>(i))
+               << "\":{\"seconds\":" << phase.seconds << ",\"cycles\":" << phase.cycles
+               << ",\"calls\":" << phase.calls << "}";
+        }
+        os << "}}\n";
+    } else {
+        os << "# " << report.wall_seconds << " s, " << report.cells << " cells ("
+           << report.cells_per_second() / 1e6 << " M/s), " << report.bytes_written
+           << " bytes written (" << report.bytes_per_second() / 1e6 << " MB/s), peak RSS "
+           << static_cast<double>(report.peak_rss_bytes) / 1e6 << " MB\n";
+        for (std::size_t i = 0; i < phase_count; ++i) {
+            const PhaseReport& phase = report.phases[i];
+            os << "# " << phase_name(static_cast<Phase>(i)) << ": " << phase.seconds
+               << " s (all threads), " << phase.cycles << " cycles, " << phase.calls
+               << " calls\n";
+        }
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+}  // namespace datagen
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef __DATAGEN_VIRTUAL_DATA_HPP__
+#define __DATAGEN_VIRTUAL_DATA_HPP__
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "data_generator.hpp"
+
+namespace datagen {
+
+/// @brief table that is never generated as a whole: every row is computed
+/// from (seed, row) when it is accessed
+/// @details the values are those of @see generate_data with the same
+/// arguments, but memory usage doesn't depend on the size of the table, so
+/// tables with billions of rows work as inputs for tests or for algorithms
+/// that only touch a few rows, e.g.
+/// ```
+/// VirtualData<NormalDistribution, Philox4x32> data{1'000'000'000, 4,
+///                                                 NormalDistribution{0.0, 1.0}, seed};
+/// double x = data[123'456'789][2];
+/// ```
+/// The most recently used blocks of rows (@see block_rows) are cached, so
+/// reading neighbouring rows generates every block once. Without a cache
+/// (cache_blocks = 0) every access generates only its row, which is cheap
+/// for a @see CellSeekableEngine; other engines have to skip to the row
+/// within its block. Accessing rows modifies the cache, so threads need
+/// copies of their own (copies share the cached blocks, which never change).
+/// @tparam RandomNumberDistribution see @see generate_data
+/// @tparam RandomEngine see @see generate_data
+template <typename RandomNumberDistribution, typename RandomEngine = std::mt19937>
+class VirtualData {
+   public:
+    using T = typename RandomNumberDistribution::result_type;
+    struct ConstRowIterator;
+
+    /// @brief a computed row; owns its values (or shares them with the cache)
+    /// @details iterators into the row are valid as long as the view, but
+    /// unlike with @see Data, the rows of a VirtualData aren't contiguous
+    class RowView {
+       public:
+        using Iterator = typename Data<T>::Iterator;
+
+        RowView() = default;
+
+        /// @param rows generated rows that contain the row
+        /// @param row index of the row in rows
+        RowView(std::shared_ptr<const Data<T>> rows, std::uint64_t row)
+            : row{(*rows)[row]}, rows{std::move(rows)} {}
+
+        std::uint64_t size() const { return row.size(); }
+        T operator[](std::uint64_t pos) const { return row[pos]; }
+        Iterator begin() const { return row.begin(); }
+        Iterator end() const { return row.end(); }
+        T front() const { return row.front(); }
+        T back() const { return row.back(); }
+
+       private:
+        typename Data<T>::RowView row;
+        /// keeps the values of row alive
+        std::shared_ptr<const Data<T>> rows;
+    };
+
+    const std::uint64_t row_count;
+    const std::uint64_t col_count;
+
+    /// @param random see @see generate_data
+    /// @param seed see @see generate_data
+    /// @param cache_blocks number of blocks of rows that are kept
+    VirtualData(std::uint64_t row_count, std::uint64_t col_count,
+                RandomNumberDistribution random,
+                typename std::random_device::result_type seed = std::random_device{}(),
+                std::size_t cache_blocks = 4)
+        : row_count{row_count},
+          col_count{col_count},
+          random{std::move(random)},
+          seed{seed},
+          rows_per_block{block_rows(col_count)},
+          cache_blocks{cache_blocks} {
+        assert(row_count > 0);
+        assert(col_count > 0);
+        cache.reserve(cache_blocks);
+    }
+
+    ConstRowIterator begin() const { return ConstRowIterator{this, 0}; }
+
+    ConstRowIterator end() const { return ConstRowIterator{this, row_count}; }
+
+    std::uint64_t size() const { return row_count * col_count; }
+
+    /// @brief computes row pos, or takes it from the cache
+    RowView operator[](std::uint64_t pos) const {
+        assert(pos < row_count);
+        if (cache_blocks == 0) {
+            return RowView{generate(pos, 1), 0};
+        }
+        std::uint64_t block = pos / rows_per_block;
+        return RowView{cached_block(block), pos - block * rows_per_block};
+    }
+
+    RowView front() const { return (*this)[0]; }
+
+    RowView back() const { return (*this)[row_count - 1]; }
+
+    /// @brief iterator over the rows; moving it computes nothing, only
+    /// dereferencing it does (so it yields the rows by value)
+    struct ConstRowIterator {
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = RowView;
+        using reference = RowView;
+
+        ConstRowIterator() = default;
+        ConstRowIterator(const VirtualData* data, std::uint64_t row) : data{data}, row{row} {}
+
+        RowView operator*() const { return (*data)[row]; }
+        RowView operator[](difference_type n) const { return *(*this + n); }
+
+        ConstRowIterator& operator++() {
+            ++row;
+            return *this;
+        }
+        ConstRowIterator operator++(int) {
+            ConstRowIterator tmp = *this;
+            ++row;
+            return tmp;
+        }
+        ConstRowIterator& operator--() {
+            --row;
+            return *this;
+        }
+        ConstRowIterator operator--(int) {
+            ConstRowIterator tmp = *this;
+            --row;
+            return tmp;
+        }
+
+        ConstRowIterator& operator+=(difference_type n) {
+            row += static_cast<std::uint64_t>(n);
+            return *this;
+        }
+        ConstRowIterator& operator-=(difference_type n) {
+            row -= static_cast<std::uint64_t>(n);
+            return *this;
+        }
+        friend ConstRowIterator operator+(ConstRowIterator it, difference_type n) {
+            return it += n;
+        }
+        friend ConstRowIterator operator+(difference_type n, ConstRowIterator it) {
+            return it += n;
+        }
+        friend ConstRowIterator operator-(ConstRowIterator it, difference_type n) {
+            return it -= n;
+        }
+        friend difference_type operator-(const ConstRowIterator& a,
+                                         const ConstRowIterator& b) {
+            return static_cast<difference_type>(a.row - b.row);
+        }
+
+        bool operator==(const ConstRowIterator& other) const { return row == other.row; }
+        std::strong_ordering operator<=>(const ConstRowIterator& other) const {
+            return row <=> other.row;
+        }
+
+       private:
+        const VirtualData* data = nullptr;
+        std::uint64_t row = 0;
+    };
+
+   private:
+    /// @brief a cached block of rows
+    struct CachedBlock {
+        std::uint64_t block;
+        std::shared_ptr<const Data<T>> rows;
+    };
+
+    RandomNumberDistribution random;
+    typename std::random_device::result_type seed;
+    std::uint64_t rows_per_block;
+    std::size_t cache_blocks;
+    /// least recently used first
+    mutable std::vector<CachedBlock> cache;
+
+    /// @brief generates count rows starting at first_row
+    std::shared_ptr<const Data<T>> generate(std::uint64_t first_row, std::uint64_t count) const {
+        auto rows = std::make_shared<Data<T>>(count, col_count, for_overwrite);
+        detail::fill_rows<RandomEngine>(*rows, first_row, count, random, seed, 1);
+        return rows;
+    }
+
+    /// @brief the rows of block, from the cache if possible; the block
+    /// becomes the most recently used one
+    std::shared_ptr<const Data<T>> cached_block(std::uint64_t block) const {
+        auto it = std::find_if(cache.rbegin(), cache.rend(),
+                               [&](const CachedBlock& cached) { return cached.block == block; });
+        if (it != cache.rend()) {
+            std::rotate(std::prev(it.base()), it.base(), cache.end());
+            return cache.back().rows;
+        }
+        if (cache.size() == cache_blocks) {
+            cache.erase(cache.begin());
+        }
+        std::uint64_t first_row = block * rows_per_block;
+        cache.push_back({block, generate(first_row, std::min(rows_per_block, row_count - first_row))});
+        return cache.back().rows;
+    }
+};
+
+}  // namespace datagen
+
+#endif
@@ -0,0 +1,55 @@
+#include "data_generator/arena.hpp"
+#include "data_generator/data_generator.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+
+using namespace datagen;
+
+TEST_CASE("ArenaResource reuses its memory after reset", "[arena]") {
+    auto expected = generate_data(3000, 7, UniformIntDistribution<int>{}, 8, 2);
+    ArenaResource arena{1 << 16};
+    const int* first = nullptr;
+    for (int round = 0; round < 3; ++round) {
+        arena.reset();
+        auto data = generate_data(3000, 7, UniformIntDistribution<int>{}, 8, 2, &arena);
+        CHECK(std::equal(data.front().begin(), data.back().end(), expected.front().begin()));
+        if (round == 0) {
+            first = data.front().begin();
+        }
+        CHECK(data.front().begin() == first);
+        CHECK(reinterpret_cast<std::uintptr_t>(data.front().begin()) % 64 == 0);
+    }
+    CHECK(arena.mapped_bytes() >= 3000 * 7 * sizeof(int));
+}
+
+TEST_CASE("ArenaResource merges the mappings of a round", "[arena]") {
+    ArenaResource arena{1 << 12};
+    for (int round = 0; round < 3; ++round) {
+        arena.reset();
+        Data<double> a{100, 10, &arena};
+        Data<std::int8_t> b{10, 10, &arena};
+        Data<double> c{1000, 10, &arena};
+        a.set_value(99, 9, 1.5);
+        c.set_value(999, 9, 2.5);
+        CHECK(a[99][9] == 1.5);
+        CHECK(c[999][9] == 2.5);
+    }
+    // the rounds after the first fit into one mapping
+    std::size_t mapped = arena.mapped_bytes();
+    arena.reset();
+    Data<double> a{100, 10, &arena};
+    Data<std::int8_t> b{10, 10, &arena};
+    Data<double> c{1000, 10, &arena};
+    CHECK(arena.mapped_bytes() == mapped);
+}
+
+TEST_CASE("ArenaResource with transparent huge pages", "[arena]") {
+    ArenaResource arena{1 << 20, HugePages::transparent};
+    auto data = generate_data(1000, 4, NormalDistribution{}, 1, 1, &arena);
+    auto expected = generate_data(1000, 4, NormalDistribution{}, 1);
+    CHECK(std::equal(data.front().begin(), data.back().end(), expected.front().begin()));
+    CHECK(reinterpret_cast<std::uintptr_t>(data.front().begin()) % (2 << 20) == 0);
+    CHECK(arena.mapped_bytes() % (2 << 20) == 0);
+}
@@ -0,0 +1,246 @@
+#include "data_generator/binary_writer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+using namespace datagen;
+
+namespace {
+
+template <typename T>
+T read_at(const std::string& bytes, std::size_t offset) {
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+/// @brief reads the table at position of a FlatBuffers buffer in bytes
+struct FlatTable {
+    const std::string& bytes;
+    std::size_t position;
+
+    /// @brief position of field id, 0 if it isn't present
+    std::size_t field(std::uint16_t id) const {
+        std::size_t vtable = position - static_cast<std::size_t>(read_at<std::int32_t>(bytes, position));
+        auto vtable_size = read_at<std::uint16_t>(bytes, vtable);
+        if (4u + 2u * id >= vtable_size) {
+            return 0;
+        }
+        auto offset = read_at<std::uint16_t>(bytes, vtable + 4 + 2u * id);
+        return offset == 0 ? 0 : position + offset;
+    }
+
+    template <typename Scalar>
+    Scalar scalar(std::uint16_t id) const {
+        std::size_t at = field(id);
+        return at == 0 ? Scalar{0} : read_at<Scalar>(bytes, at);
+    }
+
+    /// @brief the position that the offset field id points to
+    std::size_t target(std::uint16_t id) const {
+        std::size_t at = field(id);
+        REQUIRE(at != 0);
+        return at + read_at<std::uint32_t>(bytes, at);
+    }
+
+    FlatTable table(std::uint16_t id) const { return {bytes, target(id)}; }
+
+    std::uint32_t length(std::uint16_t id) const { return read_at<std::uint32_t>(bytes, target(id)); }
+
+    /// @brief element i of the vector of tables id
+    FlatTable element(std::uint16_t id, std::uint32_t i) const {
+        std::size_t at = target(id) + 4 + 4 * std::size_t{i};
+        return {bytes, at + read_at<std::uint32_t>(bytes, at)};
+    }
+
+    /// @brief struct i of size struct_size of the vector id
+    std::size_t struct_at(std::uint16_t id, std::uint32_t i, std::size_t struct_size) const {
+        return target(id) + 4 + struct_size * i;
+    }
+
+    std::string string(std::uint16_t id) const {
+        std::size_t at = target(id);
+        return bytes.substr(at + 4, read_at<std::uint32_t>(bytes, at));
+    }
+};
+
+/// @brief an encapsulated Arrow IPC message at offset: (Message table, body
+/// offset, offset of the next message)
+std::tuple<FlatTable, std::size_t, std::size_t> read_message(const std::string& bytes,
+                                                             std::size_t offset) {
+    REQUIRE(read_at<std::uint32_t>(bytes, offset) == 0xFFFFFFFF);
+    auto metadata = static_cast<std::size_t>(read_at<std::int32_t>(bytes, offset + 4));
+    std::size_t root = offset + 8;
+    FlatTable message{bytes, root + read_at<std::uint32_t>(bytes, root)};
+    std::size_t body = root + metadata;
+    return {message, body, body + static_cast<std::size_t>(message.scalar<std::int64_t>(3))};
+}
+
+}  // namespace
+
+TEST_CASE("RawColumnWriter writes padded columns", "[binary]") {
+    Data<int> data{3, 2};
+    for (unsigned int row = 0; row < 3; ++row) {
+        data.set_value(row, 0, static_cast<int>(row));
+        data.set_value(row, 1, -static_cast<int>(row) - 10);
+    }
+
+    std::ostringstream out;
+    RawColumnWriter<int> writer{out, 2};
+    writer.write_rows(data);
+    writer.write_rows(data, 1);
+    writer.finish();
+    std::string bytes = out.str();
+
+    REQUIRE(bytes.size() == 24 + (8 + 2 * 16) + (8 + 2 * 8));
+    CHECK(bytes.substr(0, 8) == "DGCOLUMN");
+    CHECK(read_at<std::uint32_t>(bytes, 8) == 1);
+    CHECK(read_at<char>(bytes, 12) == 'i');
+    CHECK(read_at<std::uint8_t>(bytes, 13) == 4);
+    CHECK(read_at<std::uint64_t>(bytes, 16) == 2);
+
+    // first block: 3 rows, columns padded from 12 to 16 bytes
+    CHECK(read_at<std::uint64_t>(bytes, 24) == 3);
+    for (unsigned int row = 0; row < 3; ++row) {
+        CHECK(read_at<int>(bytes, 32 + 4 * row) == data[row][0]);
+        CHECK(read_at<int>(bytes, 48 + 4 * row) == data[row][1]);
+    }
+    CHECK(read_at<int>(bytes, 44) == 0);
+
+    // second block: 1 row
+    CHECK(read_at<std::uint64_t>(bytes, 64) == 1);
+    CHECK(read_at<int>(bytes, 72) == 0);
+    CHECK(read_at<int>(bytes, 80) == -10);
+}
+
+TEST_CASE("ArrowWriter writes the file layout", "[binary]") {
+    auto data = generate_data(100, 3, BernoulliDistribution{0.5}, 1);
+
+    std::ostringstream out;
+    ArrowWriter<bool> writer{out, 3};
+    writer.write_rows(data, 40);
+    writer.write_rows(data);
+    writer.finish();
+    std::string bytes = out.str();
+
+    CHECK(bytes.substr(0, 8) == std::string{"ARROW1\0\0", 8});
+    CHECK(bytes.substr(bytes.size() - 6) == "ARROW1");
+
+    // the schema message follows the magic
+    CHECK(read_at<std::uint32_t>(bytes, 8) == 0xFFFFFFFF);
+    CHECK(read_at<std::int32_t>(bytes, 12) % 8 == 0);
+
+    // end of stream marker right in front of the footer
+    auto footer_size = read_at<std::int32_t>(bytes, bytes.size() - 10);
+    std::size_t footer = bytes.size() - 10 - static_cast<std::size_t>(footer_size);
+    CHECK(footer % 8 == 0);
+    CHECK(read_at<std::uint32_t>(bytes, footer - 8) == 0xFFFFFFFF);
+    CHECK(read_at<std::int32_t>(bytes, footer - 4) == 0);
+}
+
+TEST_CASE("ArrowWriter writes the schema and the values", "[binary]") {
+    auto data = generate_data(100, 3, UniformIntDistribution{-1000, 1000}, 1);
+
+    std::ostringstream out;
+    ArrowWriter<int> writer{out, 3};
+    writer.write_rows(data, 40);
+    writer.write_rows(data);
+    writer.finish();
+    std::string bytes = out.str();
+
+    auto [schema_message, schema_body, next] = read_message(bytes, 8);
+    CHECK(schema_message.scalar<std::uint8_t>(1) == 1);  // Schema
+    CHECK(schema_body == next);
+    FlatTable schema = schema_message.table(2);
+    REQUIRE(schema.length(1) == 3);
+    for (std::uint32_t col = 0; col < 3; ++col) {
+        FlatTable field = schema.element(1, col);
+        CHECK(field.string(0) == "c" + std::to_string(col));
+        CHECK(field.scalar<std::uint8_t>(1) == 0);  // not nullable
+        CHECK(field.scalar<std::uint8_t>(2) == 2);  // Int
+        FlatTable type = field.table(3);
+        CHECK(type.scalar<std::int32_t>(0) == 32);
+        CHECK(type.scalar<std::uint8_t>(1) == 1);
+    }
+
+    // two record batches: the first 40 rows and all 100
+    for (std::uint64_t rows : {40u, 100u}) {
+        auto [message, body, following] = read_message(bytes, next);
+        next = following;
+        CHECK(message.scalar<std::uint8_t>(1) == 3);  // RecordBatch
+        FlatTable batch = message.table(2);
+        CHECK(batch.scalar<std::int64_t>(0) == static_cast<std::int64_t>(rows));
+        REQUIRE(batch.length(1) == 3);
+        REQUIRE(batch.length(2) == 6);
+        std::uint64_t mismatches = 0;
+        for (std::uint32_t col = 0; col < 3; ++col) {
+            std::size_t node = batch.struct_at(1, col, 16);
+            CHECK(read_at<std::int64_t>(bytes, node) == static_cast<std::int64_t>(rows));
+            CHECK(read_at<std::int64_t>(bytes, node + 8) == 0);
+            // the validity buffer is empty, the values follow
+            CHECK(read_at<std::int64_t>(bytes, batch.struct_at(2, 2 * col, 16) + 8) == 0);
+            std::size_t values = batch.struct_at(2, 2 * col + 1, 16);
+            auto offset = static_cast<std::size_t>(read_at<std::int64_t>(bytes, values));
+            CHECK(read_at<std::int64_t>(bytes, values + 8) == static_cast<std::int64_t>(4 * rows));
+            for (std::uint64_t row = 0; row < rows; ++row) {
+                if (read_at<int>(bytes, body + offset + 4 * row) != data[row][col]) {
+                    ++mismatches;
+                }
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+    // the end of stream marker
+    CHECK(read_at<std::uint32_t>(bytes, next) == 0xFFFFFFFF);
+    CHECK(read_at<std::int32_t>(bytes, next + 4) == 0);
+}
+
+TEST_CASE("column writers write every layout the same", "[binary]") {
+    auto write = [](const auto& data) {
+        using T = std::remove_cvref_t<decltype(data[0][0])>;
+        std::ostringstream raw;
+        RawColumnWriter<T> raw_writer{raw, data.col_count};
+        raw_writer.write_rows(data, 70);
+        raw_writer.finish();
+        std::ostringstream arrow;
+        ArrowWriter<T> arrow_writer{arrow, data.col_count};
+        arrow_writer.write_rows(data);
+        arrow_writer.finish();
+        return raw.str() + arrow.str();
+    };
+    auto ints = generate_data(100, 3, UniformIntDistribution{0, 1000}, 1);
+    CHECK(write(ints) ==
+          write(generate_data<std::mt19937, ColumnMajor>(100, 3, UniformIntDistribution{0, 1000}, 1)));
+    CHECK(write(ints) ==
+          write(generate_data<std::mt19937, Tiled<64>>(100, 3, UniformIntDistribution{0, 1000}, 1)));
+    auto bools = generate_data(100, 3, BernoulliDistribution{0.5}, 1);
+    CHECK(write(bools) ==
+          write(generate_data<std::mt19937, ColumnMajor>(100, 3, BernoulliDistribution{0.5}, 1)));
+}
+
+TEST_CASE("PostgresBinaryWriter writes big-endian tuples", "[binary]") {
+    Data<int> data{1, 2};
+    data.set_value(0, 0, 1);
+    data.set_value(0, 1, -2);
+
+    std::ostringstream out;
+    PostgresBinaryWriter<int> writer{out, 2};
+    writer.write_rows(data);
+    writer.finish();
+
+    const std::string expected{
+        "PGCOPY\n\377\r\n\0"
+        "\0\0\0\0\0\0\0\0"                  // flags, header extension
+        "\0\2"                              // field count
+        "\0\0\0\4\0\0\0\1"                  // 1
+        "\0\0\0\4\377\377\377\376"          // -2
+        "\377\377",                         // trailer
+        11 + 8 + 2 + 16 + 2};
+    CHECK(out.str() == expected);
+}
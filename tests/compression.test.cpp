@@ -0,0 +1,183 @@
+#include "data_generator/compression.hpp"
+#include "data_generator/data_generator.hpp"
+#include "data_generator/file_writer.hpp"
+#include "data_generator/pipeline_writer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace datagen;
+
+namespace {
+
+/// @brief the compressions of this build
+std::vector<Compression> available_compressions() {
+    std::vector<Compression> compressions;
+    for (Compression compression : {Compression::gzip, Compression::zstd, Compression::lz4}) {
+        if (compression_available(compression)) {
+            compressions.push_back(compression);
+        }
+    }
+    return compressions;
+}
+
+/// @brief decompresses concatenated gzip members, zstd frames or lz4 frames
+std::string decompress(Compression compression, const std::string& data) {
+    std::string out;
+    switch (compression) {
+        case Compression::none:
+            return data;
+        case Compression::gzip: {
+#ifdef DATAGEN_WITH_ZLIB
+            z_stream stream{};
+            REQUIRE(inflateInit2(&stream, 15 + 16) == Z_OK);
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+            stream.avail_in = static_cast<uInt>(data.size());
+            char buffer[1 << 16];
+            while (stream.avail_in > 0) {
+                stream.next_out = reinterpret_cast<Bytef*>(buffer);
+                stream.avail_out = sizeof(buffer);
+                int result = inflate(&stream, Z_NO_FLUSH);
+                REQUIRE((result == Z_OK || result == Z_STREAM_END));
+                out.append(buffer, sizeof(buffer) - stream.avail_out);
+                if (result == Z_STREAM_END) {
+                    // the next member
+                    REQUIRE(inflateReset(&stream) == Z_OK);
+                }
+            }
+            inflateEnd(&stream);
+#endif
+            return out;
+        }
+        case Compression::zstd: {
+#ifdef DATAGEN_WITH_ZSTD
+            ZSTD_DStream* stream = ZSTD_createDStream();
+            ZSTD_inBuffer in{data.data(), data.size(), 0};
+            char buffer[1 << 16];
+            while (in.pos < in.size) {
+                ZSTD_outBuffer output{buffer, sizeof(buffer), 0};
+                std::size_t result = ZSTD_decompressStream(stream, &output, &in);
+                REQUIRE(!ZSTD_isError(result));
+                out.append(buffer, output.pos);
+            }
+            ZSTD_freeDStream(stream);
+#endif
+            return out;
+        }
+        case Compression::lz4: {
+#ifdef DATAGEN_WITH_LZ4
+            LZ4F_dctx* context;
+            REQUIRE(!LZ4F_isError(LZ4F_createDecompressionContext(&context, LZ4F_VERSION)));
+            const char* in = data.data();
+            std::size_t rest = data.size();
+            char buffer[1 << 16];
+            while (rest > 0) {
+                std::size_t out_size = sizeof(buffer);
+                std::size_t in_size = rest;
+                std::size_t result = LZ4F_decompress(context, buffer, &out_size, in, &in_size, nullptr);
+                REQUIRE(!LZ4F_isError(result));
+                out.append(buffer, out_size);
+                in += in_size;
+                rest -= in_size;
+            }
+            LZ4F_freeDecompressionContext(context);
+#endif
+            return out;
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+TEST_CASE("compressed blocks can be concatenated", "[compression]") {
+    std::ostringstream text;
+    output_csv(generate_data(10000, 4, UniformIntDistribution{0, 999}, 1), text);
+    std::string first = text.str();
+    std::string second = first.substr(0, 1000);
+
+    for (Compression compression : available_compressions()) {
+        std::string compressed;
+        std::string block;
+        detail::compress_block(compression, first, block);
+        CHECK(block.size() < first.size());
+        compressed += block;
+        detail::compress_block(compression, second, block);
+        compressed += block;
+        detail::compress_block(compression, "", block);
+        compressed += block;
+        CHECK(decompress(compression, compressed) == first + second);
+    }
+}
+
+#ifdef DATAGEN_WITH_ZLIB
+TEST_CASE("gzip compresses a block in slices", "[compression]") {
+    // the slices stand in for zlib's 32 bit limit on the sizes of a call
+    std::ostringstream text;
+    output_csv(generate_data(20000, 4, UniformIntDistribution{0, 999}, 5), text);
+    std::string compressed;
+    std::string sliced;
+    detail::gzip_block(text.str(), compressed);
+    for (std::size_t max_slice : {1u, 1000u, 65536u}) {
+        detail::gzip_block(text.str(), sliced, max_slice);
+        CHECK(decompress(Compression::gzip, sliced) == text.str());
+    }
+    CHECK(decompress(Compression::gzip, compressed) == text.str());
+    detail::gzip_block("", sliced, 1000);
+    CHECK(decompress(Compression::gzip, sliced).empty());
+}
+#endif
+
+TEST_CASE("unavailable compressions are rejected", "[compression]") {
+    std::ostringstream out;
+    for (Compression compression : {Compression::gzip, Compression::zstd, Compression::lz4}) {
+        if (!compression_available(compression)) {
+            CHECK_THROWS_AS((CompressingBuffer{out, compression}), std::invalid_argument);
+            CHECK_THROWS_AS(generate_text(10, 2, UniformIntDistribution{0, 9}, out, csv_format(),
+                                          1, 1, {}, compression),
+                            std::invalid_argument);
+        }
+    }
+}
+
+TEST_CASE("compressed output decompresses to the uncompressed output", "[compression]") {
+    const TextFormat format = sql_format("t", {}, 999);
+    std::ostringstream expected;
+    generate_text(100000, 3, NormalDistribution{0.0, 1.0}, expected, format, 2);
+
+    for (Compression compression : available_compressions()) {
+        for (unsigned int thread_count : {1u, 4u}) {
+            std::ostringstream compressed;
+            generate_text(100000, 3, NormalDistribution{0.0, 1.0}, compressed, format, 2,
+                          thread_count, {}, compression);
+            CHECK(decompress(compression, compressed.str()) == expected.str());
+
+            auto path = std::filesystem::temp_directory_path() / "datagen_compression.test";
+            {
+                FileTableWriter<double> writer{path.string(), format, thread_count, {},
+                                               compression};
+                writer.write_rows(generate_data(100000, 3, NormalDistribution{0.0, 1.0}, 2));
+                writer.finish();
+            }
+            std::ifstream in{path, std::ios::binary};
+            std::string written{std::istreambuf_iterator<char>{in}, {}};
+            CHECK(decompress(compression, written) == expected.str());
+            std::filesystem::remove(path);
+
+            std::ostringstream streamed;
+            CompressingBuffer buffer{streamed, compression, thread_count, 1000};
+            std::ostream os{&buffer};
+            os << expected.str().substr(0, 500);
+            os << expected.str().substr(500);
+            buffer.finish();
+            CHECK(decompress(compression, streamed.str()) == expected.str());
+        }
+    }
+}
@@ -2,6 +2,12 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
 using namespace datagen;
 
 TEST_CASE("Data class interface is correct", "[Data]") {
@@ -89,4 +95,108 @@ TEST_CASE("Data class interface is correct", "[Data]") {
         CHECK(c-- == dd.begin());
         CHECK(c != dd.begin());
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Data sizes are 64 bit", "[Data]") {
+    // 2^32 cells would wrap around to 0 in 32 bit
+    const std::uint64_t rows = std::uint64_t{1} << 31;
+    Data<bool> db{rows, 2};
+    CHECK(db.size() == std::uint64_t{1} << 32);
+    db.set_value(rows - 1, 1, true);
+    CHECK(db[rows - 1][1]);
+    CHECK(db.back().back());
+    CHECK(!db[0][1]);
+
+    // rows * cols overflows 64 bit
+    CHECK_THROWS_AS((Data<int>{std::uint64_t{1} << 32, std::uint64_t{1} << 32}),
+                    std::length_error);
+    CHECK_THROWS_AS((Data<int>{std::uint64_t{1} << 62, 4}), std::length_error);
+}
+
+TEST_CASE("Data<bool> stores the values as a bitmap", "[Data]") {
+    // 43 columns, so rows start in the middle of words
+    Data<bool> db{4, 43};
+    std::vector<bool> expected(db.size());
+
+    db.set_value(0, 42, true);
+    expected[42] = true;
+    // 100 values from cell 50 on, across two word boundaries and into row 3
+    bool values[100];
+    for (unsigned int i = 0; i < 100; ++i) {
+        values[i] = i % 3 == 0;
+        expected[50 + i] = values[i];
+    }
+    db.set_values(1, 7, std::span<const bool>{values});
+    // 70 bits from cell 1 on
+    const std::uint64_t bits[2] = {0xf0f0'0000'ffff'0001, 0x2a};
+    for (unsigned int i = 0; i < 70; ++i) {
+        expected[1 + i] = ((bits[i / 64] >> (i % 64)) & 1) != 0;
+    }
+    db.set_bits(0, 1, bits, 70);
+
+    std::vector<bool> stored(db.front().begin(), db.back().end());
+    CHECK(stored == expected);
+    for (unsigned int row = 0; row < db.row_count; ++row) {
+        for (unsigned int col = 0; col < db.col_count; ++col) {
+            CHECK(db[row][col] == expected[row * db.col_count + col]);
+        }
+    }
+
+    auto it = db[1].begin();
+    CHECK(it[7] == expected[50]);
+    CHECK(*(it + 50) == expected[93]);
+    CHECK((it + 50) - it == 50);
+    CHECK(it < it + 1);
+    CHECK(db.back().end() - db.front().begin() == 172);
+}
+
+TEST_CASE("Data layouts store the same table", "[Data]") {
+    // 130 rows: a partial last tile, and columns that don't end at a word
+    Data<int> rows{130, 5};
+    Data<int, ColumnMajor> columns{130, 5};
+    Data<int, Tiled<64>> tiles{130, 5};
+    Data<bool, Tiled<64>> bools{130, 5};
+    for (unsigned int row = 0; row < 130; ++row) {
+        for (unsigned int col = 0; col < 5; ++col) {
+            rows.set_value(row, col, static_cast<int>(row * 5 + col));
+            columns.set_value(row, col, static_cast<int>(row * 5 + col));
+        }
+    }
+    std::vector<int> values(130 * 5);
+    std::iota(values.begin(), values.end(), 0);
+    tiles.set_values(0, 0, values);
+    for (unsigned int col = 0; col < 5; ++col) {
+        bool column[130];
+        for (unsigned int row = 0; row < 130; ++row) {
+            column[row] = (row + col) % 3 == 0;
+        }
+        bools.set_column_values(0, col, column);
+    }
+
+    CHECK(columns.layout().cells() == 192 * 5);
+    CHECK(tiles.layout().cells() == (64 + 64 + 64) * 5);
+    for (unsigned int row = 0; row < 130; ++row) {
+        CHECK(std::equal(rows[row].begin(), rows[row].end(), columns[row].begin()));
+        CHECK(std::equal(rows[row].begin(), rows[row].end(), tiles[row].begin()));
+        for (unsigned int col = 0; col < 5; ++col) {
+            CHECK(bools[row][col] == ((row + col) % 3 == 0));
+        }
+    }
+    for (unsigned int col = 0; col < 5; ++col) {
+        auto column = rows.column(col);
+        CHECK(column.size() == 130);
+        CHECK(column[129] == 129 * 5 + static_cast<int>(col));
+        CHECK(std::equal(column.begin(), column.end(), columns.column(col).begin(),
+                         columns.column(col).end()));
+        CHECK(std::equal(column.begin(), column.end(), tiles.column(col).begin(),
+                         tiles.column(col).end()));
+        CHECK(tiles.column(col).end() - tiles.column(col).begin() == 130);
+    }
+    // column-major columns are contiguous
+    CHECK(columns.column(1).begin() == columns.column(0).begin() + 192);
+
+    auto it = columns.begin();
+    ++it;
+    CHECK(it->front() == 5);
+    CHECK((*--columns.end())[4] == 129 * 5 + 4);
+}
@@ -0,0 +1,319 @@
+#include "data_generator/data_generator.hpp"
+#include "data_generator/pipeline_writer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace datagen;
+
+namespace {
+
+/// @brief all instruction sets the cpu supports
+std::vector<InstructionSet> supported_instruction_sets() {
+    std::vector<InstructionSet> result{InstructionSet::scalar};
+    if (detail::simd::detect_instruction_set() != InstructionSet::scalar) {
+        result.push_back(InstructionSet::avx2);
+    }
+    if (detail::simd::detect_instruction_set() == InstructionSet::avx512) {
+        result.push_back(InstructionSet::avx512);
+    }
+    return result;
+}
+
+template <typename RandomEngine, typename RandomNumberDistribution>
+bool same_for_all_instruction_sets(const RandomNumberDistribution& random) {
+    using T = typename RandomNumberDistribution::result_type;
+    const InstructionSet detected = instruction_set();
+    std::vector<std::vector<T>> results;
+    for (InstructionSet set : supported_instruction_sets()) {
+        instruction_set() = set;
+        auto data = generate_data<RandomEngine>(301, 7, RandomNumberDistribution{random}, 8);
+        results.emplace_back(data.front().begin(), data.back().end());
+    }
+    instruction_set() = detected;
+    return std::all_of(results.begin(), results.end(),
+                       [&](const auto& result) { return result == results.front(); });
+}
+
+/// @brief fill must yield the same values as calling the distribution once per value
+template <typename RandomNumberDistribution>
+bool fill_matches_scalar(RandomNumberDistribution random, std::size_t count) {
+    using T = typename RandomNumberDistribution::result_type;
+    std::mt19937 scalar_algo{3};
+    RandomNumberDistribution scalar_random{random};
+    std::vector<T> expected;
+    for (std::size_t i = 0; i < count; ++i) {
+        expected.push_back(scalar_random(scalar_algo));
+    }
+
+    std::mt19937 batch_algo{3};
+    std::unique_ptr<T[]> values{new T[count]};
+    // odd sized pieces so that normal pairs are split between two calls
+    for (std::size_t begin = 0; begin < count; begin += 333) {
+        random.fill(batch_algo, std::span<T>{values.get() + begin,
+                                             std::min<std::size_t>(333, count - begin)});
+    }
+    return std::equal(expected.begin(), expected.end(), values.get()) &&
+           scalar_algo() == batch_algo();
+}
+
+/// @brief fill_bits must yield the values of fill as bits
+bool fill_bits_matches_fill(BernoulliDistribution random, std::size_t count) {
+    std::mt19937 fill_algo{3};
+    std::unique_ptr<bool[]> values{new bool[count]};
+    random.fill(fill_algo, std::span<bool>{values.get(), count});
+
+    std::mt19937 bits_algo{3};
+    std::vector<std::uint64_t> bits((count + 63) / 64, ~std::uint64_t{0});
+    random.fill_bits(bits_algo, bits.data(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (values[i] != (((bits[i / 64] >> (i % 64)) & 1) != 0)) {
+            return false;
+        }
+    }
+    // bits past count are 0
+    return count % 64 == 0 || bits.back() >> (count % 64) == 0;
+}
+
+/// @brief the narrowed distribution must generate the values of the int one
+template <typename RandomEngine>
+bool narrow_matches_int(int a, int b) {
+    auto expected = generate_data<RandomEngine>(301, 7, UniformIntDistribution<int>{a, b}, 8);
+    return std::visit(
+        [&](auto random) {
+            auto data = generate_data<RandomEngine>(301, 7, std::move(random), 8);
+            return std::equal(data.front().begin(), data.back().end(),
+                              expected.front().begin(), expected.back().end(),
+                              [](auto x, int y) { return int{x} == y; });
+        },
+        narrowest_uniform(a, b));
+}
+
+}  // namespace
+
+TEST_CASE("batch fill equals scalar generation", "[distributions]") {
+    CHECK(fill_matches_scalar(UniformIntDistribution{-20, 400}, 1000));
+    CHECK(fill_matches_scalar(UniformIntDistribution<short>{-3, 3}, 1000));
+    CHECK(fill_matches_scalar(UniformIntDistribution<long>{}, 1000));
+    CHECK(fill_matches_scalar(NormalDistribution{5.0, 2.0}, 1001));
+    CHECK(fill_matches_scalar(BernoulliDistribution{0.8}, 1000));
+    CHECK(fill_matches_scalar(ZipfDistribution{100, 1.2}, 1000));
+    CHECK(fill_matches_scalar(ZipfDistribution{1'000'000, 0.8}, 1000));
+    CHECK(fill_matches_scalar(ForeignKeyDistribution{-5, 1000}, 1000));
+    CHECK(fill_matches_scalar(ForeignKeyDistribution{1000, 1'000'000, 1.1}, 1000));
+}
+
+TEST_CASE("packed and narrow batches equal the plain ones", "[distributions]") {
+    CHECK(fill_bits_matches_fill(BernoulliDistribution{0.3}, 1000));
+    CHECK(fill_bits_matches_fill(BernoulliDistribution{0.5}, 64 * 5));
+    CHECK(fill_bits_matches_fill(BernoulliDistribution{1.0}, 77));
+
+    CHECK(std::holds_alternative<UniformIntDistribution<std::int8_t>>(narrowest_uniform(-128, 127)));
+    CHECK(std::holds_alternative<UniformIntDistribution<std::int16_t>>(narrowest_uniform(0, 128)));
+    CHECK(std::holds_alternative<UniformIntDistribution<int>>(narrowest_uniform(-40000, 0)));
+    for (auto [a, b] : {std::pair{0, 9}, {-128, 127}, {-300, 300}, {-40000, 40000}}) {
+        CHECK(narrow_matches_int<std::mt19937>(a, b));
+        CHECK(narrow_matches_int<Philox4x32>(a, b));
+    }
+}
+
+TEST_CASE("every instruction set generates the same values", "[distributions]") {
+    CHECK(same_for_all_instruction_sets<std::mt19937>(UniformIntDistribution{-20, 400}));
+    CHECK(same_for_all_instruction_sets<Philox4x32>(UniformIntDistribution<int>{
+        std::numeric_limits<int>::min(), std::numeric_limits<int>::max()}));
+    CHECK(same_for_all_instruction_sets<std::mt19937>(NormalDistribution{5.0, 2.0}));
+    CHECK(same_for_all_instruction_sets<Philox4x32>(NormalDistribution{5.0, 2.0}));
+    CHECK(same_for_all_instruction_sets<std::mt19937>(BernoulliDistribution{0.3}));
+    CHECK(same_for_all_instruction_sets<Philox4x32>(BernoulliDistribution{0.3}));
+}
+
+TEST_CASE("batched Philox4x32 cells equal the scalar cell streams", "[distributions]") {
+    auto data = generate_data<Philox4x32>(50, 9, NormalDistribution{}, 21);
+    Philox4x32 random_algo{21};
+    NormalDistribution random{};
+    for (unsigned int row = 0; row < data.row_count; ++row) {
+        for (unsigned int col = 0; col < data.col_count; ++col) {
+            random_algo.seek_cell(row, col);
+            random.reset();
+            CHECK(data[row][col] == random(random_algo));
+        }
+    }
+}
+
+TEST_CASE("batched Philox4x32 cells equal the scalar cell streams for zipf", "[distributions]") {
+    for (std::int64_t n : {std::int64_t{1000}, zipf_table_size + 1}) {
+        auto data = generate_data<Philox4x32>(50, 9, ZipfDistribution{n, 0.9}, 21);
+        Philox4x32 random_algo{21};
+        ZipfDistribution random{n, 0.9};
+        for (unsigned int row = 0; row < data.row_count; ++row) {
+            for (unsigned int col = 0; col < data.col_count; ++col) {
+                random_algo.seek_cell(row, col);
+                CHECK(data[row][col] == random(random_algo));
+            }
+        }
+    }
+}
+
+TEST_CASE("zipf and foreign keys have the requested parameters", "[distributions]") {
+    const unsigned int n = 200000;
+    // the alias table and rejection-inversion
+    for (std::int64_t elements : {std::int64_t{50}, std::int64_t{10'000'000}}) {
+        for (double s : {0.7, 1.0, 2.0}) {
+            auto zipf = generate_data(n, 1, ZipfDistribution{elements, s}, 1);
+            double harmonic = 0.0;
+            for (std::int64_t k = 1; k <= std::min<std::int64_t>(elements, 10'000'000); ++k) {
+                harmonic += std::pow(static_cast<double>(k), -s);
+            }
+            for (std::int64_t k : {1, 2, 5}) {
+                auto count = std::count(zipf.front().begin(), zipf.back().end(), k);
+                CHECK(std::abs(static_cast<double>(count) / n -
+                               std::pow(static_cast<double>(k), -s) / harmonic) < 0.005);
+            }
+            CHECK(*std::min_element(zipf.front().begin(), zipf.back().end()) >= 1);
+            CHECK(*std::max_element(zipf.front().begin(), zipf.back().end()) <= elements);
+        }
+    }
+
+    auto keys = generate_data<Philox4x32>(n, 1, ForeignKeyDistribution{1000, 10}, 1);
+    CHECK(*std::min_element(keys.front().begin(), keys.back().end()) == 1000);
+    CHECK(*std::max_element(keys.front().begin(), keys.back().end()) == 1009);
+    auto skewed = generate_data(n, 1, ForeignKeyDistribution{1000, 10, 1.5}, 1);
+    auto ranks = generate_data(n, 1, ZipfDistribution{10, 1.5}, 1);
+    CHECK(std::equal(skewed.front().begin(), skewed.back().end(), ranks.front().begin(),
+                     [](std::int64_t key, std::int64_t rank) { return key == rank + 999; }));
+}
+
+TEST_CASE("multivariate normal rows have the requested covariance", "[distributions]") {
+    const unsigned int n = 200000;
+    const std::vector<double> mean{1.0, -2.0, 10.0};
+    const std::vector<double> covariance{4.0, 1.8, -1.0,  //
+                                         1.8, 1.0, 0.0,   //
+                                         -1.0, 0.0, 9.0};
+    auto check_moments = [&](const auto& data) {
+        for (std::size_t i = 0; i < 3; ++i) {
+            for (std::size_t j = 0; j < 3; ++j) {
+                double sum_i = 0.0, sum_j = 0.0, sum_ij = 0.0;
+                for (const auto& row : data) {
+                    sum_i += row[i];
+                    sum_j += row[j];
+                    sum_ij += row[i] * row[j];
+                }
+                if (i == j) {
+                    CHECK(std::abs(sum_i / n - mean[i]) < 0.05);
+                }
+                double estimate = sum_ij / n - sum_i / n * sum_j / n;
+                CHECK(std::abs(estimate - covariance[i * 3 + j]) < 0.1);
+            }
+        }
+    };
+    MultivariateNormalDistribution random{mean, covariance};
+    auto data = generate_data(n, 3, MultivariateNormalDistribution{random}, 4, 3);
+    check_moments(data);
+    auto philox = generate_data<Philox4x32>(n, 3, MultivariateNormalDistribution{random}, 4, 3);
+    check_moments(philox);
+
+    // whole rows are generated from the row's position in the random streams
+    for (std::uint64_t first_row : {std::uint64_t{0}, std::uint64_t{12345}, std::uint64_t{199990}}) {
+        auto rows = generate_rows(first_row, 10, 3, MultivariateNormalDistribution{random}, 4);
+        CHECK(std::equal(rows.front().begin(), rows.back().end(), data[first_row].begin()));
+        auto philox_rows =
+            generate_rows<Philox4x32>(first_row, 10, 3, MultivariateNormalDistribution{random}, 4);
+        CHECK(std::equal(philox_rows.front().begin(), philox_rows.back().end(),
+                         philox[first_row].begin()));
+    }
+
+    CHECK_THROWS_AS((MultivariateNormalDistribution{{0.0, 0.0}, {1.0, 2.0, 2.0, 1.0}}),
+                    std::invalid_argument);
+    CHECK_THROWS_AS((MultivariateNormalDistribution{{0.0, 0.0}, {1.0, 0.5, 0.4, 1.0}}),
+                    std::invalid_argument);
+    CHECK_THROWS_AS((MultivariateNormalDistribution{{0.0, 0.0}, {1.0, 0.0, 1.0}}),
+                    std::invalid_argument);
+    // tables need a column per dimension
+    CHECK_THROWS_AS(generate_data(n, 4, MultivariateNormalDistribution{random}, 4, 3),
+                    std::invalid_argument);
+    CHECK_THROWS_AS(generate_data<Philox4x32>(n, 2, MultivariateNormalDistribution{random}, 4),
+                    std::invalid_argument);
+    std::ostringstream text;
+    CHECK_THROWS_AS(generate_text(n, 2, MultivariateNormalDistribution{random}, text,
+                                  csv_format(), 4, 2),
+                    std::invalid_argument);
+}
+
+TEST_CASE("unique keys are a permutation of the key range", "[distributions]") {
+    const std::uint64_t rows = 3 * block_rows(4) + 5;
+    const auto n = static_cast<std::int64_t>(rows * 4);
+    auto keys = generate_data(rows, 4, UniqueKeyDistribution{-10, n - 11}, 6, 3);
+    std::vector<std::int64_t> sorted{keys.front().begin(), keys.back().end()};
+    std::sort(sorted.begin(), sorted.end());
+    for (std::int64_t i = 0; i < n; ++i) {
+        REQUIRE(sorted[static_cast<std::size_t>(i)] == i - 10);
+    }
+    // another seed, another permutation
+    auto other = generate_data(rows, 4, UniqueKeyDistribution{-10, n - 11}, 7);
+    CHECK(!std::equal(keys.front().begin(), keys.back().end(), other.front().begin()));
+
+    // the key depends on the cell only, not on the engine, the threads or the row range
+    auto philox = generate_data<Philox4x32>(rows, 4, UniqueKeyDistribution{-10, n - 11}, 6);
+    CHECK(std::equal(keys.front().begin(), keys.back().end(), philox.front().begin()));
+    auto tail = generate_rows(rows - 7, 7, 4, UniqueKeyDistribution{-10, n - 11}, 6);
+    CHECK(std::equal(tail.front().begin(), tail.back().end(), keys[rows - 7].begin()));
+
+    // a few keys out of all 2^64 values
+    auto wide = generate_data(1000, 1, UniqueKeyDistribution{}, 6);
+    std::vector<std::int64_t> wide_keys{wide.front().begin(), wide.back().end()};
+    std::sort(wide_keys.begin(), wide_keys.end());
+    CHECK(std::adjacent_find(wide_keys.begin(), wide_keys.end()) == wide_keys.end());
+    CHECK(wide_keys.front() >= 1);
+}
+
+TEST_CASE("sequences are strictly increasing", "[distributions]") {
+    const std::uint64_t rows = 2 * block_rows(2) + 3;
+    auto plain = generate_data(rows, 2, SequenceDistribution{100, 3}, 2, 3);
+    auto gaps = generate_data(rows, 2, SequenceDistribution{100, 3, true}, 2, 3);
+    std::int64_t i = 0;
+    std::int64_t previous = std::numeric_limits<std::int64_t>::min();
+    for (auto p = plain.front().begin(), g = gaps.front().begin(); p != plain.back().end(); ++p, ++g) {
+        CHECK(*p == 100 + 3 * i++);
+        // the gap is smaller than the step
+        CHECK((*g >= *p && *g < *p + 3));
+        CHECK(*g > previous);
+        previous = *g;
+    }
+    auto tail = generate_rows<Philox4x32>(rows - 4, 4, 2, SequenceDistribution{100, 3, true}, 2);
+    CHECK(std::equal(tail.front().begin(), tail.back().end(), gaps[rows - 4].begin()));
+}
+
+TEST_CASE("distributions have the requested parameters", "[distributions]") {
+    const unsigned int n = 200000;
+
+    auto uniform = generate_data(n, 1, UniformIntDistribution{-3, 5}, 1);
+    CHECK(*std::min_element(uniform.front().begin(), uniform.back().end()) == -3);
+    CHECK(*std::max_element(uniform.front().begin(), uniform.back().end()) == 5);
+
+    auto normal = generate_data<Philox4x32>(n, 1, NormalDistribution{3.0, 2.0}, 1);
+    double sum = 0.0;
+    double square_sum = 0.0;
+    for (const auto& row : normal) {
+        sum += row[0];
+        square_sum += row[0] * row[0];
+    }
+    double mean = sum / n;
+    CHECK(std::abs(mean - 3.0) < 0.02);
+    CHECK(std::abs(std::sqrt(square_sum / n - mean * mean) - 2.0) < 0.02);
+
+    auto bernoulli = generate_data(n, 1, BernoulliDistribution{0.25}, 1);
+    auto trues = std::count(bernoulli.front().begin(), bernoulli.back().end(), true);
+    CHECK(std::abs(static_cast<double>(trues) / n - 0.25) < 0.005);
+
+    auto always = generate_data(100, 1, BernoulliDistribution{1.0}, 1);
+    CHECK(std::count(always.front().begin(), always.back().end(), true) == 100);
+}
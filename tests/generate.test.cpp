@@ -0,0 +1,777 @@
+#include "data_generator/data_generator.hpp"
+#include "data_generator/file_writer.hpp"
+#include "data_generator/pipeline_writer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+using namespace datagen;
+
+namespace {
+
+/// @brief a compile-time value formatter
+struct HexFormatter {
+    template <typename Sink>
+    void operator()(int value, Sink& sink) const {
+        std::array<char, 16> chars{};
+        auto result = std::to_chars(chars.data(), chars.data() + chars.size(), value, 16);
+        sink.append("0x");
+        sink.append({chars.data(), result.ptr});
+    }
+};
+
+}  // namespace
+
+TEST_CASE("generate_stream yields the same rows as generate_data", "[generate]") {
+    const unsigned int seed = 42;
+    auto data = generate_data(1000, 3, std::uniform_int_distribution{0, 99}, seed);
+
+    for (unsigned int chunk_rows : {1u, 7u, 1000u, 4096u}) {
+        std::uint64_t row_offset = 0;
+        generate_stream(
+            1000, 3, std::uniform_int_distribution{0, 99},
+            [&](const Data<int>& chunk, std::uint64_t rows) {
+                CHECK(rows <= chunk_rows);
+                for (unsigned int row = 0; row < rows; ++row) {
+                    for (unsigned int col = 0; col < 3; ++col) {
+                        CHECK(chunk[row][col] == data[row_offset + row][col]);
+                    }
+                }
+                row_offset += rows;
+            },
+            seed, chunk_rows);
+        CHECK(row_offset == 1000);
+    }
+}
+
+TEST_CASE("generate_stream of bools fills partial words", "[generate]") {
+    // 5 columns: chunks and rows start in the middle of the words of the bitmap
+    auto data = generate_data<Philox4x32>(1000, 5, BernoulliDistribution{0.4}, 9, 2);
+    for (unsigned int chunk_rows : {1u, 13u, 999u}) {
+        std::uint64_t row_offset = 0;
+        generate_stream<Philox4x32>(
+            1000, 5, BernoulliDistribution{0.4},
+            [&](const Data<bool>& chunk, std::uint64_t rows) {
+                for (unsigned int row = 0; row < rows; ++row) {
+                    for (unsigned int col = 0; col < 5; ++col) {
+                        CHECK(chunk[row][col] == data[row_offset + row][col]);
+                    }
+                }
+                row_offset += rows;
+            },
+            9, chunk_rows);
+        CHECK(row_offset == 1000);
+    }
+}
+
+TEST_CASE("threads generate unaligned chunks of bools", "[generate]") {
+    // chunks that start in the middle of a bitmap word and span several blocks
+    const std::uint64_t block = block_rows(5);
+    const std::uint64_t rows = 4 * block + 100;
+    auto data = generate_data<Philox4x32>(rows, 5, BernoulliDistribution{0.4}, 9);
+    std::uint64_t row_offset = 0;
+    std::uint64_t mismatches = 0;
+    generate_stream<Philox4x32>(
+        rows, 5, BernoulliDistribution{0.4},
+        [&](const Data<bool>& chunk, std::uint64_t count) {
+            for (std::uint64_t row = 0; row < count; ++row) {
+                for (std::uint64_t col = 0; col < 5; ++col) {
+                    if (chunk[row][col] != data[row_offset + row][col]) {
+                        ++mismatches;
+                    }
+                }
+            }
+            row_offset += count;
+        },
+        9, 2 * block + 13, 3);
+    CHECK(row_offset == rows);
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("TableWriter output does not depend on the chunking", "[output]") {
+    auto data = generate_data(10, 4, std::normal_distribution{0.0, 1.0}, 3);
+
+    std::ostringstream expected;
+    output_sql(data, expected, "t");
+
+    std::ostringstream chunked;
+    auto writer = sql_writer<double>(chunked, "t");
+    generate_stream(
+        10, 4, std::normal_distribution{0.0, 1.0},
+        [&](const Data<double>& chunk, std::uint64_t rows) {
+            writer.write_rows(chunk, rows);
+        },
+        3, 3);
+    writer.finish();
+
+    CHECK(chunked.str() == expected.str());
+}
+
+TEST_CASE("generated values don't depend on the thread count", "[generate]") {
+    const std::uint64_t rows = 3 * block_rows(5) + 17;
+    auto expected = generate_data(rows, 5, std::normal_distribution{0.0, 1.0}, 11);
+
+    for (unsigned int thread_count : {2u, 3u, 8u}) {
+        auto data = generate_data(rows, 5, std::normal_distribution{0.0, 1.0},
+                                  11, thread_count);
+        CHECK(std::equal(data.front().begin(), data.back().end(),
+                         expected.front().begin()));
+
+        std::uint64_t row_offset = 0;
+        generate_stream(
+            rows, 5, std::normal_distribution{0.0, 1.0},
+            [&](const Data<double>& chunk, std::uint64_t chunk_rows) {
+                CHECK(std::equal(chunk.front().begin(),
+                                 chunk[chunk_rows - 1].end(),
+                                 expected[row_offset].begin()));
+                row_offset += chunk_rows;
+            },
+            11, 100, thread_count);
+        CHECK(row_offset == rows);
+    }
+}
+
+TEST_CASE("Philox4x32 matches the reference implementation", "[engine]") {
+    using Counter = Philox4x32::Counter;
+    CHECK(Philox4x32::block(Counter{0, 0, 0, 0}, {0, 0}) ==
+          Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    CHECK(Philox4x32::block(Counter{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                            {0xffffffff, 0xffffffff}) ==
+          Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+    CHECK(Philox4x32::block(Counter{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                            {0xa4093822, 0x299f31d0}) ==
+          Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+
+    Philox4x32 engine{};
+    CHECK(engine() == 0x6627e8d5);
+    CHECK(engine() == 0xe169c58d);
+    engine.discard(2);
+    CHECK(engine() != engine());
+}
+
+TEST_CASE("generate_rows regenerates any row range", "[generate]") {
+    const std::uint64_t rows = 2 * block_rows(4) + 5;
+    auto mt = generate_data(rows, 4, std::normal_distribution{0.0, 1.0}, 5);
+    auto philox = generate_data<Philox4x32>(
+        rows, 4, std::normal_distribution{0.0, 1.0}, 5, 3);
+
+    for (std::uint64_t first_row : {std::uint64_t{0}, std::uint64_t{1},
+                                     block_rows(4) - 1, rows - 1}) {
+        auto mt_rows = generate_rows(first_row, 1, 4,
+                                     std::normal_distribution{0.0, 1.0}, 5);
+        auto philox_rows = generate_rows<Philox4x32>(
+            first_row, 1, 4, std::normal_distribution{0.0, 1.0}, 5);
+        CHECK(std::equal(mt_rows[0].begin(), mt_rows[0].end(),
+                         mt[first_row].begin()));
+        CHECK(std::equal(philox_rows[0].begin(), philox_rows[0].end(),
+                         philox[first_row].begin()));
+    }
+
+    // every cell only depends on (seed, row, col), not on the column count
+    auto wider = generate_rows<Philox4x32>(
+        1, 1, 6, std::normal_distribution{0.0, 1.0}, 5);
+    CHECK(std::equal(philox[1].begin(), philox[1].end(), wider[0].begin()));
+}
+
+TEST_CASE("rows past 2^32 have their own random values", "[generate]") {
+    const std::uint64_t first_row = (std::uint64_t{1} << 32) - 2;
+    const std::uint64_t rows = 4;
+
+    auto philox = generate_rows<Philox4x32>(first_row, rows, 3,
+                                            UniformIntDistribution<int>{}, 17);
+    Philox4x32 random_algo{17};
+    UniformIntDistribution<int> random{};
+    for (std::uint64_t row = 0; row < rows; ++row) {
+        for (unsigned int col = 0; col < 3; ++col) {
+            random_algo.seek_cell(first_row + row, col);
+            CHECK(philox[row][col] == random(random_algo));
+        }
+    }
+    auto philox_wrapped = generate_rows<Philox4x32>(0, 2, 3, UniformIntDistribution<int>{}, 17);
+    CHECK(!std::equal(philox[2].begin(), philox[2].end(), philox_wrapped[0].begin()));
+
+    // blocks past 2^32 rows are generated independently as well
+    const std::uint64_t block = block_rows(3);
+    const std::uint64_t mt_first_row = (std::uint64_t{1} << 32) - block / 2;
+    auto mt = generate_rows(mt_first_row, 2 * block, 3, UniformIntDistribution<int>{}, 17);
+    auto mt_threads = generate_rows(mt_first_row, 2 * block, 3,
+                                    UniformIntDistribution<int>{}, 17, 3);
+    CHECK(std::equal(mt.front().begin(), mt.back().end(), mt_threads.front().begin()));
+    auto mt_tail = generate_rows(mt_first_row + block, block, 3,
+                                 UniformIntDistribution<int>{}, 17);
+    CHECK(std::equal(mt_tail.front().begin(), mt_tail.back().end(), mt[block].begin()));
+    auto mt_wrapped = generate_rows(0, block, 3, UniformIntDistribution<int>{}, 17);
+    CHECK(!std::equal(mt_wrapped.front().begin(), mt_wrapped.back().end(),
+                      mt[block / 2].begin()));
+}
+
+TEST_CASE("generated values don't depend on the layout", "[generate]") {
+    auto same = [](const auto& expected, const auto& data) {
+        for (std::uint64_t row = 0; row < expected.row_count; ++row) {
+            if (!std::equal(expected[row].begin(), expected[row].end(), data[row].begin())) {
+                return false;
+            }
+        }
+        return true;
+    };
+    // more than a block of rows, so the threads fill different blocks
+    auto ints = generate_data(5000, 17, UniformIntDistribution{-5, 5}, 3);
+    CHECK(same(ints, generate_data<std::mt19937, ColumnMajor>(
+                         5000, 17, UniformIntDistribution{-5, 5}, 3, 3)));
+    CHECK(same(ints, generate_data<std::mt19937, Tiled<>>(
+                         5000, 17, UniformIntDistribution{-5, 5}, 3, 2)));
+
+    auto doubles = generate_data<Philox4x32>(3001, 4, NormalDistribution{}, 3);
+    CHECK(same(doubles, generate_data<Philox4x32, ColumnMajor>(
+                            3001, 4, NormalDistribution{}, 3, 4)));
+    CHECK(same(doubles, generate_data<Philox4x32, Tiled<256>>(
+                            3001, 4, NormalDistribution{}, 3)));
+
+    auto bools = generate_data<Philox4x32>(5000, 17, BernoulliDistribution{0.3}, 3);
+    CHECK(same(bools, generate_data<Philox4x32, ColumnMajor>(
+                          5000, 17, BernoulliDistribution{0.3}, 3, 3)));
+    CHECK(same(bools, generate_data<Philox4x32, Tiled<>>(
+                          5000, 17, BernoulliDistribution{0.3}, 3, 3)));
+
+    auto reals = generate_data<Philox4x32>(999, 3, std::uniform_real_distribution{}, 3);
+    CHECK(same(reals, generate_data<Philox4x32, Tiled<64>>(
+                          999, 3, std::uniform_real_distribution{}, 3)));
+
+    // unaligned chunks of bools
+    std::uint64_t row_offset = 0;
+    generate_stream<Philox4x32, ColumnMajor>(
+        5000, 17, BernoulliDistribution{0.3},
+        [&](const Data<bool, ColumnMajor>& chunk, std::uint64_t rows) {
+            auto offset = static_cast<std::ptrdiff_t>(row_offset);
+            for (std::uint64_t col = 0; col < 17; ++col) {
+                auto column = chunk.column(col).begin();
+                CHECK(std::equal(column, column + static_cast<std::ptrdiff_t>(rows),
+                                 bools.column(col).begin() + offset));
+            }
+            row_offset += rows;
+        },
+        3, 333, 3);
+    CHECK(row_offset == 5000);
+}
+
+TEST_CASE("writers write every layout the same", "[output]") {
+    auto rows = generate_data(100, 3, NormalDistribution{}, 1);
+    auto columns = generate_data<std::mt19937, ColumnMajor>(100, 3, NormalDistribution{}, 1);
+    std::ostringstream expected;
+    std::ostringstream actual;
+    output_csv(rows, expected);
+    output_csv(columns, actual);
+    CHECK(actual.str() == expected.str());
+
+    auto bools = generate_data(200, 3, BernoulliDistribution{0.5}, 1);
+    auto tiled = generate_data<std::mt19937, Tiled<64>>(200, 3, BernoulliDistribution{0.5}, 1);
+    std::ostringstream expected_bools;
+    std::ostringstream actual_bools;
+    auto expected_writer = json_writer<bool>(expected_bools);
+    expected_writer.write_rows(bools, 10, 190);
+    expected_writer.finish();
+    auto actual_writer = json_writer<bool>(actual_bools);
+    actual_writer.write_rows(tiled, 10, 190);
+    actual_writer.finish();
+    CHECK(actual_bools.str().size() > 180 * 3 * 4);
+    CHECK(actual_bools.str() == expected_bools.str());
+}
+
+TEST_CASE("doubles are written so that they read back exactly", "[output]") {
+    auto data = generate_data(50, 4, NormalDistribution{0.0, 1e6}, 11);
+
+    std::ostringstream out;
+    output_csv(data, out);
+
+    std::istringstream in{out.str()};
+    for (unsigned int row = 0; row < data.row_count; ++row) {
+        for (unsigned int col = 0; col < data.col_count; ++col) {
+            double value = 0;
+            in >> value;
+            CHECK(value == data[row][col]);
+            in.ignore(1);
+        }
+    }
+}
+
+TEST_CASE("formats write values as before", "[output]") {
+    Data<bool> bools{2, 2};
+    bools.set_value(0, 0, true);
+    bools.set_value(1, 1, true);
+
+    std::ostringstream json;
+    output_json(bools, json);
+    CHECK(json.str() == "[\n  [true, false],\n  [false, true]\n]");
+
+    std::ostringstream csv;
+    output_csv(bools, csv);
+    CHECK(csv.str() == "1,0\n0,1");
+
+    Data<int> ints{1, 3};
+    ints.set_value(0, 0, -7);
+    ints.set_value(0, 2, 123456);
+
+    std::ostringstream sql;
+    output_sql(ints, sql, "t");
+    CHECK(sql.str() == "INSERT INTO \"t\" VALUES\n  (-7, 0, 123456);");
+
+    std::ostringstream custom;
+    output_csv<int>(ints, custom,
+                    [](const int& value, std::ostream& os) { os << '<' << value << '>'; });
+    CHECK(custom.str() == "<-7>,<0>,<123456>");
+}
+
+TEST_CASE("TableWriter takes any format and a value formatter", "[output]") {
+    Data<int> ints{2, 2};
+    ints.set_value(0, 1, 5);
+    ints.set_value(1, 0, -3);
+
+    // delimiters that none of the formats of the library has
+    std::ostringstream custom;
+    TableWriter<int> writer{custom, {"<", "(", ";", ")", "|", ">"}};
+    writer.write_rows(ints);
+    writer.finish();
+    CHECK(custom.str() == "<(0;5)|(-3;0)>");
+
+    std::ostringstream hex;
+    TableWriter<int, HexFormatter> hex_writer{hex, json_format()};
+    hex_writer.write_rows(ints);
+    hex_writer.finish();
+    CHECK(hex.str() == "[\n  [0x0, 0x5],\n  [0x-3, 0x0]\n]");
+}
+
+TEST_CASE("FileTableWriter writes the same as TableWriter", "[output]") {
+    auto data = generate_data(5000, 3, UniformIntDistribution{-1000, 1000}, 9);
+    std::ostringstream expected;
+    output_json(data, expected);
+
+    auto path = std::filesystem::temp_directory_path() / "datagen_file_writer.test.json";
+    for (unsigned int thread_count : {1u, 4u}) {
+        for (unsigned int chunk_rows : {1000u, 5000u}) {
+            {
+                FileTableWriter<int> writer{path.string(), json_format(), thread_count};
+                generate_stream(
+                    5000, 3, UniformIntDistribution{-1000, 1000},
+                    [&](const Data<int>& chunk, std::uint64_t rows) { writer.write_rows(chunk, rows); },
+                    9, chunk_rows);
+                writer.finish();
+            }
+            std::ifstream in{path, std::ios::binary};
+            std::string written{std::istreambuf_iterator<char>{in}, {}};
+            CHECK(written == expected.str());
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("tables continue from a checkpoint", "[output]") {
+    const TextFormat format = sql_format("t", {}, 300);
+    auto data = generate_data(5000, 3, UniformIntDistribution{-1000, 1000}, 9);
+    std::ostringstream expected;
+    TableWriter<int> expected_writer{expected, format};
+    expected_writer.write_rows(data);
+    expected_writer.finish();
+
+    auto path = std::filesystem::temp_directory_path() / "datagen_checkpoint.test.sql";
+    FileCheckpoint checkpoint;
+    {
+        FileTableWriter<int> writer{path.string(), format, 2};
+        writer.write_rows(generate_rows(0, 2000, 3, UniformIntDistribution{-1000, 1000}, 9));
+        checkpoint = writer.checkpoint();
+        // rows after the checkpoint that are lost, e.g. when the process dies
+        writer.write_rows(generate_rows(2000, 1000, 3, UniformIntDistribution{-1000, 1000}, 9));
+    }
+    CHECK(checkpoint.rows == 2000);
+    CHECK(checkpoint.bytes < std::filesystem::file_size(path));
+    {
+        FileTableWriter<int> writer{path.string(), format, 3, {}, Compression::none, checkpoint};
+        writer.write_rows(generate_rows(2000, 3000, 3, UniformIntDistribution{-1000, 1000}, 9));
+        writer.sync();
+        writer.finish();
+    }
+    std::ifstream in{path, std::ios::binary};
+    std::string written{std::istreambuf_iterator<char>{in}, {}};
+    CHECK(written == expected.str());
+    std::filesystem::remove(path);
+
+    // a file shorter than the checkpoint isn't continued
+    std::ofstream{path} << "BEGIN;";
+    CHECK_THROWS_AS((FileTableWriter<int>{path.string(), format, 1, {}, Compression::none, checkpoint}),
+                    std::runtime_error);
+    std::filesystem::remove(path);
+
+    // the continuation on a stream, without the prefix
+    TextFormat continued = format;
+    continued.prefix.clear();
+    std::ostringstream piped;
+    {
+        PipelineTableWriter<int> writer{piped, continued, 2};
+        writer.resume_at(2000);
+        writer.write_rows(generate_rows(2000, 3000, 3, UniformIntDistribution{-1000, 1000}, 9));
+        writer.finish();
+    }
+    CHECK(expected.str().substr(checkpoint.bytes) == piped.str());
+}
+
+TEST_CASE("pipelined output is the same as that of the serial writers", "[output]") {
+    const Schema schema{{"id", UniformIntDistribution{1, 10}},
+                        {"price", NormalDistribution{100.0, 15.0}},
+                        {"flag", BernoulliDistribution{0.5}}};
+    auto data = generate_data(20000, 3, UniformIntDistribution{-1000, 1000}, 9);
+    auto table = generate_table(150000, schema, 5);
+
+    auto check_data = [&]<typename RandomEngine>(auto random, const TextFormat& format) {
+        using T = typename decltype(random)::result_type;
+        std::ostringstream expected;
+        TableWriter<T> expected_writer{expected, format};
+        expected_writer.write_rows(generate_data<RandomEngine>(5000, 7, decltype(random){random}, 3));
+        expected_writer.finish();
+
+        for (unsigned int thread_count : {1u, 3u, 8u}) {
+            std::ostringstream piped;
+            generate_text<RandomEngine>(5000, 7, random, piped, format, 3, thread_count);
+            CHECK(piped.str() == expected.str());
+        }
+    };
+
+    for (const TextFormat& format : {csv_format(), sql_format("t", {}, 999), json_format()}) {
+        std::ostringstream expected;
+        TableWriter<int> expected_writer{expected, format};
+        expected_writer.write_rows(data);
+        expected_writer.finish();
+        for (unsigned int thread_count : {1u, 4u}) {
+            std::ostringstream piped;
+            PipelineTableWriter<int> writer{piped, format, thread_count};
+            generate_stream(
+                20000, 3, UniformIntDistribution{-1000, 1000},
+                [&](const Data<int>& chunk, std::uint64_t rows) { writer.write_rows(chunk, rows); },
+                9, 7000);
+            writer.finish();
+            CHECK(piped.str() == expected.str());
+        }
+
+        check_data.operator()<std::mt19937>(UniformIntDistribution{0, 99}, format);
+        check_data.operator()<Philox4x32>(NormalDistribution{0.0, 1.0}, format);
+        check_data.operator()<std::mt19937>(BernoulliDistribution{0.5}, format);
+
+        std::ostringstream expected_table;
+        ColumnTableWriter table_writer{expected_table, format};
+        table_writer.write_rows(table);
+        table_writer.finish();
+        for (unsigned int thread_count : {1u, 4u}) {
+            std::ostringstream piped;
+            generate_table_text(150000, schema, piped, format, 5, thread_count);
+            CHECK(piped.str() == expected_table.str());
+        }
+    }
+}
+
+TEST_CASE("pipelined output reports write errors", "[output]") {
+    std::ostringstream failing;
+    failing.setstate(std::ios::badbit);
+    CHECK_THROWS_AS(generate_text(100000, 4, UniformIntDistribution{0, 9}, failing,
+                                  csv_format(), 1, 4),
+                    std::runtime_error);
+
+    // a pipe whose reader goes away after some output
+    struct ClosingPipe : std::streambuf {
+        std::size_t room = 100000;
+        std::atomic<int> syncs{0};
+
+        std::streamsize xsputn(const char*, std::streamsize count) override {
+            if (static_cast<std::size_t>(count) > room) {
+                errno = EPIPE;
+                return 0;
+            }
+            room -= static_cast<std::size_t>(count);
+            return count;
+        }
+        int_type overflow(int_type c) override {
+            char ch = traits_type::to_char_type(c);
+            return xsputn(&ch, 1) == 1 ? traits_type::not_eof(c) : traits_type::eof();
+        }
+        int sync() override {
+            ++syncs;
+            return 0;
+        }
+    } pipe;
+    std::ostream os{&pipe};
+    PipelineTableWriter<int> writer{os, csv_format(), 2};
+    auto chunk = generate_data(5000, 4, UniformIntDistribution{0, 9}, 1);
+    writer.write_rows(chunk);
+    // the stream is flushed once the writing thread has caught up, before finish
+    for (int i = 0; i < 1000 && pipe.syncs == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    CHECK(pipe.syncs > 0);
+    // the writer throws once the failure is noticed, so the rows stop
+    std::error_code error;
+    try {
+        for (int i = 0; i < 1000; ++i) {
+            writer.write_rows(chunk);
+        }
+    } catch (const std::system_error& e) {
+        error = e.code();
+    }
+    CHECK(error == std::errc::broken_pipe);
+}
+
+TEST_CASE("pipelined output fails instead of waiting for lost parts", "[output]") {
+    // the parts that are being formatted when a value throws are never submitted
+    std::ostringstream out;
+    PipelineTableWriter<int> writer{out, csv_format(), 4, [](const int& value, std::ostream& os) {
+        if (value == 7) {
+            throw std::runtime_error{"no sevens"};
+        }
+        os << value;
+    }};
+    auto chunk = generate_data(20000, 4, UniformIntDistribution{0, 9}, 1);
+    CHECK_THROWS_AS(writer.write_rows(chunk), std::runtime_error);
+    CHECK_THROWS_AS(writer.finish(), std::runtime_error);
+}
+
+TEST_CASE("shards contain the rows of the whole table", "[shards]") {
+    for (std::uint64_t shard_count : {1u, 3u, 7u}) {
+        std::uint64_t next_row = 0;
+        for (std::uint64_t i = 0; i < shard_count; ++i) {
+            RowRange shard = shard_rows(100, shard_count, i);
+            CHECK(shard.first_row == next_row);
+            CHECK((shard.row_count == 100 / shard_count || shard.row_count == 100 / shard_count + 1));
+            next_row += shard.row_count;
+        }
+        CHECK(next_row == 100);
+    }
+
+    const std::uint64_t rows = 3 * block_rows(3) + 101;
+    std::ostringstream whole;
+    generate_text(rows, 3, BernoulliDistribution{0.5}, whole, csv_format(), 8);
+    std::ostringstream json;
+    generate_text(rows, 3, BernoulliDistribution{0.5}, json, json_format(), 8);
+
+    std::string concatenated;
+    std::ostringstream streamed;
+    TableWriter<bool> streamed_writer{streamed, csv_format()};
+    for (std::uint64_t i = 0; i < 5; ++i) {
+        RowRange shard = shard_rows(rows, 5, i);
+        std::ostringstream text;
+        generate_text(shard, 3, BernoulliDistribution{0.5}, text,
+                      shard_format(csv_format(), shard, rows), 8, 2);
+        concatenated += text.str();
+
+        generate_stream(
+            shard, 3, BernoulliDistribution{0.5},
+            [&](const Data<bool>& chunk, std::uint64_t count) { streamed_writer.write_rows(chunk, count); },
+            8, 1000, 2);
+
+        // the other formats write every shard as a table of its own
+        std::ostringstream expected;
+        output_json(generate_rows(shard.first_row, shard.row_count, 3,
+                                  BernoulliDistribution{0.5}, 8),
+                    expected);
+        std::ostringstream shard_json;
+        generate_text(shard, 3, BernoulliDistribution{0.5}, shard_json,
+                      shard_format(json_format(), shard, rows), 8);
+        CHECK(shard_json.str() == expected.str());
+    }
+    streamed_writer.finish();
+    CHECK(concatenated == whole.str());
+    CHECK(streamed.str() == whole.str());
+
+    SECTION("tables with a schema") {
+        const Schema schema{{"id", UniformIntDistribution{1, 10}},
+                            {"price", NormalDistribution{100.0, 15.0}}};
+        const std::uint64_t table_rows = block_rows(1) + 1000;
+        std::ostringstream expected;
+        generate_table_text(table_rows, schema, expected, csv_format(), 3);
+
+        std::string sharded;
+        for (std::uint64_t i = 0; i < 3; ++i) {
+            RowRange shard = shard_rows(table_rows, 3, i);
+            std::ostringstream text;
+            generate_table_text(shard, schema, text, shard_format(csv_format(), shard, table_rows),
+                                3, 2);
+            CHECK(text.str().size() > 0);
+            sharded += text.str();
+
+            std::ostringstream generated;
+            ColumnTableWriter writer{generated, shard_format(csv_format(), shard, table_rows)};
+            writer.write_rows(generate_table(shard, schema, 3));
+            writer.finish();
+            CHECK(generated.str() == text.str());
+        }
+        CHECK(sharded == expected.str());
+    }
+}
+
+TEST_CASE("generate_table generates every column with its own distribution", "[schema]") {
+    const Schema schema{{"id", UniformIntDistribution{1, 10}},
+                        {"price", NormalDistribution{100.0, 15.0}},
+                        {"flag", BernoulliDistribution{0.0}},
+                        {"customer", ForeignKeyDistribution{100, 50, 1.2}},
+                        {"order", UniqueKeyDistribution{1, 5000}}};
+    auto table = generate_table(5000, schema, 5);
+
+    REQUIRE(table.row_count == 5000);
+    REQUIRE(table.col_count == 5);
+    CHECK(table.name(1) == "price");
+    const auto& ids = std::get<Data<int>>(table.column(0));
+    const auto& prices = std::get<Data<double>>(table.column(1));
+    const auto& flags = std::get<Data<bool>>(table.column(2));
+    const auto& customers = std::get<Data<std::int64_t>>(table.column(3));
+    const auto& orders = std::get<Data<std::int64_t>>(table.column(4));
+    std::vector<bool> seen(5001);
+    for (unsigned int row = 0; row < table.row_count; ++row) {
+        CHECK((ids[row][0] >= 1 && ids[row][0] <= 10));
+        CHECK(!flags[row][0]);
+        CHECK((customers[row][0] >= 100 && customers[row][0] < 150));
+        // every order once
+        REQUIRE((orders[row][0] >= 1 && orders[row][0] <= 5000));
+        CHECK(!seen[static_cast<std::size_t>(orders[row][0])]);
+        seen[static_cast<std::size_t>(orders[row][0])] = true;
+    }
+    CHECK(prices[0][0] != prices[1][0]);
+
+    SECTION("the result doesn't depend on threads and chunks") {
+        std::ostringstream expected;
+        ColumnTableWriter expected_writer{expected, csv_format()};
+        expected_writer.write_rows(table);
+        expected_writer.finish();
+
+        std::ostringstream threaded;
+        ColumnTableWriter threaded_writer{threaded, csv_format()};
+        threaded_writer.write_rows(generate_table(5000, schema, 5, 3));
+        threaded_writer.finish();
+        CHECK(threaded.str() == expected.str());
+
+        std::ostringstream streamed;
+        ColumnTableWriter streamed_writer{streamed, csv_format()};
+        generate_table_stream(
+            5000, schema,
+            [&](const ColumnTable& chunk, std::uint64_t rows) { streamed_writer.write_rows(chunk, rows); },
+            5, 999);
+        streamed_writer.finish();
+        CHECK(streamed.str() == expected.str());
+    }
+}
+
+TEST_CASE("column specifications read back to the same distribution", "[schema]") {
+    // 17 significant digits are needed for these
+    const double mean = 0.12345678901234568;
+    const double stddev = 1.0 / 3.0;
+    std::ostringstream os;
+    os << ColumnSchema{"price", NormalDistribution{mean, stddev}};
+    CHECK(os.str() == "price:normal(0.12345678901234568,0.3333333333333333)");
+
+    // as gendata --column reads the parameters
+    std::istringstream in{os.str().substr(os.str().find('(') + 1)};
+    double read_mean = 0;
+    double read_stddev = 0;
+    char comma = 0;
+    in >> read_mean >> comma >> read_stddev;
+    CHECK(read_mean == mean);
+    CHECK(read_stddev == stddev);
+
+    std::ostringstream keys;
+    keys << ColumnSchema{"customer", ForeignKeyDistribution{100, 50, 1.2}} << " "
+         << ColumnSchema{"flag", BernoulliDistribution{0.1}};
+    CHECK(keys.str() == "customer:fk(100,50,1.2) flag:bernoulli(0.1)");
+}
+
+TEST_CASE("ColumnTableWriter writes mixed rows", "[output]") {
+    const Schema schema{{"id", UniformIntDistribution{7, 8}}, {"flag", BernoulliDistribution{1.0}}};
+    auto table = generate_table(2, schema, 1);
+    int id0 = std::get<Data<int>>(table.column(0))[0][0];
+    int id1 = std::get<Data<int>>(table.column(0))[1][0];
+
+    std::ostringstream sql;
+    ColumnTableWriter writer{sql, sql_format("t", {"id", "flag"})};
+    writer.write_rows(table);
+    writer.finish();
+    CHECK(sql.str() == "INSERT INTO \"t\" (\"id\", \"flag\") VALUES\n  (" + std::to_string(id0) +
+                           ", 1),\n  (" + std::to_string(id1) + ", 1);");
+
+    SECTION("several groups of rows of every type") {
+        const Schema mixed{{"id", UniformIntDistribution{1, 10}},
+                           {"price", NormalDistribution{100.0, 15.0}},
+                           {"flag", BernoulliDistribution{0.5}}};
+        auto rows = generate_table(300, mixed, 3);
+        std::string expected = "[\n";
+        for (std::uint64_t row = 30; row < 250; ++row) {
+            std::array<char, 64> price{};
+            auto result = std::to_chars(price.data(), price.data() + price.size(),
+                                        std::get<Data<double>>(rows.column(1))[row][0]);
+            expected += (row > 30 ? ",\n  [" : "  [") +
+                        std::to_string(std::get<Data<int>>(rows.column(0))[row][0]) + ", " +
+                        std::string{price.data(), result.ptr} + ", " +
+                        (std::get<Data<bool>>(rows.column(2))[row][0] ? "true" : "false") + "]";
+        }
+        expected += "\n]";
+
+        std::ostringstream json;
+        ColumnTableWriter json_writer{json, json_format()};
+        json_writer.write_rows(rows, 30, 100);
+        json_writer.write_rows(rows, 100, 250);
+        json_writer.finish();
+        CHECK(json.str() == expected);
+    }
+}
+
+TEST_CASE("batched sql output starts a new statement every batch", "[output]") {
+    Data<int> data{5, 1};
+    for (unsigned int row = 0; row < 5; ++row) {
+        data.set_value(row, 0, static_cast<int>(row));
+    }
+
+    std::ostringstream sql;
+    TableWriter<int> writer{sql, sql_format("t", {"x"}, 2)};
+    writer.write_rows(data, 3);
+    writer.write_rows(data, 3, 5);
+    writer.finish();
+    CHECK(sql.str() ==
+          "BEGIN;\n"
+          "INSERT INTO \"t\" (\"x\") VALUES\n  (0),\n  (1);\n"
+          "INSERT INTO \"t\" (\"x\") VALUES\n  (2),\n  (3);\n"
+          "INSERT INTO \"t\" (\"x\") VALUES\n  (4);\n"
+          "COMMIT;");
+
+    std::ostringstream copy;
+    TableWriter<int> copy_writer{copy, postgres_copy_format("t")};
+    copy_writer.write_rows(data, 2);
+    copy_writer.finish();
+    CHECK(copy.str() == "COPY \"t\" FROM STDIN;\n0\n1\n\\.\n");
+
+    // double quotes in names are doubled
+    CHECK(sql_format("t\"", {"a\"b", "c"}).prefix ==
+          "INSERT INTO \"t\"\"\" (\"a\"\"b\", \"c\") VALUES\n");
+    CHECK(postgres_copy_format("t", {"a\"b"}).prefix == "COPY \"t\" (\"a\"\"b\") FROM STDIN;\n");
+
+    SECTION("FileTableWriter splits the batches the same way") {
+        auto table = generate_data(10000, 2, UniformIntDistribution{0, 9}, 4);
+        std::ostringstream expected;
+        TableWriter<int> expected_writer{expected, sql_format("t", {}, 999)};
+        expected_writer.write_rows(table);
+        expected_writer.finish();
+
+        auto path = std::filesystem::temp_directory_path() / "datagen_batches.test.sql";
+        {
+            FileTableWriter<int> file_writer{path.string(), sql_format("t", {}, 999), 3};
+            file_writer.write_rows(table);
+            file_writer.finish();
+        }
+        std::ifstream in{path, std::ios::binary};
+        std::string written{std::istreambuf_iterator<char>{in}, {}};
+        CHECK(written == expected.str());
+        std::filesystem::remove(path);
+    }
+}
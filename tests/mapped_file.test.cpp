@@ -0,0 +1,46 @@
+#include "data_generator/data_generator.hpp"
+#include "data_generator/mapped_file.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace datagen;
+
+TEST_CASE("Data can be stored in a mapped file", "[mapped_file]") {
+    auto path = std::filesystem::temp_directory_path() / "datagen_mapped_file.test.bin";
+    auto expected = generate_data(3000, 7, UniformIntDistribution<int>{}, 8, 2);
+    {
+        MappedFileResource resource{path.string()};
+        auto data = generate_data(3000, 7, UniformIntDistribution<int>{}, 8, 2, &resource);
+        CHECK(std::equal(data.front().begin(), data.back().end(), expected.front().begin()));
+        CHECK(resource.file_size() == static_cast<off_t>(data.size() * sizeof(int)));
+    }
+
+    // the file keeps the values row-major
+    std::vector<int> values(3000 * 7);
+    std::ifstream file{path, std::ios::binary};
+    file.read(reinterpret_cast<char*>(values.data()),
+              static_cast<std::streamsize>(values.size() * sizeof(int)));
+    CHECK(file.gcount() == static_cast<std::streamsize>(values.size() * sizeof(int)));
+    CHECK(std::equal(values.begin(), values.end(), expected.front().begin()));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("MappedFileResource places every allocation on its own pages", "[mapped_file]") {
+    auto path = std::filesystem::temp_directory_path() / "datagen_mapped_file.test.bin";
+    MappedFileResource resource{path.string()};
+    {
+        Data<double> first{10, 10, &resource};
+        Data<bool> second{10, 10, &resource};
+        first.set_value(9, 9, 1.5);
+        second.set_value(9, 9, true);
+        CHECK(first[9][9] == 1.5);
+        CHECK(second[9][9]);
+        CHECK(first[0][0] == 0.0);
+        CHECK(resource.file_size() > static_cast<off_t>(100 * sizeof(double)));
+    }
+    std::filesystem::remove(path);
+}
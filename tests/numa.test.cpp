@@ -0,0 +1,115 @@
+#include "data_generator/data_generator.hpp"
+#include "data_generator/file_writer.hpp"
+#include "data_generator/numa.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace datagen;
+
+TEST_CASE("cpu lists are parsed", "[numa]") {
+    CHECK(detail::parse_cpu_list("0-3,8,10-11\n") == std::vector<int>{0, 1, 2, 3, 8, 10, 11});
+    CHECK(detail::parse_cpu_list("5") == std::vector<int>{5});
+    CHECK(detail::parse_cpu_list("").empty());
+}
+
+TEST_CASE("NumaTopology puts consecutive threads on a node", "[numa]") {
+    NumaTopology topology{{{0, 1, 2, 3}, {}, {4, 5}}};
+    CHECK(topology.node_count() == 2);
+    CHECK(topology.cpu_count() == 6);
+    CHECK(topology.first_nodes(1).cpu_count() == 4);
+
+    std::vector<int> cpus;
+    for (unsigned int thread = 0; thread < 6; ++thread) {
+        cpus.push_back(topology.cpu(thread, 6));
+    }
+    CHECK(cpus == std::vector<int>{0, 1, 2, 4, 5, 4});
+
+    // more threads than cpus take the cpus of their node in turn
+    CHECK(topology.node(4, 10) == 0);
+    CHECK(topology.cpu(4, 10) == 0);
+    CHECK(topology.cpu(9, 10) == 4);
+    // fewer threads than nodes
+    CHECK(topology.cpu(0, 1) == 0);
+
+    NumaTopology detected = NumaTopology::detect();
+    CHECK(detected.node_count() >= 1);
+    CHECK(detected.cpu_count() >= 1);
+}
+
+TEST_CASE("NumaScope doesn't change the data", "[numa]") {
+    const std::uint64_t rows = 5 * block_rows(3) + 17;
+    auto csv = [](const auto& data) {
+        std::ostringstream os;
+        output_csv(data, os);
+        return os.str();
+    };
+    const std::string expected = csv(generate_data(rows, 3, UniformIntDistribution{0, 999}, 7));
+    const std::string expected_bools = csv(generate_data(rows, 3, BernoulliDistribution{0.3}, 7));
+
+    auto path = std::filesystem::temp_directory_path() / "datagen_numa.test.csv";
+    {
+        NumaScope scope{NumaTopology::detect()};
+        for (unsigned int threads : {2u, 3u, 8u}) {
+            CHECK(csv(generate_data(rows, 3, UniformIntDistribution{0, 999}, 7, threads)) ==
+                  expected);
+            CHECK(csv(generate_data(rows, 3, BernoulliDistribution{0.3}, 7, threads)) ==
+                  expected_bools);
+        }
+
+        FileTableWriter<int> writer{path.string(), csv_format(), 4};
+        generate_stream(
+            rows, 3, UniformIntDistribution{0, 999},
+            [&](const Data<int>& chunk, std::uint64_t count) { writer.write_rows(chunk, count); },
+            7, 0, 4);
+        writer.finish();
+    }
+    std::ifstream in{path, std::ios::binary};
+    std::string written{std::istreambuf_iterator<char>{in}, {}};
+    CHECK(written == expected);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("blocks are split from the table row, not the first row of the data", "[numa]") {
+    // the rows 100, ..., 399 touch the blocks 1, ..., 6 of 64 rows
+    CHECK(detail::block_count(100, 300, 64) == 6);
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> parts;
+    for (unsigned int part = 0; part < 4; ++part) {
+        parts.push_back(detail::split_blocks(100, 300, 64, part, 4));
+    }
+    CHECK(parts == std::vector<std::pair<std::uint64_t, std::uint64_t>>{
+                       {100, 192}, {192, 320}, {320, 384}, {384, 400}});
+    CHECK(detail::split_blocks(100, 20, 64, 0, 1) ==
+          std::pair<std::uint64_t, std::uint64_t>{100, 120});
+
+    // a stream that doesn't start at a block, written by a resumed writer
+    const std::uint64_t first_row = block_rows(3) + 17;
+    const std::uint64_t rows = 5 * block_rows(3);
+    std::ostringstream expected;
+    output_csv(generate_rows(first_row, rows, 3, UniformIntDistribution{0, 999}, 7), expected);
+
+    auto path = std::filesystem::temp_directory_path() / "datagen_numa_rows.test.csv";
+    {
+        NumaScope scope{NumaTopology::detect()};
+        FileTableWriter<int> writer{path.string(), csv_format(), 4, {}, Compression::none,
+                                    FileCheckpoint{first_row, 0}};
+        generate_stream(
+            RowRange{first_row, rows}, 3, UniformIntDistribution{0, 999},
+            [&](const Data<int>& chunk, std::uint64_t count) { writer.write_rows(chunk, count); },
+            7, 0, 4);
+        writer.finish();
+    }
+    std::ifstream in{path, std::ios::binary};
+    std::string written{std::istreambuf_iterator<char>{in}, {}};
+    // the rows continue a table, so the first one is preceded by a delimiter
+    CHECK(written == "\n" + expected.str());
+    std::filesystem::remove(path);
+}
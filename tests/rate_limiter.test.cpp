@@ -0,0 +1,63 @@
+#include "data_generator/rate_limiter.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace datagen;
+
+TEST_CASE("RateLimiter batches last about an interval", "[rate_limiter]") {
+    CHECK(RateLimiter{1e6}.batch_rows(1 << 16) == 10000);
+    CHECK(RateLimiter{10.0}.batch_rows(100) == 1);
+    CHECK(RateLimiter{0.0}.batch_rows(100) == 100);
+    CHECK(RateLimiter{1e30}.batch_rows(100) == 100);
+    CHECK(RateLimiter{1e6}.batch_rows(1 << 16, std::chrono::milliseconds{1}) == 1000);
+}
+
+TEST_CASE("RateLimiter schedules batches at the target rate", "[rate_limiter]") {
+    using Clock = RateLimiter::Clock;
+    using std::chrono::milliseconds;
+
+    const Clock::time_point begin{};
+    RateLimiter limiter{2000.0};
+    // the first batch is due at once and every next one 20 rows (10 ms) later,
+    // however early it is asked for
+    CHECK(limiter.schedule(20, begin) == begin);
+    CHECK(limiter.schedule(20, begin) == begin + milliseconds{10});
+    CHECK(limiter.schedule(40, begin + milliseconds{5}) == begin + milliseconds{20});
+    CHECK(limiter.schedule(20, begin + milliseconds{50}) == begin + milliseconds{40});
+
+    // no limit is never behind
+    RateLimiter unlimited{0.0};
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(unlimited.schedule(1000000, begin) == begin);
+    }
+}
+
+TEST_CASE("RateLimiter starts over after falling behind", "[rate_limiter]") {
+    using Clock = RateLimiter::Clock;
+    using std::chrono::milliseconds;
+
+    const Clock::time_point begin{};
+    RateLimiter limiter{1000.0, milliseconds{10}};
+    CHECK(limiter.schedule(10, begin) == begin);
+    // 10 ms late is within the lag, so the rows stay on the schedule
+    CHECK(limiter.schedule(10, begin + milliseconds{20}) == begin + milliseconds{10});
+    // no burst to catch up: the schedule starts over now
+    CHECK(limiter.schedule(10, begin + milliseconds{100}) == begin + milliseconds{100});
+    CHECK(limiter.schedule(10, begin + milliseconds{100}) == begin + milliseconds{110});
+}
+
+TEST_CASE("RateLimiter waits for the schedule", "[rate_limiter]") {
+    using Clock = RateLimiter::Clock;
+
+    RateLimiter limiter{2000.0};
+    Clock::time_point begin = Clock::now();
+    for (int i = 0; i < 10; ++i) {
+        limiter.wait(20);
+    }
+    // the first batch is due at once, the tenth after 180 rows
+    CHECK(Clock::now() - begin >= std::chrono::milliseconds{85});
+}
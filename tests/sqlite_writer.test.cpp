@@ -0,0 +1,87 @@
+#include "data_generator/sqlite_writer.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <sqlite3.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+using namespace datagen;
+
+namespace {
+
+/// @brief the single value the query returns, as text
+std::string query(const std::filesystem::path& path, const std::string& sql) {
+    sqlite3* db = nullptr;
+    REQUIRE(sqlite3_open(path.string().c_str(), &db) == SQLITE_OK);
+    sqlite3_stmt* statement = nullptr;
+    REQUIRE(sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) == SQLITE_OK);
+    REQUIRE(sqlite3_step(statement) == SQLITE_ROW);
+    std::string result = reinterpret_cast<const char*>(sqlite3_column_text(statement, 0));
+    sqlite3_finalize(statement);
+    sqlite3_close(db);
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("SqliteWriter inserts all rows", "[sqlite]") {
+    auto path = std::filesystem::temp_directory_path() / "datagen_sqlite_writer.test.db";
+    std::filesystem::remove(path);
+
+    auto data = generate_data(1000, 3, UniformIntDistribution{1, 6}, 2);
+    long long sum = 0;
+    for (unsigned int row = 0; row < 400; ++row) {
+        for (unsigned int col = 0; col < 3; ++col) {
+            sum += data[row][col];
+        }
+    }
+    const Schema schema{{"id", UniformIntDistribution{1, 6}}, {"flag", BernoulliDistribution{1.0}}};
+    {
+        SqliteWriter writer{path.string(), "dice", 300};
+        writer.write_rows(data, 400);
+        writer.write_rows(data, 400);
+        writer.finish();
+
+        SqliteWriter table_writer{path.string(), "mixed"};
+        table_writer.write_rows(generate_table(10, schema, 2));
+        table_writer.finish();
+    }
+
+    CHECK(query(path, "SELECT count(*) FROM dice") == "800");
+    CHECK(query(path, "SELECT sum(c0) + sum(c1) + sum(c2) FROM (SELECT * FROM dice LIMIT 400)") ==
+          std::to_string(sum));
+    CHECK(query(path, "SELECT count(*) FROM mixed WHERE flag = 1") == "10");
+    CHECK(query(path, "SELECT type FROM pragma_table_info('mixed') WHERE name = 'flag'") == "BOOLEAN");
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("SqliteWriter quotes names with double quotes", "[sqlite]") {
+    auto path = std::filesystem::temp_directory_path() / "datagen_sqlite_quote.test.db";
+    std::filesystem::remove(path);
+    const Schema schema{{"a\"b", UniformIntDistribution{1, 6}}};
+    {
+        // would run the DROP if the quote ended the name
+        SqliteWriter writer{path.string(), "t\" (x INTEGER); DROP TABLE t; --"};
+        writer.write_rows(generate_table(10, schema, 2));
+        writer.finish();
+    }
+
+    CHECK(query(path, "SELECT count(*) FROM \"t\"\" (x INTEGER); DROP TABLE t; --\"") == "10");
+    CHECK(query(path, "SELECT name FROM pragma_table_info('t\" (x INTEGER); DROP TABLE t; --')") ==
+          "a\"b");
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("SqliteWriter rejects a file that isn't a database", "[sqlite]") {
+    auto path = std::filesystem::temp_directory_path() / "datagen_sqlite_writer.test.csv";
+    {
+        std::ofstream file{path};
+        file << std::string(4096, 'x');
+    }
+    CHECK_THROWS_AS((SqliteWriter{path.string(), "t"}), std::runtime_error);
+    std::filesystem::remove(path);
+}
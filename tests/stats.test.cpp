@@ -0,0 +1,121 @@
+#include "data_generator/compression.hpp"
+#include "data_generator/data_generator.hpp"
+#include "data_generator/pipeline_writer.hpp"
+#include "data_generator/stats.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+using namespace datagen;
+
+TEST_CASE("StatsBuffer forwards everything", "[stats]") {
+    std::ostringstream target;
+    std::string expected;
+    {
+        StatsBuffer buffer{*target.rdbuf(), 16};
+        std::ostream os{&buffer};
+        for (int i = 0; i < 100; ++i) {
+            os << i << ',';
+            expected += std::to_string(i) + ',';
+        }
+        // larger than the buffer
+        std::string large(100, 'x');
+        os << large;
+        expected += large;
+        os.flush();
+        CHECK(target.str() == expected);
+        os << "rest";
+        expected += "rest";
+    }
+    CHECK(target.str() == expected);
+}
+
+TEST_CASE("Stats record the phases of the output", "[stats]") {
+    const TextFormat format = csv_format();
+    std::ostringstream expected;
+    generate_text(100000, 4, UniformIntDistribution{0, 999}, expected, format, 3);
+
+    // nothing is recorded outside of a StatsScope
+    Stats idle;
+    generate_data(1000, 4, UniformIntDistribution{0, 999}, 3);
+    CHECK(idle.report().cells == 0);
+
+    for (Compression compression : {Compression::none, Compression::zstd}) {
+        if (!compression_available(compression)) {
+            continue;
+        }
+        Stats stats;
+        std::ostringstream out;
+        {
+            StatsScope scope{stats};
+            StatsBuffer sink{*out.rdbuf()};
+            std::ostream os{&sink};
+            generate_text(100000, 4, UniformIntDistribution{0, 999}, os, format, 3, 4, {},
+                          compression);
+        }
+        if (compression == Compression::none) {
+            CHECK(out.str() == expected.str());
+        }
+        StatsReport report = stats.report();
+        if (!stats_available()) {
+            CHECK(report.cells == 0);
+            continue;
+        }
+        CHECK(report.cells == 400000);
+        CHECK(report.bytes_written == out.str().size());
+        CHECK(report[Phase::generate].calls == detail::BlockParts{{0, 100000}, block_rows(4)}.count());
+        CHECK(report[Phase::format].calls == report[Phase::generate].calls);
+        CHECK((report[Phase::compress].calls > 0) == (compression != Compression::none));
+        CHECK(report[Phase::write].calls > 0);
+        CHECK(report[Phase::generate].seconds > 0.0);
+        CHECK(report.cells_per_second() > 0.0);
+        CHECK(report.peak_rss_bytes > 0);
+    }
+}
+
+TEST_CASE("Stats record the serial writers", "[stats]") {
+    auto data = generate_data(10000, 4, UniformIntDistribution{0, 999}, 3);
+    Stats stats;
+    {
+        StatsScope scope{stats};
+        std::ostringstream out;
+        TableWriter<int> writer = csv_writer<int>(out);
+        writer.write_rows(data, 5000);
+        writer.write_rows(data);
+        writer.finish();
+    }
+    StatsReport report = stats.report();
+    CHECK(report[Phase::format].calls == (stats_available() ? 2 : 0));
+    CHECK(report[Phase::generate].calls == 0);
+}
+
+TEST_CASE("Stats are written as text or JSON", "[stats]") {
+    StatsReport report;
+    report.wall_seconds = 2.0;
+    report.cells = 1000;
+    report.bytes_written = 5000;
+    report.phases[static_cast<std::size_t>(Phase::format)] = {1.5, 3000, 7};
+
+    std::ostringstream json;
+    write_stats(report, json, true);
+    CHECK(json.str() ==
+          "{\"wall_seconds\":2.000,\"cells\":1000,\"cells_per_second\":500.000,"
+          "\"bytes_written\":5000,\"bytes_per_second\":2500.000,\"peak_rss_bytes\":0,"
+          "\"phases\":{\"generate\":{\"seconds\":0.000,\"cycles\":0,\"calls\":0},"
+          "\"format\":{\"seconds\":1.500,\"cycles\":3000,\"calls\":7},"
+          "\"compress\":{\"seconds\":0.000,\"cycles\":0,\"calls\":0},"
+          "\"write\":{\"seconds\":0.000,\"cycles\":0,\"calls\":0}}}\n");
+
+    std::ostringstream text;
+    text << 0.1;
+    write_stats(report, text);
+    CHECK(text.str().find("# format: 1.500 s") != std::string::npos);
+    // the format of the stream is restored
+    text.str("");
+    text << 0.1;
+    CHECK(text.str() == "0.1");
+}
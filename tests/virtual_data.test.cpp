@@ -0,0 +1,78 @@
+#include "data_generator/data_generator.hpp"
+#include "data_generator/virtual_data.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+using namespace datagen;
+
+TEST_CASE("VirtualData computes the rows of generate_data", "[virtual]") {
+    const std::uint64_t rows = 3 * block_rows(5) + 17;
+    auto expected = generate_data(rows, 5, UniformIntDistribution{-50, 50}, 3);
+    auto expected_bits = generate_data(rows, 5, BernoulliDistribution{0.3}, 3);
+    auto expected_philox =
+        generate_data<Philox4x32>(rows, 5, NormalDistribution{0.0, 1.0}, 3);
+
+    for (std::size_t cache_blocks : {0u, 1u, 4u}) {
+        VirtualData data{rows, 5, UniformIntDistribution{-50, 50}, 3, cache_blocks};
+        VirtualData bits{rows, 5, BernoulliDistribution{0.3}, 3, cache_blocks};
+        VirtualData<NormalDistribution, Philox4x32> philox{
+            rows, 5, NormalDistribution{0.0, 1.0}, 3, cache_blocks};
+        CHECK(data.size() == expected.size());
+
+        if (cache_blocks > 0) {
+            // without a cache, std::mt19937 would skip through the block for every row
+            std::uint64_t row = 0;
+            for (const auto& r : data) {
+                CHECK(std::equal(r.begin(), r.end(), expected[row].begin(), expected[row].end()));
+                ++row;
+            }
+            CHECK(row == rows);
+        }
+        // jumps between blocks, backwards too
+        for (std::uint64_t i : {rows - 1, std::uint64_t{0}, rows / 2, std::uint64_t{1}, rows - 1}) {
+            // every view owns its values, so begin and end come from the same one
+            auto bits_row = bits[i];
+            auto philox_row = philox[i];
+            CHECK(std::equal(bits_row.begin(), bits_row.end(), expected_bits[i].begin()));
+            CHECK(std::equal(philox_row.begin(), philox_row.end(), expected_philox[i].begin()));
+            CHECK(data[i][4] == expected[i][4]);
+        }
+        CHECK(data.front().front() == expected.front().front());
+        CHECK(data.back().back() == expected.back().back());
+    }
+}
+
+TEST_CASE("VirtualData rows outlive the cache", "[virtual]") {
+    VirtualData data{1'000'000, 3, UniformIntDistribution<int>{}, 5, 1};
+    auto first = data[0];
+    auto last = data[999'999];
+    // the first block was evicted, but the view still owns its values
+    auto expected = generate_rows(0, 1, 3, UniformIntDistribution<int>{}, 5);
+    CHECK(std::equal(first.begin(), first.end(), expected.front().begin()));
+    CHECK(last.size() == 3);
+}
+
+TEST_CASE("VirtualData works with billions of rows", "[virtual]") {
+    const std::uint64_t rows = 5'000'000'000;
+    VirtualData<UniformIntDistribution<int>, Philox4x32> data{
+        rows, 4, UniformIntDistribution{0, 1000}, 11, 2};
+    static_assert(std::random_access_iterator<decltype(data.begin())>);
+    CHECK(data.end() - data.begin() == static_cast<std::ptrdiff_t>(rows));
+
+    auto expected = generate_rows<Philox4x32>(rows - 100, 100, 4,
+                                              UniformIntDistribution{0, 1000}, 11);
+    // moving the iterators computes nothing, only the visited rows are
+    auto tail = std::next(data.begin(), static_cast<std::ptrdiff_t>(rows - 100));
+    CHECK((*tail)[3] == expected.front()[3]);
+    std::uint64_t row = 0;
+    std::for_each(tail, data.end(), [&](const auto& r) {
+        CHECK(std::equal(r.begin(), r.end(), expected[row++].begin()));
+    });
+    CHECK(row == 100);
+    CHECK(data.back().back() == expected.back().back());
+}